@@ -0,0 +1,336 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonChunkStreamer.h"
+
+#include "Async/Async.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "DungeonGenStats.h"
+#include "DungeonLayoutAsync.h"
+#include "DungeonLayoutBridge.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "ProceduralMeshComponent.h"
+#include "TimerManager.h"
+
+namespace
+{
+	FIntPoint ToIntPoint(const DungeonLayout::FChunkCoord& Coord)
+	{
+		return FIntPoint(Coord.X, Coord.Y);
+	}
+}
+
+ADungeonChunkStreamer::ADungeonChunkStreamer()
+{
+	// Driven by a timer and tasks
+	PrimaryActorTick.bCanEverTick = false;
+	// Chunks only depend on Seed, every machine streams its own
+	bReplicates = false;
+	Seed = 0;
+	ChunkSize = 20000.f;
+	LoadRadius = 30000.f;
+	UnloadRadius = 45000.f;
+	MaxChunks = 64;
+	MaxChunkTasks = 2;
+	UpdateInterval = 0.25f;
+	RoomsPerChunk = 150;
+	BigRoomsPerChunk = 15;
+	RoomSizeMin = 400.f;
+	RoomSizeMax = 1500.f;
+	RoomUnitSize = 100.f;
+	ChunkGenerationRadius = 8000.f;
+	SelectedRoomMaterial = nullptr;
+	SelectedCorridorRoomMaterial = nullptr;
+	bParallelSeparation = false;
+	CorridorRouting = ECorridorRoutingMode::Straight;
+	CorridorCellSize = 100.f;
+	bBuildCorridorMeshes = true;
+	CorridorWallHeight = 300.f;
+	CorridorDoorHeight = 220.f;
+	CorridorMaterial = nullptr;
+
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+}
+
+void ADungeonChunkStreamer::BeginPlay()
+{
+	Super::BeginPlay();
+	++StreamId;
+	Streamer = MakeUnique<DungeonLayout::FChunkStreamer>(MakeChunkParams());
+	UpdateChunks();
+	GetWorldTimerManager().SetTimer(UpdateTimer, this, &ADungeonChunkStreamer::UpdateChunks, UpdateInterval, true);
+}
+
+void ADungeonChunkStreamer::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Chunks still on the workers are dropped when they come back
+	++StreamId;
+	GetWorldTimerManager().ClearTimer(UpdateTimer);
+	TArray<FIntPoint> Coords;
+	ChunkComponents.GetKeys(Coords);
+	for (const FIntPoint& Coord : Coords)
+	{
+		RemoveChunk(DungeonLayout::FChunkCoord(Coord.X, Coord.Y));
+	}
+	QueuedChunks.Reset();
+	NumRunningTasks = 0;
+	Streamer.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
+int32 ADungeonChunkStreamer::GetNumGeneratedChunks() const
+{
+	return Streamer ? Streamer->NumGeneratedChunks() : 0;
+}
+
+DungeonLayout::FChunkParams ADungeonChunkStreamer::MakeChunkParams() const
+{
+	DungeonLayout::FChunkParams Params;
+	Params.Layout.RoomsToSpawn = RoomsPerChunk;
+	Params.Layout.NumberOfBigRoomsToSelect = BigRoomsPerChunk;
+	Params.Layout.RoomSizeMin = RoomSizeMin;
+	Params.Layout.RoomSizeMax = RoomSizeMax;
+	Params.Layout.RoomUnitSize = RoomUnitSize;
+	Params.Layout.GenerationRadius = ChunkGenerationRadius;
+	Params.Layout.Seed = static_cast<uint64>(static_cast<uint32>(Seed));
+	Params.Layout.SeparationSolver = bParallelSeparation ? DungeonLayout::ESeparationSolver::Jacobi : DungeonLayout::ESeparationSolver::GaussSeidel;
+	Params.Layout.CorridorRouting = CorridorRouting == ECorridorRoutingMode::Grid ? DungeonLayout::ECorridorRouting::Grid : DungeonLayout::ECorridorRouting::Straight;
+	Params.Layout.CorridorCellSize = CorridorCellSize;
+	Params.ChunkSize = ChunkSize;
+	Params.LoadRadius = LoadRadius;
+	Params.UnloadRadius = FMath::Max(UnloadRadius, LoadRadius);
+	Params.MaxChunks = MaxChunks;
+	return Params;
+}
+
+DungeonLayout::FCorridorMeshParams ADungeonChunkStreamer::MakeCorridorMeshParams() const
+{
+	DungeonLayout::FCorridorMeshParams Params;
+	Params.CellSize = CorridorCellSize;
+	Params.WallHeight = CorridorWallHeight;
+	Params.DoorHeight = CorridorDoorHeight;
+	return Params;
+}
+
+void ADungeonChunkStreamer::UpdateChunks()
+{
+	UWorld* World = GetWorld();
+	if (!World || !Streamer)
+	{
+		return;
+	}
+
+	// Local players only, a dedicated server streams around every connected player
+	std::vector<DungeonLayout::FVec2> Viewers;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* Controller = It->Get();
+		const APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+		if (Pawn && (Controller->IsLocalController() || GetNetMode() == NM_DedicatedServer))
+		{
+			Viewers.push_back(DungeonLayout::ToLayout(Pawn->GetActorLocation()));
+		}
+	}
+	if (Viewers.empty())
+	{
+		return;
+	}
+
+	std::vector<DungeonLayout::FChunkCoord> Requested;
+	std::vector<DungeonLayout::FChunkCoord> Evicted;
+	Streamer->Update(Viewers, Requested, Evicted);
+	for (const DungeonLayout::FChunkCoord& Coord : Evicted)
+	{
+		QueuedChunks.Remove(Coord);
+		RemoveChunk(Coord);
+	}
+	// Nearest first
+	QueuedChunks.Append(Requested.data(), static_cast<int32>(Requested.size()));
+	StartChunkTasks();
+}
+
+void ADungeonChunkStreamer::StartChunkTasks()
+{
+	while (NumRunningTasks < MaxChunkTasks && QueuedChunks.Num() > 0)
+	{
+		const DungeonLayout::FChunkCoord Coord = QueuedChunks[0];
+		QueuedChunks.RemoveAt(0);
+		++NumRunningTasks;
+
+		const uint32 TaskStreamId = StreamId;
+		TWeakObjectPtr<ADungeonChunkStreamer> WeakThis(this);
+		const bool bBuildMesh = bBuildCorridorMeshes;
+		Async(EAsyncExecution::ThreadPool, [WeakThis, TaskStreamId, Coord, Params = Streamer->GetParams(), bBuildMesh,
+			MeshParams = MakeCorridorMeshParams(), FloorZ = GetActorLocation().Z]()
+		{
+			DungeonLayout::FDungeonChunk Chunk;
+			DungeonLayout::GenerateChunk(Params, Coord, Chunk);
+			TArray<FCorridorMeshSectionData> Sections;
+			if (bBuildMesh)
+			{
+				BuildCorridorMeshSections(Chunk.Layout, MeshParams, FloorZ, Sections);
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, TaskStreamId, Chunk = MoveTemp(Chunk), Sections = MoveTemp(Sections)]() mutable
+			{
+				ADungeonChunkStreamer* ChunkStreamer = WeakThis.Get();
+				if (!ChunkStreamer || ChunkStreamer->StreamId != TaskStreamId)
+				{
+					// Destroyed, or streaming restarted meanwhile
+					return;
+				}
+				--ChunkStreamer->NumRunningTasks;
+				ChunkStreamer->AddGeneratedChunk(MoveTemp(Chunk), MoveTemp(Sections));
+				ChunkStreamer->StartChunkTasks();
+			});
+		});
+	}
+}
+
+void ADungeonChunkStreamer::AddGeneratedChunk(DungeonLayout::FDungeonChunk&& Chunk, TArray<FCorridorMeshSectionData>&& CorridorMeshSections)
+{
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_ApplyLayout);
+	const DungeonLayout::FChunkCoord Coord = Chunk.Coord;
+	std::vector<DungeonLayout::FChunkStitch> Stitches;
+	if (!Streamer->AddChunk(MoveTemp(Chunk), Stitches))
+	{
+		// Players moved away while it was generated
+		return;
+	}
+
+	const DungeonLayout::FDungeonChunk* Added = Streamer->FindChunk(Coord);
+	FDungeonChunkComponents& Components = ChunkComponents.Add(ToIntPoint(Coord));
+	Components.SelectedRooms = CreateRoomInstances(Added->Layout, Added->Layout.SelectedRooms, SelectedRoomMaterial);
+	Components.CorridorRooms = CreateRoomInstances(Added->Layout, Added->Layout.CorridorRooms, SelectedCorridorRoomMaterial);
+	if (CorridorMeshSections.Num() > 0)
+	{
+		Components.Corridors = CreateCorridorMesh(MoveTemp(CorridorMeshSections));
+	}
+	SetLastGenerationStats(Added->Stats);
+
+	for (const DungeonLayout::FChunkStitch& Stitch : Stitches)
+	{
+		AddStitch(Stitch);
+	}
+}
+
+void ADungeonChunkStreamer::AddStitch(const DungeonLayout::FChunkStitch& Stitch)
+{
+	FDungeonChunkComponents* Owner = ChunkComponents.Find(ToIntPoint(Stitch.A));
+	if (!Owner || !bBuildCorridorMeshes)
+	{
+		return;
+	}
+
+	// The two joined rooms and the stitch alone, so the walls open into both rooms
+	const DungeonLayout::FDungeonChunk* ChunkA = Streamer->FindChunk(Stitch.A);
+	const DungeonLayout::FDungeonChunk* ChunkB = Streamer->FindChunk(Stitch.B);
+	DungeonLayout::FDungeonLayout Bridge;
+	Bridge.Rooms.push_back(ChunkA->Layout.Rooms[Stitch.RoomA]);
+	Bridge.Rooms.push_back(ChunkB->Layout.Rooms[Stitch.RoomB]);
+	Bridge.Corridors = Stitch.Corridors;
+	TArray<FCorridorMeshSectionData> Sections;
+	BuildCorridorMeshSections(Bridge, MakeCorridorMeshParams(), GetActorLocation().Z, Sections);
+	if (Sections.Num() > 0)
+	{
+		Owner->Stitches.Add(CreateCorridorMesh(MoveTemp(Sections)));
+		Owner->StitchNeighbors.Add(ToIntPoint(Stitch.B));
+	}
+}
+
+void ADungeonChunkStreamer::RemoveChunk(const DungeonLayout::FChunkCoord& Coord)
+{
+	auto Destroy = [](UPrimitiveComponent* Component)
+	{
+		if (Component)
+		{
+			Component->DestroyComponent();
+		}
+	};
+
+	FDungeonChunkComponents Components;
+	if (ChunkComponents.RemoveAndCopyValue(ToIntPoint(Coord), Components))
+	{
+		Destroy(Components.SelectedRooms);
+		Destroy(Components.CorridorRooms);
+		Destroy(Components.Corridors);
+		for (UProceduralMeshComponent* Stitch : Components.Stitches)
+		{
+			Destroy(Stitch);
+		}
+	}
+
+	// Stitches into this chunk belong to the neighbours before it
+	const FIntPoint Neighbors[2] = { FIntPoint(Coord.X - 1, Coord.Y), FIntPoint(Coord.X, Coord.Y - 1) };
+	for (const FIntPoint& Neighbor : Neighbors)
+	{
+		FDungeonChunkComponents* NeighborComponents = ChunkComponents.Find(Neighbor);
+		if (!NeighborComponents)
+		{
+			continue;
+		}
+		for (int32 i = NeighborComponents->StitchNeighbors.Num() - 1; i >= 0; --i)
+		{
+			if (NeighborComponents->StitchNeighbors[i] == ToIntPoint(Coord))
+			{
+				Destroy(NeighborComponents->Stitches[i]);
+				NeighborComponents->Stitches.RemoveAtSwap(i);
+				NeighborComponents->StitchNeighbors.RemoveAtSwap(i);
+			}
+		}
+	}
+}
+
+UHierarchicalInstancedStaticMeshComponent* ADungeonChunkStreamer::CreateRoomInstances(const DungeonLayout::FDungeonLayout& Layout, const std::vector<int32_t>& RoomIndices, UMaterialInterface* Material)
+{
+	UStaticMesh* Mesh = BP_Room ? BP_Room->GetDefaultObject<ARoom>()->mesh->GetStaticMesh() : nullptr;
+	if (!Mesh || RoomIndices.empty())
+	{
+		return nullptr;
+	}
+
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_SpawnRooms);
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(static_cast<int32>(RoomIndices.size()));
+	for (int32_t RoomIndex : RoomIndices)
+	{
+		// Scale back from the layout extents
+		const DungeonLayout::FLayoutRoom& Room = Layout.Rooms[RoomIndex];
+		const FVector Scale(Room.HalfExtents.X * 2 / RoomUnitSize, Room.HalfExtents.Y * 2 / RoomUnitSize, 1);
+		Transforms.Add(FTransform(FRotator::ZeroRotator, DungeonLayout::ToWorld(Room.Center, GetActorLocation().Z), Scale));
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* Instances = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	Instances->SetupAttachment(RootComponent);
+	// Instances are in world space
+	Instances->SetUsingAbsoluteLocation(true);
+	Instances->SetUsingAbsoluteRotation(true);
+	Instances->SetUsingAbsoluteScale(true);
+	Instances->SetStaticMesh(Mesh);
+	Instances->SetMaterial(0, Material);
+	Instances->RegisterComponent();
+	Instances->AddInstances(Transforms, false, true);
+	return Instances;
+}
+
+UProceduralMeshComponent* ADungeonChunkStreamer::CreateCorridorMesh(TArray<FCorridorMeshSectionData>&& Sections)
+{
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_UploadCorridorMesh);
+	UProceduralMeshComponent* Mesh = NewObject<UProceduralMeshComponent>(this);
+	Mesh->SetupAttachment(RootComponent);
+	// Vertices are in world space
+	Mesh->SetUsingAbsoluteLocation(true);
+	Mesh->SetUsingAbsoluteRotation(true);
+	Mesh->SetUsingAbsoluteScale(true);
+	Mesh->bUseAsyncCooking = true;
+	Mesh->RegisterComponent();
+	for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); ++SectionIndex)
+	{
+		const FCorridorMeshSectionData& Section = Sections[SectionIndex];
+		Mesh->CreateMeshSection(SectionIndex, Section.Vertices, Section.Triangles, Section.Normals, Section.UVs,
+			TArray<FColor>(), TArray<FProcMeshTangent>(), true);
+		Mesh->SetMaterial(SectionIndex, CorridorMaterial);
+	}
+	return Mesh;
+}
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonGenerator.h"
+#include "GameFramework/Actor.h"
+#include "Layout/LayoutChunks.h"
+#include "DungeonChunkStreamer.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class UProceduralMeshComponent;
+struct FCorridorMeshSectionData;
+
+// Components drawing one chunk, and the stitch corridors it owns
+USTRUCT()
+struct FDungeonChunkComponents
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UHierarchicalInstancedStaticMeshComponent* SelectedRooms = nullptr;
+
+	UPROPERTY()
+	UHierarchicalInstancedStaticMeshComponent* CorridorRooms = nullptr;
+
+	UPROPERTY()
+	UProceduralMeshComponent* Corridors = nullptr;
+
+	// Stitches to the neighbours after this chunk in chunk order, parallel to StitchNeighbors
+	UPROPERTY()
+	TArray<UProceduralMeshComponent*> Stitches;
+
+	TArray<FIntPoint> StitchNeighbors;
+};
+
+// Open-ended dungeon streamed around the players as square chunks, see Layout/LayoutChunks.h. Every chunk is a
+// dungeon of its own from Seed and its coordinates, generated on the thread pool as players approach and dropped
+// once every player is far, so memory only depends on the radii and MaxChunks however far players travel.
+// Rooms are instances of BP_Room's mesh and corridors procedural meshes, per chunk.
+// Each machine streams around its own players' pawns; chunks are deterministic, nothing is replicated.
+UCLASS()
+class DUNGEONGEN_API ADungeonChunkStreamer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ADungeonChunkStreamer();
+
+	UFUNCTION(BlueprintCallable, Category="Chunks")
+	int32 GetNumGeneratedChunks() const;
+
+	// Same seed, same chunks, on any machine
+	UPROPERTY(EditAnywhere, Category="Chunks")
+	int32 Seed;
+
+	// Side of a chunk in world units
+	UPROPERTY(EditAnywhere, Category="Chunks", meta=(ClampMin="1000"))
+	float ChunkSize;
+
+	// Chunks whose center is this close to a player are generated
+	UPROPERTY(EditAnywhere, Category="Chunks", meta=(ClampMin="0"))
+	float LoadRadius;
+
+	// Chunks are dropped once every player is farther than this. Keep it above LoadRadius.
+	UPROPERTY(EditAnywhere, Category="Chunks", meta=(ClampMin="0"))
+	float UnloadRadius;
+
+	// Most chunks kept, generated or being generated. Bounds memory.
+	UPROPERTY(EditAnywhere, Category="Chunks", meta=(ClampMin="1"))
+	int32 MaxChunks;
+
+	// Chunks generated at the same time on the thread pool
+	UPROPERTY(EditAnywhere, Category="Chunks", meta=(ClampMin="1"))
+	int32 MaxChunkTasks;
+
+	// Seconds between two looks at where the players are
+	UPROPERTY(EditAnywhere, Category="Chunks", meta=(ClampMin="0.05"))
+	float UpdateInterval;
+
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	int32 RoomsPerChunk;
+
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	int32 BigRoomsPerChunk;
+
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	float RoomSizeMin;
+
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	float RoomSizeMax;
+
+	// World size of BP_Room's mesh at scale 1
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	float RoomUnitSize;
+
+	// Rooms are scattered this far from the chunk center, at most half ChunkSize. Rooms the separation pushes
+	// out of their chunk are dropped.
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	float ChunkGenerationRadius;
+
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	TSubclassOf<ARoom> BP_Room;
+
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	UMaterialInterface* SelectedRoomMaterial;
+
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	UMaterialInterface* SelectedCorridorRoomMaterial;
+
+	// Jacobi solver, see ADungeonGenerator::bParallelSeparation
+	UPROPERTY(EditAnywhere, Category="Rooms")
+	bool bParallelSeparation;
+
+	UPROPERTY(EditAnywhere, Category="Corridors")
+	ECorridorRoutingMode CorridorRouting;
+
+	UPROPERTY(EditAnywhere, Category="Corridors", meta=(ClampMin="1"))
+	float CorridorCellSize;
+
+	UPROPERTY(EditAnywhere, Category="Corridors")
+	bool bBuildCorridorMeshes;
+
+	UPROPERTY(EditAnywhere, Category="Corridors", meta=(EditCondition="bBuildCorridorMeshes", ClampMin="0"))
+	float CorridorWallHeight;
+
+	UPROPERTY(EditAnywhere, Category="Corridors", meta=(EditCondition="bBuildCorridorMeshes", ClampMin="0"))
+	float CorridorDoorHeight;
+
+	UPROPERTY(EditAnywhere, Category="Corridors", meta=(EditCondition="bBuildCorridorMeshes"))
+	UMaterialInterface* CorridorMaterial;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	DungeonLayout::FChunkParams MakeChunkParams() const;
+	DungeonLayout::FCorridorMeshParams MakeCorridorMeshParams() const;
+
+	// Moves the chunk window to the players, drops what fell out of it and starts generating what came in
+	void UpdateChunks();
+	void StartChunkTasks();
+	// Game thread end of a chunk task
+	void AddGeneratedChunk(DungeonLayout::FDungeonChunk&& Chunk, TArray<FCorridorMeshSectionData>&& CorridorMeshSections);
+	void AddStitch(const DungeonLayout::FChunkStitch& Stitch);
+	void RemoveChunk(const DungeonLayout::FChunkCoord& Coord);
+
+	UHierarchicalInstancedStaticMeshComponent* CreateRoomInstances(const DungeonLayout::FDungeonLayout& Layout, const std::vector<int32_t>& RoomIndices, UMaterialInterface* Material);
+	UProceduralMeshComponent* CreateCorridorMesh(TArray<FCorridorMeshSectionData>&& Sections);
+
+	UPROPERTY()
+	TMap<FIntPoint, FDungeonChunkComponents> ChunkComponents;
+
+	TUniquePtr<DungeonLayout::FChunkStreamer> Streamer;
+	// Requested by the streamer, waiting for a free task
+	TArray<DungeonLayout::FChunkCoord> QueuedChunks;
+	int32 NumRunningTasks = 0;
+	// Bumped by BeginPlay and EndPlay so chunks of an earlier run are dropped
+	uint32 StreamId = 0;
+	FTimerHandle UpdateTimer;
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DungeonDebugDraw.h"
+
+#if WITH_DUNGEON_DEBUG_DRAW
+
+#include "Components/LineBatchComponent.h"
+#include "GameFramework/Actor.h"
+
+FDungeonDebugDraw::FDungeonDebugDraw(ULineBatchComponent* InBatch)
+	: Batch(InBatch)
+{
+}
+
+FDungeonDebugDraw::~FDungeonDebugDraw()
+{
+	if (Batch && Lines.Num() > 0)
+	{
+		Batch->DrawLines(Lines);
+	}
+}
+
+void FDungeonDebugDraw::Line(const FVector& Start, const FVector& End, const FColor& Color, float Thickness)
+{
+	if (Batch)
+	{
+		// No lifetime, the line stays until the batch is cleared
+		Lines.Emplace(Start, End, FLinearColor(Color), 0.f, Thickness, SDPG_World);
+	}
+}
+
+void FDungeonDebugDraw::Rectangle(const FVector& Center, const FVector2D& HalfExtents, const FColor& Color, float Thickness)
+{
+	const FVector Corners[4] = {
+		Center + FVector(-HalfExtents.X, -HalfExtents.Y, 0.f),
+		Center + FVector(HalfExtents.X, -HalfExtents.Y, 0.f),
+		Center + FVector(HalfExtents.X, HalfExtents.Y, 0.f),
+		Center + FVector(-HalfExtents.X, HalfExtents.Y, 0.f)
+	};
+	for (int32 i = 0; i < 4; ++i)
+	{
+		Line(Corners[i], Corners[(i + 1) % 4], Color, Thickness);
+	}
+}
+
+void FDungeonDebugDraw::Clear(ULineBatchComponent* Batch)
+{
+	if (Batch)
+	{
+		Batch->Flush();
+	}
+}
+
+ULineBatchComponent* FDungeonDebugDraw::CreateLineBatch(AActor* Owner, FName Name)
+{
+	ULineBatchComponent* Batch = Owner->CreateDefaultSubobject<ULineBatchComponent>(Name);
+	Batch->SetupAttachment(Owner->GetRootComponent());
+	// Lines are in world space
+	Batch->SetUsingAbsoluteLocation(true);
+	Batch->SetUsingAbsoluteRotation(true);
+	Batch->SetUsingAbsoluteScale(true);
+	Batch->PrimaryComponentTick.bCanEverTick = false;
+	Batch->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	return Batch;
+}
+
+#endif
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Debug drawing of the generation stages: triangulation, spanning tree, corridors and the animated separation.
+// Lines go to a line batch owned by the generator, added once when a stage completes and rendered from the batch
+// from then on, nothing is redrawn per frame. Shipping and dedicated server builds compile all of it out.
+
+#include "CoreMinimal.h"
+#include "DrawDebugHelpers.h"
+
+#define WITH_DUNGEON_DEBUG_DRAW (ENABLE_DRAW_DEBUG && !UE_SERVER)
+
+#if WITH_DUNGEON_DEBUG_DRAW
+
+class AActor;
+class ULineBatchComponent;
+
+// Gathers lines and hands them to the batch in one call when it goes out of scope
+class FDungeonDebugDraw
+{
+public:
+	// Batch may be null, nothing is drawn then
+	explicit FDungeonDebugDraw(ULineBatchComponent* InBatch);
+	~FDungeonDebugDraw();
+
+	FDungeonDebugDraw(const FDungeonDebugDraw&) = delete;
+	FDungeonDebugDraw& operator=(const FDungeonDebugDraw&) = delete;
+
+	void Line(const FVector& Start, const FVector& End, const FColor& Color, float Thickness);
+	// Outline of a box at its bottom
+	void Rectangle(const FVector& Center, const FVector2D& HalfExtents, const FColor& Color, float Thickness);
+
+	// Removes every line of the batch
+	static void Clear(ULineBatchComponent* Batch);
+
+	// Never ticks: the lines have no lifetime to count down
+	static ULineBatchComponent* CreateLineBatch(AActor* Owner, FName Name);
+
+private:
+	ULineBatchComponent* Batch;
+	TArray<FBatchedLine> Lines;
+};
+
+#endif
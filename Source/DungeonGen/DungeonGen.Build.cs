@@ -8,6 +8,9 @@ public class DungeonGen : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "ProceduralMeshComponent" });
+
+		// Layout files are mapped through IMappedFileHandle, the layout core's own mapping stays out of the module
+		PrivateDefinitions.Add("DUNGEON_LAYOUT_FILE_MAPPING=0");
 	}
 }
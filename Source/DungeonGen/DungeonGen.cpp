@@ -1,7 +1,35 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "DungeonGen.h"
+#include "Async/ParallelFor.h"
+#include "DungeonGenStats.h"
+#include "Layout/LayoutParallel.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, DungeonGen, "DungeonGen" );
- 
\ No newline at end of file
+namespace
+{
+	// Layout core parallel work goes through the engine task graph instead of its own threads
+	void RunLayoutTasks(int32_t NumTasks, const std::function<void(int32_t)>& Task)
+	{
+		ParallelFor(NumTasks, [&Task](int32 TaskIndex)
+		{
+			Task(TaskIndex);
+		});
+	}
+}
+
+void FDungeonGenModule::StartupModule()
+{
+	FDefaultGameModuleImpl::StartupModule();
+	DungeonLayout::SetParallelForHook(&RunLayoutTasks);
+	RegisterLayoutStageStats();
+}
+
+void FDungeonGenModule::ShutdownModule()
+{
+	UnregisterLayoutStageStats();
+	DungeonLayout::SetParallelForHook(nullptr);
+	FDefaultGameModuleImpl::ShutdownModule();
+}
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FDungeonGenModule, DungeonGen, "DungeonGen" );
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DungeonGenStats.h"
+
+#include "Layout/LayoutStats.h"
+
+DEFINE_STAT(STAT_DungeonGen_Scatter);
+DEFINE_STAT(STAT_DungeonGen_Separation);
+DEFINE_STAT(STAT_DungeonGen_Selection);
+DEFINE_STAT(STAT_DungeonGen_Delaunay);
+DEFINE_STAT(STAT_DungeonGen_RoomGraph);
+DEFINE_STAT(STAT_DungeonGen_SpanningTree);
+DEFINE_STAT(STAT_DungeonGen_Corridors);
+DEFINE_STAT(STAT_DungeonGen_CorridorMesh);
+DEFINE_STAT(STAT_DungeonGen_UploadCorridorMesh);
+DEFINE_STAT(STAT_DungeonGen_ApplyLayout);
+DEFINE_STAT(STAT_DungeonGen_SpawnRooms);
+DEFINE_STAT(STAT_DungeonGen_PublishGraph);
+DEFINE_STAT(STAT_DungeonGen_SeparationIterations);
+DEFINE_STAT(STAT_DungeonGen_OverlapPairsTested);
+DEFINE_STAT(STAT_DungeonGen_BadTrianglesPerInsertion);
+DEFINE_STAT(STAT_DungeonGen_MaxBadTriangles);
+DEFINE_STAT(STAT_DungeonGen_GraphEdges);
+DEFINE_STAT(STAT_DungeonGen_SpanningTreeEdges);
+DEFINE_STAT(STAT_DungeonGen_CorridorSegments);
+DEFINE_STAT(STAT_DungeonGen_LayoutMilliseconds);
+
+namespace
+{
+#if STATS
+	TStatId GetLayoutStageStatId(DungeonLayout::ELayoutStage Stage)
+	{
+		switch (Stage)
+		{
+		case DungeonLayout::ELayoutStage::Scatter:
+			return GET_STATID(STAT_DungeonGen_Scatter);
+		case DungeonLayout::ELayoutStage::Separation:
+			return GET_STATID(STAT_DungeonGen_Separation);
+		case DungeonLayout::ELayoutStage::Selection:
+			return GET_STATID(STAT_DungeonGen_Selection);
+		case DungeonLayout::ELayoutStage::Delaunay:
+			return GET_STATID(STAT_DungeonGen_Delaunay);
+		case DungeonLayout::ELayoutStage::RoomGraph:
+			return GET_STATID(STAT_DungeonGen_RoomGraph);
+		case DungeonLayout::ELayoutStage::SpanningTree:
+			return GET_STATID(STAT_DungeonGen_SpanningTree);
+		default:
+			return GET_STATID(STAT_DungeonGen_Corridors);
+		}
+	}
+
+	// Stages of one thread don't nest, one running counter per stage and thread is enough
+	thread_local FCycleCounter LayoutStageCounters[DungeonLayout::NumLayoutStages];
+#endif
+
+	void OnLayoutStage(DungeonLayout::ELayoutStage Stage, bool bBegin)
+	{
+#if STATS
+		FCycleCounter& Counter = LayoutStageCounters[static_cast<int32>(Stage)];
+		if (bBegin)
+		{
+			Counter.Start(GetLayoutStageStatId(Stage));
+		}
+		else
+		{
+			Counter.Stop();
+		}
+#elif CPUPROFILERTRACE_ENABLED
+		if (bBegin)
+		{
+			FCpuProfilerTrace::OutputBeginDynamicEvent(DungeonLayout::GetLayoutStageName(Stage));
+		}
+		else
+		{
+			FCpuProfilerTrace::OutputEndEvent();
+		}
+#endif
+	}
+}
+
+void RegisterLayoutStageStats()
+{
+	DungeonLayout::SetLayoutStageHook(&OnLayoutStage);
+}
+
+void UnregisterLayoutStageStats()
+{
+	DungeonLayout::SetLayoutStageHook(nullptr);
+}
+
+void SetLastGenerationStats(const DungeonLayout::FLayoutStats& Stats)
+{
+	SET_DWORD_STAT(STAT_DungeonGen_SeparationIterations, Stats.SeparationIterations);
+	SET_QWORD_STAT(STAT_DungeonGen_OverlapPairsTested, Stats.OverlapPairsTested);
+	SET_FLOAT_STAT(STAT_DungeonGen_BadTrianglesPerInsertion,
+		Stats.DelaunayInsertions > 0 ? static_cast<float>(Stats.DelaunayBadTriangles) / Stats.DelaunayInsertions : 0.f);
+	SET_DWORD_STAT(STAT_DungeonGen_MaxBadTriangles, Stats.MaxDelaunayBadTriangles);
+	SET_DWORD_STAT(STAT_DungeonGen_GraphEdges, Stats.GraphEdges);
+	SET_DWORD_STAT(STAT_DungeonGen_SpanningTreeEdges, Stats.SpanningTreeEdges);
+	SET_DWORD_STAT(STAT_DungeonGen_CorridorSegments, Stats.CorridorSegments);
+	SET_FLOAT_STAT(STAT_DungeonGen_LayoutMilliseconds, static_cast<float>(Stats.GetTotalSeconds() * 1000.0));
+}
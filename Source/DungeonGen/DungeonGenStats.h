@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// stat DungeonGen: a cycle counter per pipeline stage, wherever the stage runs, and the counters of the last
+// generation. Every cycle counter is also an Unreal Insights scope.
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+namespace DungeonLayout
+{
+	struct FLayoutStats;
+}
+
+DECLARE_STATS_GROUP(TEXT("DungeonGen"), STATGROUP_DungeonGen, STATCAT_Advanced);
+
+// Layout core stages, reported by its stage hook
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Scatter"), STAT_DungeonGen_Scatter, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Separation"), STAT_DungeonGen_Separation, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Selection"), STAT_DungeonGen_Selection, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Delaunay"), STAT_DungeonGen_Delaunay, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Room graph"), STAT_DungeonGen_RoomGraph, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spanning tree"), STAT_DungeonGen_SpanningTree, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Corridors"), STAT_DungeonGen_Corridors, STATGROUP_DungeonGen, DUNGEONGEN_API);
+
+// Engine side stages
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Corridor mesh"), STAT_DungeonGen_CorridorMesh, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Upload corridor mesh"), STAT_DungeonGen_UploadCorridorMesh, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply layout"), STAT_DungeonGen_ApplyLayout, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn rooms"), STAT_DungeonGen_SpawnRooms, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Publish graph"), STAT_DungeonGen_PublishGraph, STATGROUP_DungeonGen, DUNGEONGEN_API);
+
+// Last generation
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Separation iterations"), STAT_DungeonGen_SeparationIterations, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_QWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Overlap pairs tested"), STAT_DungeonGen_OverlapPairsTested, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Delaunay bad triangles per insertion"), STAT_DungeonGen_BadTrianglesPerInsertion, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Delaunay max bad triangles"), STAT_DungeonGen_MaxBadTriangles, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Graph edges"), STAT_DungeonGen_GraphEdges, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("MST edges"), STAT_DungeonGen_SpanningTreeEdges, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Corridor segments"), STAT_DungeonGen_CorridorSegments, STATGROUP_DungeonGen, DUNGEONGEN_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Layout ms"), STAT_DungeonGen_LayoutMilliseconds, STATGROUP_DungeonGen, DUNGEONGEN_API);
+
+// Cycle counter of the stat, which the stats system also traces for Insights. A plain Insights scope of the same
+// name in builds without stats.
+#if STATS
+#define DUNGEONGEN_SCOPE(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define DUNGEONGEN_SCOPE(Stat) TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+#endif
+
+// Routes the layout core stages to the cycle counters above, from any thread
+void RegisterLayoutStageStats();
+void UnregisterLayoutStageStats();
+
+// Sets the last generation stats
+void SetLastGenerationStats(const DungeonLayout::FLayoutStats& Stats);
@@ -3,17 +3,89 @@
 
 #include "DungeonGenerator.h"
 
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "DungeonDebugDraw.h"
+#include "DungeonGenStats.h"
+#include "DungeonLayoutAsync.h"
+#include "DungeonLayoutBridge.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Net/UnrealNetwork.h"
+#include "ProceduralMeshComponent.h"
+#include "RoomActorPool.h"
 #include "RoomGraphGenerator.h"
+#include "RoomSpawnScheduler.h"
+#include "Layout/DungeonLayout.h"
+#include "Layout/LayoutCorridors.h"
+#include "Layout/LayoutFile.h"
+#include "Layout/LayoutReplication.h"
+#include "Layout/LayoutRooms.h"
+#include "Layout/LayoutSeparation.h"
+#include "Layout/LayoutStats.h"
 
 
 // Sets default values
 ADungeonGenerator::ADungeonGenerator()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-	bAnyOverlap = true;
+	// Everything is driven by timers and tasks, and the debug lines render from their batch
+	PrimaryActorTick.bCanEverTick = false;
+	RoomUnitSize = 100.f;
+	SeparationMode = ERoomSeparationMode::TimeSliced;
+	SeparationBudgetMs = 4.f;
+	MaxSeparationIterations = 10000;
+	bParallelSeparation = false;
+	SpanningTreeAlgorithm = ESpanningTreeAlgorithm::Kruskal;
+	CorridorRouting = ECorridorRoutingMode::Straight;
+	CorridorCellSize = 100.f;
+	bBuildCorridorMeshes = true;
+	CorridorWallHeight = 300.f;
+	CorridorDoorHeight = 220.f;
+	CorridorMaterial = nullptr;
+	bGenerateInBackground = true;
+	Seed = 0;
+	bRandomSeed = true;
+	LastLayoutMilliseconds = 0.f;
+	bUseLayoutCache = true;
 	GraphGenerator = CreateDefaultSubobject<URoomGraphGenerator>(TEXT("GraphGen"));
 	GraphGenerator->OnGraphCompleted.AddDynamic(this, &ADungeonGenerator::BuildCorridorsFromMST);
+	SpawnScheduler = CreateDefaultSubobject<URoomSpawnScheduler>(TEXT("SpawnScheduler"));
+	SpawnScheduler->OnSpawnFinished.AddDynamic(this, &ADungeonGenerator::FinishSpawning);
+	bTimeSlicedSpawning = true;
+	RoomPool = CreateDefaultSubobject<URoomActorPool>(TEXT("RoomPool"));
+	RoomRenderMode = ERoomRenderMode::Actors;
+	bDrawUnselectedRooms = false;
+	NetMode = EDungeonNetMode::ReplicateActors;
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+	auto CreateRoomInstances = [this](const TCHAR* Name, bool bCollision)
+	{
+		UHierarchicalInstancedStaticMeshComponent* Instances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(Name);
+		Instances->SetupAttachment(RootComponent);
+		Instances->SetCollisionEnabled(bCollision ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision);
+		return Instances;
+	};
+	SelectedRoomInstances = CreateRoomInstances(TEXT("SelectedRoomInstances"), true);
+	CorridorRoomInstances = CreateRoomInstances(TEXT("CorridorRoomInstances"), true);
+	UnselectedRoomInstances = CreateRoomInstances(TEXT("UnselectedRoomInstances"), false);
+
+	CorridorMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("CorridorMesh"));
+	CorridorMesh->SetupAttachment(RootComponent);
+	// Vertices are in world space
+	CorridorMesh->SetUsingAbsoluteLocation(true);
+	CorridorMesh->SetUsingAbsoluteRotation(true);
+	CorridorMesh->SetUsingAbsoluteScale(true);
+	CorridorMesh->bUseAsyncCooking = true;
+
+	bDrawDebugLines = true;
+	DebugLines = nullptr;
+#if WITH_DUNGEON_DEBUG_DRAW
+	DebugLines = FDungeonDebugDraw::CreateLineBatch(this, TEXT("DebugLines"));
+#endif
 
 }
 
@@ -21,261 +93,882 @@ ADungeonGenerator::ADungeonGenerator()
 void ADungeonGenerator::BeginPlay()
 {
 	Super::BeginPlay();
+	SpawnScheduler->SpawnRoom.BindUObject(this, &ADungeonGenerator::SpawnRequestedRoom);
+	if (IsNetLayoutClient())
+	{
+		// The server's dungeon, once NetLayout has arrived
+		if (NetLayout.Generation != 0)
+		{
+			RebuildNetLayout();
+		}
+		return;
+	}
+	if (!LayoutFile.IsEmpty())
+	{
+		if (LoadLayoutFile(LayoutFile))
+		{
+			return;
+		}
+		UE_LOG(LogTemp, Warning, TEXT("Cannot load the layout file %s, generating instead."), *LayoutFile);
+	}
+	if (bGenerateInBackground)
+	{
+		GenerateDungeonAsync();
+		return;
+	}
 	CreateRooms();
 	StartRoomSeparation();
 }
-void ADungeonGenerator::SeparateRoomsStep()
+
+void ADungeonGenerator::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	if (!bAnyOverlap)
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(ADungeonGenerator, NetLayout);
+}
+
+void ADungeonGenerator::Regenerate()
+{
+	if (IsNetLayoutClient())
 	{
-		// Stop timer
-		GetWorldTimerManager().ClearTimer(RoomSeparationTimer);
-	
-		GenerateRoomGraph();
+		// The server decides
 		return;
 	}
-
-	bAnyOverlap = false; // reset for this step
-	SeparateRooms();     // this will set bAnyOverlap = true if overlaps are found
+	if (bGenerateInBackground)
+	{
+		// The current dungeon stays until the new layout is ready
+		GenerateDungeonAsync();
+		return;
+	}
+	GetWorldTimerManager().ClearTimer(RoomSeparationTimer);
+	GraphGenerator->Cancel();
+	SpawnScheduler->Cancel();
+	ReleaseSpawnedRooms();
+	ClearDebugLines();
+	CreateRooms();
+	StartRoomSeparation();
 }
 
+void ADungeonGenerator::GenerateDungeonAsync()
+{
+	if (IsNetLayoutClient())
+	{
+		return;
+	}
+	LayoutParams = MakeLayoutParams();
+	StartLayoutTask(LayoutParams, DungeonLayout::FLayoutDelta());
+}
 
-void ADungeonGenerator::StartRoomSeparation()
+void ADungeonGenerator::StartLayoutTask(const DungeonLayout::FLayoutParams& Params, const DungeonLayout::FLayoutDelta& Delta)
 {
-	bAnyOverlap = true;
+	const uint32 RequestId = ++LayoutRequestId;
+	TWeakObjectPtr<ADungeonGenerator> WeakThis(this);
+	const bool bBuildMesh = bBuildCorridorMeshes;
+	const DungeonLayout::FCorridorMeshParams MeshParams = MakeCorridorMeshParams();
+	const double FloorZ = GenerationCenter.Z;
 
-	// Start timer that ticks every frame
-	GetWorldTimerManager().SetTimer(RoomSeparationTimer, this, &ADungeonGenerator::SeparateRoomsStep, 1/60.0, true);
+	GenerateDungeonLayoutAsync(Params, ShouldUseLayoutCache()).Then([WeakThis, RequestId, Params, Delta, bBuildMesh, MeshParams, FloorZ](TFuture<FAsyncDungeonLayout> Future)
+	{
+		FAsyncDungeonLayout Result = Future.Consume();
+		// Corrections redo the graph stages, keep them on the worker too. A bad delta shows as a checksum mismatch.
+		DungeonLayout::ApplyLayoutDelta(Delta, Params, Result.Layout);
+		if (bBuildMesh)
+		{
+			BuildCorridorMeshSections(Result.Layout, MeshParams, FloorZ, Result.CorridorMesh);
+		}
+
+		// Still on the worker, hand the layout over to the game thread
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, RequestId, Result = MoveTemp(Result)]() mutable
+		{
+			ADungeonGenerator* Generator = WeakThis.Get();
+			if (!Generator || Generator->LayoutRequestId != RequestId)
+			{
+				// Destroyed, or a newer dungeon was requested meanwhile
+				return;
+			}
+			Generator->ApplyGeneratedLayout(MoveTemp(Result));
+		});
+	});
 }
 
+FString ADungeonGenerator::GetLayoutFilePath(const FString& Path)
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Path);
+}
 
-FVector ADungeonGenerator::GetRandomPointInCircle(float Radius, FVector GenerationCenter)
+bool ADungeonGenerator::SaveLayoutFile(const FString& Path, bool bCompress) const
 {
-	float r = Radius * sqrt(FMath::RandRange(0.0f, 1.0f));
-	float theta = (FMath::RandRange(0.0f, 1.0f)) * 2 * PI;
+	return DungeonLayout::SaveLayoutFile(Layout, TCHAR_TO_UTF8(*GetLayoutFilePath(Path)), bCompress);
+}
 
-	FVector randomPos = FVector(r * cos(theta), r * sin(theta), 0);
-	
+bool ADungeonGenerator::LoadLayoutFile(const FString& Path)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	const FString FullPath = GetLayoutFilePath(Path);
+	// Uncompressed files are read in place from the mapping. Platforms that cannot map read the file instead.
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FullPath));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile ? MappedFile->MapRegion() : nullptr);
+	TArray64<uint8> FileBytes;
+	const uint8* FileData = nullptr;
+	int64 FileSize = 0;
+	if (MappedRegion)
+	{
+		FileData = MappedRegion->GetMappedPtr();
+		FileSize = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(FileBytes, *FullPath, FILEREAD_Silent))
+	{
+		FileData = FileBytes.GetData();
+		FileSize = FileBytes.Num();
+	}
+	DungeonLayout::FLayoutFileView File;
+	if (!FileData || !File.Init(FileData, static_cast<size_t>(FileSize)))
+	{
+		return false;
+	}
 
-	return randomPos + GenerationCenter;
+	// Drops any layout still being generated
+	++LayoutRequestId;
+	FAsyncDungeonLayout Result;
+	File.CopyTo(Result.Layout);
+	Result.Separation.bConverged = true;
+	Result.bFromFile = true;
+	if (bBuildCorridorMeshes)
+	{
+		BuildCorridorMeshSections(Result.Layout, MakeCorridorMeshParams(), GenerationCenter.Z, Result.CorridorMesh);
+	}
+	Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+	ApplyGeneratedLayout(MoveTemp(Result));
+	if (NetMode == EDungeonNetMode::ReplicateLayout && HasAuthority())
+	{
+		PublishNetLayout(DungeonLayout::FLayoutDelta(), Path);
+	}
+	return true;
 }
 
-// Opti : Avoir un sorted array trié par Area dès la création des salles
-void ADungeonGenerator::SelectBiggestRooms(int NumberOfBiggestRooms)
+bool ADungeonGenerator::IsNetLayoutClient() const
 {
-	SelectedRooms.Empty();
+	return NetMode == EDungeonNetMode::ReplicateLayout && !HasAuthority();
+}
 
-	// Copy rooms to a temp array to sort
-	TArray<ARoom*> SortedRooms = Rooms;
+void ADungeonGenerator::PublishNetLayout(const DungeonLayout::FLayoutDelta& Delta, const FString& SourceFile)
+{
+	NetLayout.Generation = NetLayout.Generation + 1;
+	NetLayout.RoomsToSpawn = LayoutParams.RoomsToSpawn;
+	NetLayout.NumberOfBigRoomsToSelect = LayoutParams.NumberOfBigRoomsToSelect;
+	NetLayout.RoomSizeMin = LayoutParams.RoomSizeMin;
+	NetLayout.RoomSizeMax = LayoutParams.RoomSizeMax;
+	NetLayout.RoomUnitSize = LayoutParams.RoomUnitSize;
+	NetLayout.GenerationRadius = LayoutParams.GenerationRadius;
+	NetLayout.GenerationCenter = DungeonLayout::ToVector2D(LayoutParams.GenerationCenter);
+	NetLayout.Seed = static_cast<int64>(LayoutParams.Seed);
+	NetLayout.MaxSeparationIterations = LayoutParams.MaxSeparationIterations;
+	NetLayout.SeparationSolver = static_cast<uint8>(LayoutParams.SeparationSolver);
+	NetLayout.MstAlgorithm = static_cast<uint8>(LayoutParams.MstAlgorithm);
+	NetLayout.CorridorRouting = static_cast<uint8>(LayoutParams.CorridorRouting);
+	NetLayout.CorridorCellSize = LayoutParams.CorridorCellSize;
+	NetLayout.AlgorithmVersion = static_cast<int32>(DungeonLayout::LayoutAlgorithmVersion);
+	NetLayout.Checksum = static_cast<int64>(DungeonLayout::ComputeLayoutChecksum(Layout));
+	NetLayout.LayoutFile = SourceFile;
+
+	NetLayout.Corrections.Reset(static_cast<int32>(Delta.Rooms.size()));
+	for (const DungeonLayout::FLayoutRoomCorrection& Correction : Delta.Rooms)
+	{
+		FDungeonRoomCorrection& NetCorrection = NetLayout.Corrections.AddDefaulted_GetRef();
+		NetCorrection.Room = Correction.Room;
+		NetCorrection.Center = DungeonLayout::ToVector2D(Correction.Center);
+		NetCorrection.HalfExtents = DungeonLayout::ToVector2D(Correction.HalfExtents);
+		NetCorrection.Area = Correction.Area;
+	}
+	ForceNetUpdate();
+}
 
-	// Sort descending by area
-	SortedRooms.Sort([](const ARoom& A, const ARoom& B)
+void ADungeonGenerator::PublishStagedNetLayout()
+{
+	const uint64 Checksum = DungeonLayout::ComputeLayoutChecksum(Layout);
+	TWeakObjectPtr<ADungeonGenerator> WeakThis(this);
+	GenerateDungeonLayoutAsync(LayoutParams, ShouldUseLayoutCache()).Then([WeakThis, Checksum](TFuture<FAsyncDungeonLayout> Future)
 	{
-		return A.Area > B.Area;
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Checksum, Result = Future.Consume()]()
+		{
+			ADungeonGenerator* Generator = WeakThis.Get();
+			if (!Generator || DungeonLayout::ComputeLayoutChecksum(Generator->Layout) != Checksum)
+			{
+				// Destroyed, or the dungeon changed meanwhile
+				return;
+			}
+
+			DungeonLayout::FLayoutDelta Delta;
+			if (!DungeonLayout::ComputeLayoutDelta(Result.Layout, Generator->Layout, Delta))
+			{
+				UE_LOG(LogTemp, Error, TEXT("The staged dungeon has a different room count than its parameters generate, clients cannot rebuild it."));
+				return;
+			}
+			Generator->PublishNetLayout(Delta, FString());
+		});
 	});
+}
 
-	// Take the top NumberOfBiggestRooms
-	for (int32 i = 0; i < FMath::Min(NumberOfBiggestRooms, SortedRooms.Num()); ++i)
+void ADungeonGenerator::OnRep_NetLayout()
+{
+	// BeginPlay picks it up otherwise
+	if (IsNetLayoutClient() && HasActorBegunPlay() && NetLayout.Generation != 0)
+	{
+		RebuildNetLayout();
+	}
+}
+
+void ADungeonGenerator::RebuildNetLayout()
+{
+	if (NetLayout.AlgorithmVersion != static_cast<int32>(DungeonLayout::LayoutAlgorithmVersion))
 	{
-		SelectedRooms.Add(SortedRooms[i]);
+		UE_LOG(LogTemp, Error, TEXT("The server generates layouts with algorithm version %d, this client has %d."),
+			NetLayout.AlgorithmVersion, static_cast<int32>(DungeonLayout::LayoutAlgorithmVersion));
+		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("Selected %d biggest rooms."), SelectedRooms.Num());
+	if (!NetLayout.LayoutFile.IsEmpty())
+	{
+		if (!LoadLayoutFile(NetLayout.LayoutFile))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Cannot load the server's layout file %s."), *NetLayout.LayoutFile);
+		}
+		return;
+	}
 
-	for (ARoom* Room : SelectedRooms)
+	LayoutParams.RoomsToSpawn = NetLayout.RoomsToSpawn;
+	LayoutParams.NumberOfBigRoomsToSelect = NetLayout.NumberOfBigRoomsToSelect;
+	LayoutParams.RoomSizeMin = NetLayout.RoomSizeMin;
+	LayoutParams.RoomSizeMax = NetLayout.RoomSizeMax;
+	LayoutParams.RoomUnitSize = NetLayout.RoomUnitSize;
+	LayoutParams.GenerationRadius = NetLayout.GenerationRadius;
+	LayoutParams.GenerationCenter = DungeonLayout::FVec2(NetLayout.GenerationCenter.X, NetLayout.GenerationCenter.Y);
+	LayoutParams.Seed = static_cast<uint64>(NetLayout.Seed);
+	LayoutParams.MaxSeparationIterations = NetLayout.MaxSeparationIterations;
+	LayoutParams.SeparationSolver = static_cast<DungeonLayout::ESeparationSolver>(NetLayout.SeparationSolver);
+	LayoutParams.MstAlgorithm = static_cast<DungeonLayout::EMstAlgorithm>(NetLayout.MstAlgorithm);
+	LayoutParams.CorridorRouting = static_cast<DungeonLayout::ECorridorRouting>(NetLayout.CorridorRouting);
+	LayoutParams.CorridorCellSize = NetLayout.CorridorCellSize;
+
+	DungeonLayout::FLayoutDelta Delta;
+	Delta.Rooms.reserve(NetLayout.Corrections.Num());
+	for (const FDungeonRoomCorrection& NetCorrection : NetLayout.Corrections)
 	{
-		Room->mesh->SetMaterial(0, SelectedRoomMaterial);
+		DungeonLayout::FLayoutRoomCorrection Correction;
+		Correction.Room = NetCorrection.Room;
+		Correction.Center = DungeonLayout::FVec2(NetCorrection.Center.X, NetCorrection.Center.Y);
+		Correction.HalfExtents = DungeonLayout::FVec2(NetCorrection.HalfExtents.X, NetCorrection.HalfExtents.Y);
+		Correction.Area = NetCorrection.Area;
+		Delta.Rooms.push_back(Correction);
 	}
+	StartLayoutTask(LayoutParams, Delta);
 }
-void ADungeonGenerator::GenerateRoomGraph()
+
+void ADungeonGenerator::VerifyNetLayout() const
 {
-	for (ARoom* room : Rooms)
+	const int64 Checksum = static_cast<int64>(DungeonLayout::ComputeLayoutChecksum(Layout));
+	if (Checksum != NetLayout.Checksum)
 	{
-		room->ComputeFinalValues();
+		UE_LOG(LogTemp, Error, TEXT("Rebuilt dungeon %d differs from the server's (checksum %016llx, server %016llx)."),
+			NetLayout.Generation, static_cast<uint64>(Checksum), static_cast<uint64>(NetLayout.Checksum));
 	}
-	// Select 20 biggest rooms
-	SelectBiggestRooms(NumberOfBigRoomsToSelect);
-
-	GraphGenerator->GenerateGraph(SelectedRooms);
 }
 
-void ADungeonGenerator::CreateRooms()
+void ADungeonGenerator::ApplyGeneratedLayout(FAsyncDungeonLayout&& Result)
 {
-	UE_LOG(LogTemp, Warning, TEXT("%d"), RoomsToSpawn);
-	for (int i = 0; i < RoomsToSpawn; i++)
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_ApplyLayout);
+	SpawnScheduler->Cancel();
+	ReleaseSpawnedRooms();
+	ClearDebugLines();
+	Layout = MoveTemp(Result.Layout);
+	SetSeparationStats(Result.Separation);
+	SetGenerationStats(Result.Stats);
+	LastLayoutMilliseconds = static_cast<float>(Result.Seconds * 1000.0);
+	UE_LOG(LogTemp, Log, TEXT("Dungeon layout %s in %.2f ms: %d rooms, %d corridor segments."),
+		Result.bFromFile ? TEXT("loaded from a file") : Result.bFromCache ? TEXT("loaded from the cache") : TEXT("generated in the background"),
+		LastLayoutMilliseconds, static_cast<int32>(Layout.SelectedRooms.size() + Layout.CorridorRooms.size()),
+		static_cast<int32>(Layout.Corridors.size()));
+
+	if (IsNetLayoutClient())
+	{
+		VerifyNetLayout();
+	}
+	else if (NetMode == EDungeonNetMode::ReplicateLayout && !Result.bFromFile)
 	{
-		//spawning params
-		FActorSpawnParameters tParams;
-		tParams.Owner = this;
-		FRotator rot;
-		FVector loc = GetRandomPointInCircle(GenerationRadius, GenerationCenter);
-		rot = FRotator::ZeroRotator;
-		
-		// Spawn Actor
-		ARoom* newRoom = GetWorld()->SpawnActor<ARoom>(BP_Room, loc, rot, tParams);
+		PublishNetLayout(DungeonLayout::FLayoutDelta(), FString());
+	}
 
-		int scaleX = FMath::RandRange(RoomSizeMin, RoomSizeMax);
-		int scaleY = FMath::RandRange(RoomSizeMin, RoomSizeMax);
+	const DungeonLayout::FLayoutCacheStats CacheStats = GetDungeonLayoutCache().GetStats();
+	LayoutCacheStats.MemoryHits = static_cast<int32>(CacheStats.MemoryHits);
+	LayoutCacheStats.DiskHits = static_cast<int32>(CacheStats.DiskHits);
+	LayoutCacheStats.Misses = static_cast<int32>(CacheStats.Misses);
+	LayoutCacheStats.Evictions = static_cast<int32>(CacheStats.Evictions);
+	LayoutCacheStats.MemoryEntries = static_cast<int32>(CacheStats.MemoryEntries);
+	LayoutCacheStats.DiskEntries = static_cast<int32>(CacheStats.DiskEntries);
+
+	DrawSpanningTree();
+	DrawCorridors();
+	UploadCorridorMesh(MoveTemp(Result.CorridorMesh));
+
+	RoomActors.Init(nullptr, static_cast<int32>(Layout.Rooms.size()));
+	RoomKinds.Init(ERoomSpawnKind::Unselected, static_cast<int32>(Layout.Rooms.size()));
+	for (int32 RoomIndex : Layout.SelectedRooms)
+	{
+		RoomKinds[RoomIndex] = ERoomSpawnKind::Selected;
+	}
+	for (int32 RoomIndex : Layout.CorridorRooms)
+	{
+		RoomKinds[RoomIndex] = ERoomSpawnKind::Corridor;
+	}
 
-		// Scale room randomly
-		FVector scale(scaleX, scaleY,1);
+	if (RoomRenderMode == ERoomRenderMode::Instanced)
+	{
+		// A few batched instance writes instead of an actor per room
+		WriteRoomInstances();
+		FinishSpawning();
+		return;
+	}
+
+	TArray<FRoomSpawnRequest> Requests;
+	Requests.Reserve(static_cast<int32>(Layout.SelectedRooms.size() + Layout.CorridorRooms.size()));
+	for (int32 RoomIndex : Layout.SelectedRooms)
+	{
+		Requests.Add({ ToWorld(Layout.Rooms[RoomIndex].Center), RoomIndex, ERoomSpawnKind::Selected });
+	}
+	for (int32 RoomIndex : Layout.CorridorRooms)
+	{
+		Requests.Add({ ToWorld(Layout.Rooms[RoomIndex].Center), RoomIndex, ERoomSpawnKind::Corridor });
+	}
 
-		newRoom->SetActorScale3D(scale);
-		newRoom->Area = scaleX * scaleY;
-		Rooms.Add(newRoom);
+	if (bTimeSlicedSpawning)
+	{
+		// FinishSpawning runs once the scheduler is done
+		SpawnScheduler->Enqueue(MoveTemp(Requests));
+		return;
 	}
+
+	for (const FRoomSpawnRequest& Request : Requests)
+	{
+		SpawnRequestedRoom(Request);
+	}
+	FinishSpawning();
 }
 
-void ADungeonGenerator::SeparateRooms()
+ARoom* ADungeonGenerator::SpawnRequestedRoom(const FRoomSpawnRequest& Request)
 {
-	for (int32 i = 0; i < Rooms.Num(); ++i)
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_SpawnRooms);
+	ARoom* Room = SpawnRoom(Layout.Rooms[Request.LayoutRoom], GetRoomMaterial(Request.Kind));
+	RoomActors[Request.LayoutRoom] = Room;
+	return Room;
+}
+
+ARoom* ADungeonGenerator::SpawnRoomActor(int32 RoomIndex)
+{
+	if (!RoomActors.IsValidIndex(RoomIndex))
 	{
-		for (int32 j = i + 1; j < Rooms.Num(); ++j)
-		{
-			ARoom* RoomA = Rooms[i];
-			ARoom* RoomB = Rooms[j];
+		return nullptr;
+	}
+	if (RoomActors[RoomIndex])
+	{
+		return RoomActors[RoomIndex];
+	}
 
-			if (!RoomA || !RoomB) continue;
+	ARoom* Room = SpawnRoom(Layout.Rooms[RoomIndex], GetRoomMaterial(RoomKinds[RoomIndex]));
+	if (Room && RoomRenderMode == ERoomRenderMode::Instanced)
+	{
+		// The instance already draws it
+		Room->mesh->SetVisibility(false);
+	}
+	RoomActors[RoomIndex] = Room;
+	return Room;
+}
 
-			if (RoomA->IsOverlappingActor(RoomB))
-			{
+void ADungeonGenerator::WriteRoomInstances()
+{
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_SpawnRooms);
+	UStaticMesh* Mesh = BP_Room ? BP_Room->GetDefaultObject<ARoom>()->mesh->GetStaticMesh() : nullptr;
+	if (!Mesh)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BP_Room has no mesh, cannot draw the rooms as instances."));
+		return;
+	}
 
-				// Get actor bounds (center and extent)
-				FVector OriginA, ExtentA;
-				RoomA->GetActorBounds(true, OriginA, ExtentA);
-
-				FVector OriginB, ExtentB;
-				RoomB->GetActorBounds(true, OriginB, ExtentB);
-
-				// Compute the overlap in X and Y
-				FVector Delta = OriginB - OriginA;
-				FVector Overlap;
-
-				Overlap.X = ExtentA.X + ExtentB.X - FMath::Abs(Delta.X);
-				Overlap.Y = ExtentA.Y + ExtentB.Y - FMath::Abs(Delta.Y);
-				Overlap.Z = 0; // Assume top-down 2D layout
-				
-					
-				// Only separate if overlap is positive and above a certain threshold or else it will never converge
-				if (Overlap.X > 0 && Overlap.Y > 0)
-				{
-					bAnyOverlap = true;
-					// Move in the axis with less overlap
-					FVector Separation = FVector::ZeroVector;
-
-					if (Overlap.X < Overlap.Y)
-					{
-						// add +0.05 to really separate rooms so they're not adjacent (else it still trigger overlap, and also converges faster)
-						Separation.X = (Delta.X < 0 ? -1 : 1) * (Overlap.X * 0.5f + 0.1f);
-					}
-					else
-					{
-						Separation.Y = (Delta.Y < 0 ? -1 : 1) * (Overlap.Y * 0.5f + 0.1f);
-					}
-
-					RoomA->AddActorWorldOffset(-Separation);
-					RoomB->AddActorWorldOffset(Separation);
-				}
+	TArray<FTransform> Selected, Corridor, Unselected;
+	Selected.Reserve(static_cast<int32>(Layout.SelectedRooms.size()));
+	Corridor.Reserve(static_cast<int32>(Layout.CorridorRooms.size()));
+	for (int32 RoomIndex = 0; RoomIndex < RoomKinds.Num(); ++RoomIndex)
+	{
+		const FTransform Transform = GetRoomTransform(Layout.Rooms[RoomIndex]);
+		switch (RoomKinds[RoomIndex])
+		{
+		case ERoomSpawnKind::Selected:
+			Selected.Add(Transform);
+			break;
+		case ERoomSpawnKind::Corridor:
+			Corridor.Add(Transform);
+			break;
+		default:
+			if (bDrawUnselectedRooms)
+			{
+				Unselected.Add(Transform);
 			}
+			break;
+		}
+	}
+
+	auto Write = [Mesh](UHierarchicalInstancedStaticMeshComponent* Instances, UMaterialInterface* Material, const TArray<FTransform>& Transforms)
+	{
+		Instances->SetStaticMesh(Mesh);
+		Instances->SetMaterial(0, Material);
+		Instances->AddInstances(Transforms, false, true);
+	};
+	Write(SelectedRoomInstances, SelectedRoomMaterial, Selected);
+	Write(CorridorRoomInstances, SelectedCorridorRoomMaterial, Corridor);
+	Write(UnselectedRoomInstances, UnselectedRoomMaterial, Unselected);
+}
+
+void ADungeonGenerator::ClearRoomInstances()
+{
+	SelectedRoomInstances->ClearInstances();
+	CorridorRoomInstances->ClearInstances();
+	UnselectedRoomInstances->ClearInstances();
+}
+
+UMaterialInterface* ADungeonGenerator::GetRoomMaterial(ERoomSpawnKind Kind) const
+{
+	switch (Kind)
+	{
+	case ERoomSpawnKind::Selected:
+		return SelectedRoomMaterial;
+	case ERoomSpawnKind::Corridor:
+		return SelectedCorridorRoomMaterial;
+	default:
+		return UnselectedRoomMaterial;
+	}
+}
+
+void ADungeonGenerator::FinishSpawning()
+{
+	// Rooms were spawned nearest first, list them in layout order again
+	SelectedRooms.Empty(static_cast<int32>(Layout.SelectedRooms.size()));
+	for (int32 RoomIndex : Layout.SelectedRooms)
+	{
+		if (RoomActors[RoomIndex])
+		{
+			SelectedRooms.Add(RoomActors[RoomIndex]);
 		}
 	}
+	SelectedCorridorRooms.Empty(static_cast<int32>(Layout.CorridorRooms.size()));
+	for (int32 RoomIndex : Layout.CorridorRooms)
+	{
+		if (RoomActors[RoomIndex])
+		{
+			SelectedCorridorRooms.Add(RoomActors[RoomIndex]);
+		}
+	}
+
+	MST.Empty(static_cast<int32>(Layout.MinimumSpanningTree.size()));
+	for (const DungeonLayout::FLayoutEdge& Edge : Layout.MinimumSpanningTree)
+	{
+		MST.Add(FRoomGraphEdge(RoomActors[Edge.A], RoomActors[Edge.B], Edge.Weight));
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Spawned %d rooms, %d drawn as instances."), SelectedRooms.Num() + SelectedCorridorRooms.Num(),
+		SelectedRoomInstances->GetInstanceCount() + CorridorRoomInstances->GetInstanceCount() + UnselectedRoomInstances->GetInstanceCount());
+	OnDungeonGenerated.Broadcast();
+}
+
+void ADungeonGenerator::ReleaseSpawnedRooms()
+{
+	for (ARoom* Room : Rooms)
+	{
+		RoomPool->Release(Room);
+	}
+	RoomPool->Trim();
+	ClearRoomInstances();
+	CorridorMesh->ClearAllMeshSections();
+	Rooms.Empty();
+	RoomActors.Empty();
+	RoomKinds.Empty();
+	SelectedRooms.Empty();
+	SelectedCorridorRooms.Empty();
+	MST.Empty();
+}
+
+void ADungeonGenerator::SetSeparationStats(const DungeonLayout::FSeparationResult& Result)
+{
+	SeparationStats.Iterations = Result.Iterations;
+	SeparationStats.Milliseconds = static_cast<float>(Result.Seconds * 1000.0);
+	SeparationStats.ResidualOverlap = static_cast<float>(Result.ResidualOverlap);
+	SeparationStats.bConverged = Result.bConverged;
+
+	UE_LOG(LogTemp, Log, TEXT("Room separation %s after %d iterations in %.2f ms, residual overlap %.1f."),
+		Result.bConverged ? TEXT("converged") : TEXT("stopped"), SeparationStats.Iterations,
+		SeparationStats.Milliseconds, SeparationStats.ResidualOverlap);
+}
+
+void ADungeonGenerator::SetGenerationStats(const DungeonLayout::FLayoutStats& Stats)
+{
+	LastGenerationStats.Set(Stats);
+	SetLastGenerationStats(Stats);
+	UE_LOG(LogTemp, Log, TEXT("Dungeon generation stats: %s"), *LastGenerationStats.ToString());
+}
+
+void ADungeonGenerator::SeparateRoomsStep()
+{
+	if (Separator.IsDone())
+	{
+		// Stop timer
+		GetWorldTimerManager().ClearTimer(RoomSeparationTimer);
+	
+		FinishRoomSeparation();
+		return;
+	}
+
+	{
+		DungeonLayout::FLayoutStageScope Scope(DungeonLayout::ELayoutStage::Separation, &StagedStats);
+		Separator.Step(Layout.Rooms);
+	}
+	DrawLayoutRooms();
+}
+
+bool ADungeonGenerator::RunRoomSeparation(double BudgetMilliseconds)
+{
+	DungeonLayout::FLayoutStageScope Scope(DungeonLayout::ELayoutStage::Separation, &StagedStats);
+	return Separator.Run(Layout.Rooms, BudgetMilliseconds);
+}
+
+void ADungeonGenerator::SeparateRoomsSlice()
+{
+	if (RunRoomSeparation(SeparationBudgetMs))
+	{
+		FinishRoomSeparation();
+		return;
+	}
+
+	// Carry on next frame. Kept so Regenerate can stop the chain.
+	RoomSeparationTimer = GetWorldTimerManager().SetTimerForNextTick(this, &ADungeonGenerator::SeparateRoomsSlice);
+}
+
+
+void ADungeonGenerator::StartRoomSeparation()
+{
+	Separator.Reset(DungeonLayout::ComputeBroadphaseCellSize(LayoutParams), LayoutParams.MaxSeparationIterations, LayoutParams.SeparationSolver);
+
+	switch (SeparationMode)
+	{
+	case ERoomSeparationMode::Animated:
+		// Start timer that ticks every frame
+		GetWorldTimerManager().SetTimer(RoomSeparationTimer, this, &ADungeonGenerator::SeparateRoomsStep, 1/60.0, true);
+		break;
+	case ERoomSeparationMode::TimeSliced:
+		SeparateRoomsSlice();
+		break;
+	case ERoomSeparationMode::Blocking:
+		RunRoomSeparation(0.0);
+		FinishRoomSeparation();
+		break;
+	}
+}
+
+void ADungeonGenerator::FinishRoomSeparation()
+{
+	ClearDebugLines();
+	SetSeparationStats(Separator.GetResult());
+	StagedStats.SeparationIterations = Separator.GetResult().Iterations;
+	StagedStats.OverlapPairsTested = Separator.GetResult().PairsTested;
+	GenerateRoomGraph();
+}
+
+DungeonLayout::FLayoutParams ADungeonGenerator::MakeLayoutParams()
+{
+	if (bRandomSeed)
+	{
+		Seed = FMath::Rand();
+	}
+
+	DungeonLayout::FLayoutParams Params;
+	Params.RoomsToSpawn = RoomsToSpawn;
+	Params.NumberOfBigRoomsToSelect = NumberOfBigRoomsToSelect;
+	Params.RoomSizeMin = RoomSizeMin;
+	Params.RoomSizeMax = RoomSizeMax;
+	Params.RoomUnitSize = RoomUnitSize;
+	Params.GenerationRadius = GenerationRadius;
+	Params.GenerationCenter = DungeonLayout::ToLayout(GenerationCenter);
+	Params.Seed = static_cast<uint64>(static_cast<uint32>(Seed));
+	Params.MaxSeparationIterations = MaxSeparationIterations;
+	Params.SeparationSolver = bParallelSeparation ? DungeonLayout::ESeparationSolver::Jacobi : DungeonLayout::ESeparationSolver::GaussSeidel;
+	Params.MstAlgorithm = SpanningTreeAlgorithm == ESpanningTreeAlgorithm::Prim ? DungeonLayout::EMstAlgorithm::Prim : DungeonLayout::EMstAlgorithm::Kruskal;
+	Params.CorridorRouting = CorridorRouting == ECorridorRoutingMode::Grid ? DungeonLayout::ECorridorRouting::Grid : DungeonLayout::ECorridorRouting::Straight;
+	Params.CorridorCellSize = CorridorCellSize;
+	return Params;
+}
+
+FVector ADungeonGenerator::ToWorld(const DungeonLayout::FVec2& Point) const
+{
+	return DungeonLayout::ToWorld(Point, GenerationCenter.Z);
+}
+
+FTransform ADungeonGenerator::GetRoomTransform(const DungeonLayout::FLayoutRoom& LayoutRoom) const
+{
+	// Scale back from the layout extents
+	const FVector Scale(LayoutRoom.HalfExtents.X * 2 / RoomUnitSize, LayoutRoom.HalfExtents.Y * 2 / RoomUnitSize, 1);
+	return FTransform(FRotator::ZeroRotator, ToWorld(LayoutRoom.Center), Scale);
+}
+
+ARoom* ADungeonGenerator::SpawnRoom(const DungeonLayout::FLayoutRoom& LayoutRoom, UMaterialInterface* Material)
+{
+	// Reuses a room released by a previous dungeon when there is one
+	ARoom* newRoom = RoomPool->Acquire(BP_Room, GetRoomTransform(LayoutRoom));
+	if (!newRoom)
+	{
+		return nullptr;
+	}
+
+	newRoom->Area = LayoutRoom.Area;
+	newRoom->ComputeFinalValues();
+	newRoom->mesh->SetMaterial(0, Material);
+	newRoom->mesh->SetVisibility(true);
+	if (NetMode == EDungeonNetMode::ReplicateLayout)
+	{
+		// Every machine spawns its own rooms
+		newRoom->SetReplicates(false);
+	}
+	Rooms.Add(newRoom);
+	return newRoom;
+}
+
+void ADungeonGenerator::DrawLayoutRooms() const
+{
+#if WITH_DUNGEON_DEBUG_DRAW
+	if (!bDrawDebugLines)
+	{
+		return;
+	}
+
+	// Rooms moved since the last pass, the batch only holds the rooms while they are separated
+	FDungeonDebugDraw::Clear(DebugLines);
+	FDungeonDebugDraw Draw(DebugLines);
+	for (const DungeonLayout::FLayoutRoom& Room : Layout.Rooms)
+	{
+		Draw.Rectangle(ToWorld(Room.Center), DungeonLayout::ToVector2D(Room.HalfExtents), FColor::White, 10.f);
+	}
+#endif
+}
+
+void ADungeonGenerator::DrawSpanningTree() const
+{
+#if WITH_DUNGEON_DEBUG_DRAW
+	if (!bDrawDebugLines)
+	{
+		return;
+	}
+
+	FDungeonDebugDraw Draw(DebugLines);
+	for (const DungeonLayout::FLayoutEdge& Edge : Layout.MinimumSpanningTree)
+	{
+		Draw.Line(ToWorld(Layout.Rooms[Edge.A].Center), ToWorld(Layout.Rooms[Edge.B].Center), FColor::Red, 35.f);
+	}
+#endif
+}
+
+void ADungeonGenerator::DrawCorridors() const
+{
+#if WITH_DUNGEON_DEBUG_DRAW
+	if (!bDrawDebugLines)
+	{
+		return;
+	}
+
+	FDungeonDebugDraw Draw(DebugLines);
+	for (const DungeonLayout::FCorridorSegment& Segment : Layout.Corridors)
+	{
+		Draw.Line(ToWorld(Segment.Start), ToWorld(Segment.End), FColor::Blue, 50.f);
+	}
+#endif
+}
+
+void ADungeonGenerator::ClearDebugLines()
+{
+#if WITH_DUNGEON_DEBUG_DRAW
+	FDungeonDebugDraw::Clear(DebugLines);
+#endif
+}
+
+void ADungeonGenerator::SelectBiggestRooms(int NumberOfBiggestRooms)
+{
+	SelectedRooms.Empty();
+	{
+		DungeonLayout::FLayoutStageScope Scope(DungeonLayout::ELayoutStage::Selection, &StagedStats);
+		DungeonLayout::SelectBiggestRooms(Layout.Rooms, NumberOfBiggestRooms, Layout.SelectedRooms);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Selected %d biggest rooms."), static_cast<int32>(Layout.SelectedRooms.size()));
+
+	// Only the selected rooms become actors, the others stay pure data
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_SpawnRooms);
+	for (int32 RoomIndex : Layout.SelectedRooms)
+	{
+		SelectedRooms.Add(SpawnRoom(Layout.Rooms[RoomIndex], SelectedRoomMaterial));
+	}
+}
+void ADungeonGenerator::GenerateRoomGraph()
+{
+	// Select 20 biggest rooms
+	SelectBiggestRooms(NumberOfBigRoomsToSelect);
+
+	std::vector<DungeonLayout::FVec2> Points;
+	DungeonLayout::GatherSelectedCenters(Layout, Points);
+	GraphGenerator->MstAlgorithm = LayoutParams.MstAlgorithm;
+	GraphGenerator->DebugLines = bDrawDebugLines ? DebugLines : nullptr;
+	GraphGenerator->GenerateGraph(SelectedRooms, Points);
+}
+
+void ADungeonGenerator::CreateRooms()
+{
+	UE_LOG(LogTemp, Warning, TEXT("%d"), RoomsToSpawn);
+	// Drops the corridors of a previous staged dungeon still being routed
+	++LayoutRequestId;
+	Layout = DungeonLayout::FDungeonLayout();
+	StagedStats = DungeonLayout::FLayoutStats();
+
+	LayoutParams = MakeLayoutParams();
+	DungeonLayout::FLayoutStageScope Scope(DungeonLayout::ELayoutStage::Scatter, &StagedStats);
+	DungeonLayout::ScatterRooms(LayoutParams, Layout.Rooms);
 }
 
 void ADungeonGenerator::BuildCorridorsFromMST(const TArray<FRoomGraphEdge>& InMST)
 {
-	MST = InMST;
     UWorld* World = GetWorld();
     if (!World) return;
 
-    for (const FRoomGraphEdge& Edge : MST)
-    {
-        if (!Edge.RoomA || !Edge.RoomB) continue;
-        FVector PosA = Edge.RoomA->GetCenter(); 
-        FVector PosB = Edge.RoomB->GetCenter();
-
-        // Get extents
-        float HalfWidthA = Edge.RoomA->GetWidth() * 0.5f;
-        float HalfWidthB = Edge.RoomB->GetWidth() * 0.5f;
-        float HalfHeightA = Edge.RoomA->GetHeight() * 0.5f;
-        float HalfHeightB = Edge.RoomB->GetHeight() * 0.5f;
-
-        float MinAX = PosA.X - HalfWidthA;
-        float MaxAX = PosA.X + HalfWidthA;
-        float MinBX = PosB.X - HalfWidthB;
-        float MaxBX = PosB.X + HalfWidthB;
-
-        float MinAY = PosA.Y - HalfHeightA;
-        float MaxAY = PosA.Y + HalfHeightA;
-        float MinBY = PosB.Y - HalfHeightB;
-        float MaxBY = PosB.Y + HalfHeightB;
-
-        bool bOverlapX = (MinAX <= MaxBX) && (MaxAX >= MinBX);
-        bool bOverlapY = (MinAY <= MaxBY) && (MaxAY >= MinBY);
-
-        if (bOverlapX)
-        {
-            // Draw vertical corridor: align X in the middle
-            float MidX = FMath::Max(MinAX, MinBX) + (FMath::Min(MaxAX, MaxBX) - FMath::Max(MinAX, MinBX)) * 0.5f;
-            FVector From(MidX, PosA.Y, PosA.Z);
-            FVector To(MidX, PosB.Y, PosB.Z);
-            DrawDebugLine(World, From, To, FColor::Blue, true, 10.f, 0, 50.f);
-        }
-        else if (bOverlapY)
-        {
-            // Draw horizontal corridor: align Y in the middle
-            float MidY = FMath::Max(MinAY, MinBY) + (FMath::Min(MaxAY, MaxBY) - FMath::Max(MinAY, MinBY)) * 0.5f;
-            FVector From(PosA.X, MidY, PosA.Z);
-            FVector To(PosB.X, MidY, PosB.Z);
-            DrawDebugLine(World, From, To, FColor::Blue, true, 10.f, 0, 50.f);
-			FindIntersectingRooms(From, To);
-        }
-        else
-        {
-            // L-shaped: first go in X, then in Y (you could randomize the order)
-            FVector Corner(PosB.X, PosA.Y, PosA.Z);
-            DrawDebugLine(World, PosA, Corner, FColor::Blue, true, 10.f, 0, 50.f);
-            DrawDebugLine(World, Corner, PosB, FColor::Blue, true, 10.f, 0, 50.f);
-        	FindIntersectingRooms(PosA, Corner);
-        	FindIntersectingRooms(PosB, Corner);
-        }
-    }
+	// A tree of an older dungeon would index past the selected rooms
+	const int32_t NumSelected = static_cast<int32_t>(Layout.SelectedRooms.size());
+	for (const DungeonLayout::FLayoutEdge& Edge : GraphGenerator->LayoutTree)
+	{
+		if (Edge.A < 0 || Edge.A >= NumSelected || Edge.B < 0 || Edge.B >= NumSelected)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Spanning tree does not match the selected rooms, dropped."));
+			return;
+		}
+	}
+
+	MST = InMST;
+	DungeonLayout::SetMinimumSpanningTree(Layout, GraphGenerator->LayoutTree);
+	StagedStats.Add(GraphGenerator->GraphStats);
+	Layout.Corridors.clear();
+	Layout.CorridorRooms.clear();
+
+	// Corridor rooms come from FCorridorRoomFinder, no physics scene involved, so the routing runs on a worker
+	// against a copy of the layout
+	const uint32 RequestId = LayoutRequestId;
+	TWeakObjectPtr<ADungeonGenerator> WeakThis(this);
+	const bool bBuildMesh = bBuildCorridorMeshes;
+	Async(EAsyncExecution::ThreadPool, [WeakThis, RequestId, Params = LayoutParams, Routed = Layout, bBuildMesh, MeshParams = MakeCorridorMeshParams(), FloorZ = GenerationCenter.Z]() mutable
+	{
+		DungeonLayout::FLayoutStats CorridorStats;
+		DungeonLayout::BuildLayoutCorridors(Params, Routed, &CorridorStats);
+		TArray<FCorridorMeshSectionData> Sections;
+		if (bBuildMesh)
+		{
+			BuildCorridorMeshSections(Routed, MeshParams, FloorZ, Sections);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, RequestId, Routed = MoveTemp(Routed), Sections = MoveTemp(Sections), CorridorStats]() mutable
+		{
+			ADungeonGenerator* Generator = WeakThis.Get();
+			if (!Generator || Generator->LayoutRequestId != RequestId)
+			{
+				// Destroyed, or a newer dungeon was requested meanwhile
+				return;
+			}
+			Generator->FinishStagedCorridors(MoveTemp(Routed), MoveTemp(Sections), CorridorStats);
+		});
+	});
+}
+
+void ADungeonGenerator::FinishStagedCorridors(DungeonLayout::FDungeonLayout&& Routed, TArray<FCorridorMeshSectionData>&& CorridorMeshSections,
+	const DungeonLayout::FLayoutStats& CorridorStats)
+{
+	Layout.Corridors = MoveTemp(Routed.Corridors);
+	Layout.CorridorRooms = MoveTemp(Routed.CorridorRooms);
+	StagedStats.Add(CorridorStats);
+	SetGenerationStats(StagedStats);
+	SpawnCorridors();
+	UploadCorridorMesh(MoveTemp(CorridorMeshSections));
+	if (NetMode == EDungeonNetMode::ReplicateLayout)
+	{
+		PublishStagedNetLayout();
+	}
 
     UE_LOG(LogTemp, Log, TEXT("Corridors drawn from MST."));
+	OnDungeonGenerated.Broadcast();
 	
-	// TODO NEXT STEPS : DELETE UNSELECTED ROOMS, BUILD REAL CORRIDORS, REAL ROOMS AND CONNECTION MODULES WITH DOORS
+	// TODO NEXT STEPS : REAL ROOMS AND DOOR MODULES IN THE CORRIDOR DOORWAYS
 }
 
-void ADungeonGenerator::FindIntersectingRooms(const FVector& Start, const FVector& End)
+DungeonLayout::FCorridorMeshParams ADungeonGenerator::MakeCorridorMeshParams() const
 {
-	TArray<FHitResult> HitResults;
+	DungeonLayout::FCorridorMeshParams Params;
+	Params.CellSize = CorridorCellSize;
+	Params.WallHeight = CorridorWallHeight;
+	Params.DoorHeight = CorridorDoorHeight;
+	return Params;
+}
 
-	FCollisionQueryParams TraceParams;
-	// Ignore the selected rooms:
-	for (ARoom* Selected : SelectedRooms)
+void ADungeonGenerator::UploadCorridorMesh(TArray<FCorridorMeshSectionData>&& Sections)
+{
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_UploadCorridorMesh);
+	CorridorMesh->ClearAllMeshSections();
+	for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); ++SectionIndex)
 	{
-		if (Selected)
-			TraceParams.AddIgnoredActor(Selected);
+		const FCorridorMeshSectionData& Section = Sections[SectionIndex];
+		CorridorMesh->CreateMeshSection(SectionIndex, Section.Vertices, Section.Triangles, Section.Normals, Section.UVs,
+			TArray<FColor>(), TArray<FProcMeshTangent>(), true);
+		CorridorMesh->SetMaterial(SectionIndex, CorridorMaterial);
 	}
+}
 
-	GetWorld()->LineTraceMultiByChannel(
-		HitResults,
-		Start,
-		End,
-		ECC_WorldStatic,   // or ECC_GameTraceChannel1 if you set up a custom channel
-		TraceParams
-	);
-	for (const FHitResult& Hit : HitResults)
+void ADungeonGenerator::SpawnCorridors()
+{
+	DrawCorridors();
+
+	// Rooms crossed by a corridor are part of the dungeon too
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_SpawnRooms);
+	for (int32 RoomIndex : Layout.CorridorRooms)
 	{
-		ARoom* HitRoom = Cast<ARoom>(Hit.GetActor());
-		if (HitRoom && !SelectedRooms.Contains(HitRoom) && !SelectedCorridorRooms.Contains(HitRoom))
-		{
-			SelectedCorridorRooms.Add(HitRoom);
-			// Change its material
-			UStaticMeshComponent* Mesh = HitRoom->FindComponentByClass<UStaticMeshComponent>();
-			if (Mesh)
-			{
-				Mesh->SetMaterial(0, SelectedCorridorRoomMaterial);
-			}
-		}
+		SelectedCorridorRooms.Add(SpawnRoom(Layout.Rooms[RoomIndex], SelectedCorridorRoomMaterial));
 	}
-}
\ No newline at end of file
+}
+
+void FDungeonGenerationStats::Set(const DungeonLayout::FLayoutStats& Stats)
+{
+	auto StageMilliseconds = [&Stats](DungeonLayout::ELayoutStage Stage)
+	{
+		return static_cast<float>(Stats.GetStageSeconds(Stage) * 1000.0);
+	};
+	ScatterMilliseconds = StageMilliseconds(DungeonLayout::ELayoutStage::Scatter);
+	SeparationMilliseconds = StageMilliseconds(DungeonLayout::ELayoutStage::Separation);
+	SelectionMilliseconds = StageMilliseconds(DungeonLayout::ELayoutStage::Selection);
+	DelaunayMilliseconds = StageMilliseconds(DungeonLayout::ELayoutStage::Delaunay);
+	RoomGraphMilliseconds = StageMilliseconds(DungeonLayout::ELayoutStage::RoomGraph);
+	SpanningTreeMilliseconds = StageMilliseconds(DungeonLayout::ELayoutStage::SpanningTree);
+	CorridorsMilliseconds = StageMilliseconds(DungeonLayout::ELayoutStage::Corridors);
+	SeparationIterations = Stats.SeparationIterations;
+	OverlapPairsTested = Stats.OverlapPairsTested;
+	DelaunayInsertions = Stats.DelaunayInsertions;
+	BadTrianglesPerInsertion = Stats.DelaunayInsertions > 0 ? static_cast<float>(Stats.DelaunayBadTriangles) / Stats.DelaunayInsertions : 0.f;
+	MaxBadTrianglesPerInsertion = Stats.MaxDelaunayBadTriangles;
+	GraphEdges = Stats.GraphEdges;
+	SpanningTreeEdges = Stats.SpanningTreeEdges;
+	CorridorSegments = Stats.CorridorSegments;
+}
+
+FString FDungeonGenerationStats::ToString() const
+{
+	return FString::Printf(TEXT("scatter %.2f ms, separation %.2f ms (%d iterations, %lld pairs tested), selection %.2f ms, ")
+		TEXT("delaunay %.2f ms (%d insertions, %.2f bad triangles per insertion, %d at most), room graph %.2f ms (%d edges), ")
+		TEXT("spanning tree %.2f ms (%d edges), corridors %.2f ms (%d segments)"),
+		ScatterMilliseconds, SeparationMilliseconds, SeparationIterations, OverlapPairsTested, SelectionMilliseconds,
+		DelaunayMilliseconds, DelaunayInsertions, BadTrianglesPerInsertion, MaxBadTrianglesPerInsertion, RoomGraphMilliseconds, GraphEdges,
+		SpanningTreeMilliseconds, SpanningTreeEdges, CorridorsMilliseconds, CorridorSegments);
+}
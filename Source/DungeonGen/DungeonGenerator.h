@@ -4,7 +4,23 @@
 
 #include "CoreMinimal.h"
 #include "Room.h"
+#include "Layout/LayoutCorridorMesh.h"
+#include "Layout/LayoutReplication.h"
+#include "Layout/LayoutSeparation.h"
+#include "Layout/LayoutStats.h"
+#include "Layout/LayoutTypes.h"
+class UHierarchicalInstancedStaticMeshComponent;
+class ULineBatchComponent;
+class UProceduralMeshComponent;
+class URoomActorPool;
 class URoomGraphGenerator;
+class URoomSpawnScheduler;
+struct FAsyncDungeonLayout;
+struct FCorridorMeshSectionData;
+struct FRoomSpawnRequest;
+enum class ERoomSpawnKind : uint8;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDungeonGenerated);
 #include "GameFramework/Actor.h"
 #include "DungeonGenerator.generated.h"
 
@@ -31,14 +47,61 @@ struct FTriangle2D
 
 	UPROPERTY()
 	FVector2D C2D;
+
+	// Corners as indices into the selected rooms, INDEX_NONE when the triangle was built from positions only
+	UPROPERTY()
+	int32 RoomA = INDEX_NONE;
+
+	UPROPERTY()
+	int32 RoomB = INDEX_NONE;
+
+	UPROPERTY()
+	int32 RoomC = INDEX_NONE;
+
+	// Circumcircle, computed once on construction. Negative radius for degenerate triangles.
+	UPROPERTY()
+	FVector2D Circumcenter = FVector2D::ZeroVector;
+
+	UPROPERTY()
+	double CircumradiusSquared = -1.0;
 	
 	FTriangle2D() {}
 
 	FTriangle2D(const FVector& InA, const FVector& InB, const FVector& InC)
-		: A(InA), B(InB), C(InC), A2D(InA.X, InA.Y), B2D(InB.X, InB.Y), C2D(InC.X, InC.Y) {}
+		: A(InA), B(InB), C(InC), A2D(InA.X, InA.Y), B2D(InB.X, InB.Y), C2D(InC.X, InC.Y)
+	{
+		ComputeCircumcircle();
+	}
 
 	FTriangle2D(const FVector2D& InA, const FVector2D& InB, const FVector2D& InC)
-		: A(InA.X, InA.Y, 0), B(InB.X, InB.Y, 0), C(InC.X, InC.Y, 0), A2D(InA), B2D(InB), C2D(InC) {}
+		: A(InA.X, InA.Y, 0), B(InB.X, InB.Y, 0), C(InC.X, InC.Y, 0), A2D(InA), B2D(InB), C2D(InC)
+	{
+		ComputeCircumcircle();
+	}
+
+	bool IsInsideCircumcircle(const FVector2D& Point) const
+	{
+		return FVector2D::DistSquared(Point, Circumcenter) < CircumradiusSquared;
+	}
+
+	void ComputeCircumcircle()
+	{
+		const FVector2D AB = B2D - A2D;
+		const FVector2D AC = C2D - A2D;
+		const double Denom = 2.0 * (AB.X * AC.Y - AB.Y * AC.X);
+		if (FMath::Abs(Denom) < UE_DOUBLE_SMALL_NUMBER)
+		{
+			Circumcenter = (A2D + B2D + C2D) / 3.0;
+			CircumradiusSquared = -1.0;
+			return;
+		}
+
+		const double ABSquared = AB.SizeSquared();
+		const double ACSquared = AC.SizeSquared();
+		const FVector2D Offset((AC.Y * ABSquared - AB.Y * ACSquared) / Denom, (AB.X * ACSquared - AC.X * ABSquared) / Denom);
+		Circumcenter = A2D + Offset;
+		CircumradiusSquared = Offset.SizeSquared();
+	}
 
 	bool operator==(const FTriangle2D& Other) const
 	{
@@ -48,60 +111,257 @@ struct FTriangle2D
 
 };
 USTRUCT()
-struct FRoomGraphNode
+struct FRoomGraphEdge
 {
 	GENERATED_BODY()
 
 	UPROPERTY()
-	ARoom* Room;
+	ARoom* RoomA;
 
-	// Connected neighbors and weights
 	UPROPERTY()
-	TArray<ARoom*> Neighbors;
+	ARoom* RoomB;
 
 	UPROPERTY()
-	TArray<float> Weights; // optional: store weight of each edge
+	float Weight;
 
-	FRoomGraphNode() : Room(nullptr) {}
-	FRoomGraphNode(ARoom* InRoom) : Room(InRoom) {}
+	FRoomGraphEdge() : RoomA(nullptr), RoomB(nullptr), Weight(0.f) {}
+	FRoomGraphEdge(ARoom* InA, ARoom* InB, float InWeight) : RoomA(InA), RoomB(InB), Weight(InWeight) {}
+};
+
+
+UENUM(BlueprintType)
+enum class ERoomSeparationMode : uint8
+{
+	// One pass per timer tick with the rooms drawn each pass, for debugging
+	Animated,
+	// As many passes per frame as SeparationBudgetMs allows
+	TimeSliced,
+	// Everything in one call
+	Blocking
+};
+
+UENUM(BlueprintType)
+enum class ESpanningTreeAlgorithm : uint8
+{
+	// Grows the tree from one room with a heap
+	Prim,
+	// Sorts every edge once and merges with union-find, fastest on big graphs
+	Kruskal
+};
+
+UENUM(BlueprintType)
+enum class ECorridorRoutingMode : uint8
+{
+	// Straight when the rooms overlap on one axis, L-shaped otherwise
+	Straight,
+	// A* on a grid of CorridorCellSize cells. Corridors merge, avoid needless turns and go through rooms when they can.
+	Grid
+};
+
+UENUM(BlueprintType)
+enum class ERoomRenderMode : uint8
+{
+	// One ARoom actor per dungeon room
+	Actors,
+	// Rooms are instances of BP_Room's mesh, one instanced component per material. ARoom actors are only
+	// spawned on demand by SpawnRoomActor.
+	Instanced
+};
+
+USTRUCT(BlueprintType)
+struct FRoomSeparationStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Iterations = 0;
+
+	// Time spent separating, not counting the frames in between slices
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Milliseconds = 0.f;
+
+	// Overlapping area left when the iteration cap was hit, 0 when converged
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float ResidualOverlap = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bConverged = false;
+};
+
+UENUM(BlueprintType)
+enum class EDungeonNetMode : uint8
+{
+	// The server spawns the rooms and they replicate like any actor
+	ReplicateActors,
+	// Only NetLayout replicates. Clients rebuild the layout from it and spawn their own rooms, which do not replicate.
+	ReplicateLayout
 };
 
 USTRUCT()
-struct FRoomGraphEdge
+struct FDungeonRoomCorrection
 {
 	GENERATED_BODY()
 
 	UPROPERTY()
-	ARoom* RoomA;
+	int32 Room = INDEX_NONE;
 
 	UPROPERTY()
-	ARoom* RoomB;
+	FVector2D Center = FVector2D::ZeroVector;
 
 	UPROPERTY()
-	float Weight;
+	FVector2D HalfExtents = FVector2D::ZeroVector;
 
-	FRoomGraphEdge() : RoomA(nullptr), RoomB(nullptr), Weight(0.f) {}
-	FRoomGraphEdge(ARoom* InA, ARoom* InB, float InWeight) : RoomA(InA), RoomB(InB), Weight(InWeight) {}
+	UPROPERTY()
+	float Area = 0.f;
 };
 
-
+// What a client needs to rebuild the server's dungeon in ReplicateLayout mode: the generation parameters,
+// the rooms where the server's layout differs from what they generate, and a checksum of the result
 USTRUCT()
-struct FEdge2D
+struct FDungeonNetLayout
 {
 	GENERATED_BODY()
 
-	FVector2D A;
-	FVector2D B;
+	// Bumped by the server for every dungeon, 0 until the first one
+	UPROPERTY()
+	int32 Generation = 0;
 
-	FEdge2D() {}
-	FEdge2D(const FVector2D& InA, const FVector2D& InB) : A(InA), B(InB) {}
+	UPROPERTY()
+	int32 RoomsToSpawn = 0;
 
-	bool operator==(const FEdge2D& Other) const
-	{
-		return (A == Other.A && B == Other.B) || (A == Other.B && B == Other.A);
-	}
+	UPROPERTY()
+	int32 NumberOfBigRoomsToSelect = 0;
+
+	UPROPERTY()
+	float RoomSizeMin = 0.f;
+
+	UPROPERTY()
+	float RoomSizeMax = 0.f;
+
+	UPROPERTY()
+	float RoomUnitSize = 0.f;
+
+	UPROPERTY()
+	float GenerationRadius = 0.f;
+
+	UPROPERTY()
+	FVector2D GenerationCenter = FVector2D::ZeroVector;
+
+	UPROPERTY()
+	int64 Seed = 0;
+
+	UPROPERTY()
+	int32 MaxSeparationIterations = 0;
+
+	UPROPERTY()
+	uint8 SeparationSolver = 0;
+
+	UPROPERTY()
+	uint8 MstAlgorithm = 0;
+
+	UPROPERTY()
+	uint8 CorridorRouting = 0;
+
+	UPROPERTY()
+	float CorridorCellSize = 0.f;
+
+	// A client on another DungeonLayout::LayoutAlgorithmVersion cannot rebuild the layout
+	UPROPERTY()
+	int32 AlgorithmVersion = 0;
+
+	UPROPERTY()
+	int64 Checksum = 0;
+
+	// Set when the server loaded a layout file, clients load the same file instead of generating
+	UPROPERTY()
+	FString LayoutFile;
+
+	UPROPERTY()
+	TArray<FDungeonRoomCorrection> Corrections;
+};
+
+// Stage timings and counters of the last dungeon, also in stat DungeonGen. Zero for the stages that did not run,
+// like every stage of a cached or loaded layout. Log it with ToString, or export it as any struct.
+USTRUCT(BlueprintType)
+struct FDungeonGenerationStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float ScatterMilliseconds = 0.f;
+
+	// Every slice of a time sliced separation, not the frames in between
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float SeparationMilliseconds = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float SelectionMilliseconds = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float DelaunayMilliseconds = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float RoomGraphMilliseconds = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float SpanningTreeMilliseconds = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float CorridorsMilliseconds = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SeparationIterations = 0;
+
+	// Room pairs tested for overlap after the broadphase
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int64 OverlapPairsTested = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 DelaunayInsertions = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float BadTrianglesPerInsertion = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 MaxBadTrianglesPerInsertion = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 GraphEdges = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SpanningTreeEdges = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 CorridorSegments = 0;
+
+	void Set(const DungeonLayout::FLayoutStats& Stats);
+	FString ToString() const;
 };
 
+// Process wide layout cache counters, see GetDungeonLayoutCache
+USTRUCT(BlueprintType)
+struct FDungeonLayoutCacheStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 MemoryHits = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 DiskHits = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Misses = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Evictions = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 MemoryEntries = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 DiskEntries = 0;
+};
 
 UCLASS()
 class DUNGEONGEN_API ADungeonGenerator : public AActor
@@ -115,14 +375,61 @@ public:
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
 	URoomGraphGenerator* GraphGenerator;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	URoomSpawnScheduler* SpawnScheduler;
+
+	// Instanced render mode, one component per room material
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	UHierarchicalInstancedStaticMeshComponent* SelectedRoomInstances;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	UHierarchicalInstancedStaticMeshComponent* CorridorRoomInstances;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	UHierarchicalInstancedStaticMeshComponent* UnselectedRoomInstances;
+
+	// Every corridor floor, wall and doorway, one section per region. Placed in world space.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	UProceduralMeshComponent* CorridorMesh;
+
+	// Rooms of previous dungeons are recycled instead of destroyed
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	URoomActorPool* RoomPool;
+
+	// Debug lines of the generation stages, see DungeonDebugDraw.h. Null in shipping and dedicated server builds.
+	UPROPERTY(VisibleAnywhere, Category="Components")
+	ULineBatchComponent* DebugLines;
 	
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	void SeparateRoomsStep();
+	void SeparateRoomsSlice();
+	// Separator.Run, timed as the separation stage
+	bool RunRoomSeparation(double BudgetMilliseconds);
 	void StartRoomSeparation();
-
-	static FVector GetRandomPointInCircle(float Size, FVector GenerationCenter);
-
+	void FinishRoomSeparation();
+
+	// Pure data layout, actors are only spawned for the rooms that end up in the dungeon
+	DungeonLayout::FDungeonLayout Layout;
+	DungeonLayout::FLayoutParams LayoutParams;
+
+	DungeonLayout::FRoomSeparator Separator;
+
+	// Picks a new Seed first when bRandomSeed is set
+	DungeonLayout::FLayoutParams MakeLayoutParams();
+	ARoom* SpawnRoom(const DungeonLayout::FLayoutRoom& LayoutRoom, UMaterialInterface* Material);
+	FTransform GetRoomTransform(const DungeonLayout::FLayoutRoom& LayoutRoom) const;
+	UMaterialInterface* GetRoomMaterial(ERoomSpawnKind Kind) const;
+	FVector ToWorld(const DungeonLayout::FVec2& Point) const;
+	// Debug drawing, compiled out with WITH_DUNGEON_DEBUG_DRAW
+	void DrawLayoutRooms() const;
+	void DrawSpanningTree() const;
+	void DrawCorridors() const;
+	void ClearDebugLines();
+
+	// Every spawned room
 	UPROPERTY()
 	TArray<ARoom*> Rooms;
 	UPROPERTY()
@@ -130,23 +437,153 @@ protected:
 	UPROPERTY()
 	TArray<ARoom*> SelectedCorridorRooms;
 	
-	bool bAnyOverlap;
-	
+	// Animated steps, or the next time slice
 	FTimerHandle RoomSeparationTimer;
 
 	TArray<FRoomGraphEdge> MST;
 
 	void CreateRooms();
-	void SeparateRooms();
 	void SelectBiggestRooms(int NumberOfBiggestRooms);
 	void GenerateRoomGraph();
 
 	UFUNCTION()
 	void BuildCorridorsFromMST(const TArray<FRoomGraphEdge>& InMST);
 
-	void FindIntersectingRooms(const FVector& Start, const FVector& End);
+	// Game thread half of BuildCorridorsFromMST, once the corridors are routed and meshed
+	void FinishStagedCorridors(DungeonLayout::FDungeonLayout&& Routed, TArray<FCorridorMeshSectionData>&& CorridorMeshSections,
+		const DungeonLayout::FLayoutStats& CorridorStats);
+
+	// Game thread end of GenerateDungeonAsync: only spawns actors and draws, the layout is final
+	void ApplyGeneratedLayout(FAsyncDungeonLayout&& Result);
+	void SpawnCorridors();
+	DungeonLayout::FCorridorMeshParams MakeCorridorMeshParams() const;
+	// The only game thread part of the corridor mesh: one CreateMeshSection per region
+	void UploadCorridorMesh(TArray<FCorridorMeshSectionData>&& Sections);
+	// Hands every spawned room back to the RoomPool
+	void ReleaseSpawnedRooms();
+	ARoom* SpawnRequestedRoom(const FRoomSpawnRequest& Request);
+	UFUNCTION()
+	void FinishSpawning();
+
+	// Spawned actor of every layout room, null for the rooms that stay data. GenerateDungeonAsync only.
+	UPROPERTY()
+	TArray<ARoom*> RoomActors;
+	// Part every layout room plays in the dungeon, parallel to RoomActors
+	TArray<ERoomSpawnKind> RoomKinds;
+
+	// Instanced render mode: every room of the layout in one batch per material
+	void WriteRoomInstances();
+	void ClearRoomInstances();
+	void SetSeparationStats(const DungeonLayout::FSeparationResult& Result);
+	// LastGenerationStats, the stat DungeonGen counters and a log line
+	void SetGenerationStats(const DungeonLayout::FLayoutStats& Stats);
+	// Stages of the staged pipeline so far, they run over several frames and components
+	DungeonLayout::FLayoutStats StagedStats;
+	static FString GetLayoutFilePath(const FString& Path);
+
+	// A random seed never hits the cache, it would only fill Saved/DungeonLayouts with layouts never read back
+	bool ShouldUseLayoutCache() const { return bUseLayoutCache && !bRandomSeed; }
+	// Bumped by every layout task so only the latest layout gets spawned
+	uint32 LayoutRequestId = 0;
+	// Runs the layout on a worker, corrects it with Delta there, then applies it on the game thread
+	void StartLayoutTask(const DungeonLayout::FLayoutParams& Params, const DungeonLayout::FLayoutDelta& Delta);
+
+	// ReplicateLayout mode
+	bool IsNetLayoutClient() const;
+	// Server: fills NetLayout for the current layout
+	void PublishNetLayout(const DungeonLayout::FLayoutDelta& Delta, const FString& SourceFile);
+	// Server, staged pipeline: the delta against what the parameters generate is only known once they ran
+	void PublishStagedNetLayout();
+	// Client: rebuilds the dungeon NetLayout describes
+	void RebuildNetLayout();
+	void VerifyNetLayout() const;
+
+	UPROPERTY(ReplicatedUsing=OnRep_NetLayout)
+	FDungeonNetLayout NetLayout;
+
+	UFUNCTION()
+	void OnRep_NetLayout();
 	
+
 public:	
+	// Throws the current dungeon away and builds a new one with the path BeginPlay uses
+	UFUNCTION(BlueprintCallable, Category="Generation")
+	void Regenerate();
+
+	// Runs the whole layout on a worker thread, then spawns the rooms. Replaces the previous dungeon.
+	UFUNCTION(BlueprintCallable, Category="Generation")
+	void GenerateDungeonAsync();
+
+	// Writes the current layout as a layout file (see Layout/LayoutFile.h). Relative paths start at the project directory.
+	UFUNCTION(BlueprintCallable, Category="Generation")
+	bool SaveLayoutFile(const FString& Path, bool bCompress = true) const;
+
+	// Maps a layout file and spawns its rooms like a generated layout, no stage runs. Replaces the current dungeon.
+	UFUNCTION(BlueprintCallable, Category="Generation")
+	bool LoadLayoutFile(const FString& Path);
+
+	// ARoom actor of a layout room, spawned if it has none yet. The way to get actors in Instanced mode,
+	// where the actor only adds gameplay and the instance keeps drawing the room.
+	UFUNCTION(BlueprintCallable, Category="Generation")
+	ARoom* SpawnRoomActor(int32 RoomIndex);
+
+	// Fired once the rooms of a dungeon are spawned, by either generation path
+	UPROPERTY(BlueprintAssignable, Category="Generation")
+	FOnDungeonGenerated OnDungeonGenerated;
+
+	// BeginPlay generates with GenerateDungeonAsync. Off runs the staged game thread pipeline, which can
+	// show every step (see SeparationMode and the graph generator's PipelineMode).
+	UPROPERTY(EditAnywhere, Category="Generation")
+	bool bGenerateInBackground;
+
+	// GenerateDungeonAsync spawns the rooms over several frames, nearest to the players first, within the
+	// SpawnScheduler budget. Off spawns them all in the frame the layout arrives.
+	UPROPERTY(EditAnywhere, Category="Generation")
+	bool bTimeSlicedSpawning;
+
+	// Instanced applies to GenerateDungeonAsync, the staged pipeline always spawns actors
+	UPROPERTY(EditAnywhere, Category="Generation")
+	ERoomRenderMode RoomRenderMode;
+
+	// Instanced mode also draws the rooms left out of the dungeon, with UnselectedRoomMaterial
+	UPROPERTY(EditAnywhere, Category="Generation")
+	bool bDrawUnselectedRooms;
+
+	// The same seed and settings give the same layout, on any machine and thread count. Holds the seed of the
+	// last dungeon when bRandomSeed is set.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation", meta=(EditCondition="!bRandomSeed"))
+	int32 Seed;
+
+	// Draws a new Seed for every dungeon
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Generation")
+	bool bRandomSeed;
+
+	// Worker time of the last GenerateDungeonAsync layout
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Generation")
+	float LastLayoutMilliseconds;
+
+	// GenerateDungeonAsync reuses the layout of an earlier dungeon with the same seed and settings, from
+	// memory or Saved/DungeonLayouts. Only used with a fixed Seed.
+	UPROPERTY(EditAnywhere, Category="Generation", meta=(EditCondition="!bRandomSeed"))
+	bool bUseLayoutCache;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Generation")
+	FDungeonLayoutCacheStats LayoutCacheStats;
+
+	// Set before OnDungeonGenerated
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Generation")
+	FDungeonGenerationStats LastGenerationStats;
+
+	// ReplicateLayout keeps the initial bunch small for big dungeons: clients get the parameters and a checksum
+	// instead of one actor per room
+	UPROPERTY(EditAnywhere, Category="Network")
+	EDungeonNetMode NetMode;
+
+	// Pre-generated or authored layout BeginPlay loads instead of generating, relative to the project directory.
+	// Generates as usual when empty or when the file cannot be loaded.
+	UPROPERTY(EditAnywhere, Category="Generation")
+	FString LayoutFile;
+
 	UPROPERTY(EditAnywhere)
 	int RoomsToSpawn;
 
@@ -159,6 +596,9 @@ public:
 	UPROPERTY(EditAnywhere)
 	UMaterialInterface* SelectedCorridorRoomMaterial;
 
+	UPROPERTY(EditAnywhere)
+	UMaterialInterface* UnselectedRoomMaterial;
+
 	UPROPERTY(EditAnywhere)
 	TSubclassOf<ARoom> BP_Room;
 	
@@ -168,6 +608,10 @@ public:
 	UPROPERTY(EditAnywhere)
 	float RoomSizeMax;
 
+	// World size of BP_Room's mesh at scale 1
+	UPROPERTY(EditAnywhere)
+	float RoomUnitSize;
+
 	UPROPERTY(EditAnywhere)
 	float GenerationRadius;
 
@@ -176,4 +620,52 @@ public:
 
 	UPROPERTY(EditAnywhere)
 	FVector GenerationCenter;
+
+	UPROPERTY(EditAnywhere, Category="Separation")
+	ERoomSeparationMode SeparationMode;
+
+	// Time sliced mode only
+	UPROPERTY(EditAnywhere, Category="Separation", meta=(ClampMin="0.1"))
+	float SeparationBudgetMs;
+
+	UPROPERTY(EditAnywhere, Category="Separation", meta=(ClampMin="1"))
+	int32 MaxSeparationIterations;
+
+	// Jacobi solver on worker threads instead of the serial pair by pair solver.
+	// Takes more passes but each pass is spread over every core; layouts stay identical for any thread count.
+	UPROPERTY(EditAnywhere, Category="Separation")
+	bool bParallelSeparation;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Separation")
+	FRoomSeparationStats SeparationStats;
+
+	// Both give a tree of the same length, they only differ in speed and in how equal lengths are broken
+	UPROPERTY(EditAnywhere, Category="Graph")
+	ESpanningTreeAlgorithm SpanningTreeAlgorithm;
+
+	UPROPERTY(EditAnywhere, Category="Corridors")
+	ECorridorRoutingMode CorridorRouting;
+
+	// Cell size of grid routing, and width of the corridor meshes
+	UPROPERTY(EditAnywhere, Category="Corridors", meta=(ClampMin="1"))
+	float CorridorCellSize;
+
+	// Floors, walls and doorways built on workers into CorridorMesh, instead of debug lines only
+	UPROPERTY(EditAnywhere, Category="Corridors")
+	bool bBuildCorridorMeshes;
+
+	UPROPERTY(EditAnywhere, Category="Corridors", meta=(ClampMin="0", EditCondition="bBuildCorridorMeshes"))
+	float CorridorWallHeight;
+
+	// Doorways are open up to this height
+	UPROPERTY(EditAnywhere, Category="Corridors", meta=(ClampMin="0", EditCondition="bBuildCorridorMeshes"))
+	float CorridorDoorHeight;
+
+	UPROPERTY(EditAnywhere, Category="Corridors", meta=(EditCondition="bBuildCorridorMeshes"))
+	UMaterialInterface* CorridorMaterial;
+
+	// Triangulation, spanning tree, corridors and the animated separation as debug lines.
+	// Only in builds with debug drawing, never in shipping or on a dedicated server.
+	UPROPERTY(EditAnywhere, Category="Debug")
+	bool bDrawDebugLines;
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DungeonLayoutAsync.h"
+
+#include "Async/Async.h"
+#include "DungeonGenStats.h"
+#include "Misc/Paths.h"
+
+DungeonLayout::FLayoutCache& GetDungeonLayoutCache()
+{
+	static DungeonLayout::FLayoutCache Cache(32, TCHAR_TO_UTF8(*FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("DungeonLayouts"))));
+	return Cache;
+}
+
+TFuture<FAsyncDungeonLayout> GenerateDungeonLayoutAsync(const DungeonLayout::FLayoutParams& Params, bool bUseCache)
+{
+	return Async(EAsyncExecution::ThreadPool, [Params, bUseCache]()
+	{
+		FAsyncDungeonLayout Result;
+		const double StartSeconds = FPlatformTime::Seconds();
+		DungeonLayout::FCachedLayout Cached;
+		if (bUseCache && GetDungeonLayoutCache().Find(Params, Cached))
+		{
+			Result.Layout = MoveTemp(Cached.Layout);
+			Result.Separation = Cached.Separation;
+			Result.bFromCache = true;
+		}
+		else
+		{
+			Cached.Layout = DungeonLayout::GenerateDungeonLayout(Params, &Cached.Separation, &Result.Stats);
+			if (bUseCache)
+			{
+				GetDungeonLayoutCache().Add(Params, Cached);
+			}
+			Result.Layout = MoveTemp(Cached.Layout);
+			Result.Separation = Cached.Separation;
+		}
+		Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+		return Result;
+	});
+}
+
+void BuildCorridorMeshSections(const DungeonLayout::FDungeonLayout& Layout, const DungeonLayout::FCorridorMeshParams& Params, double Z, TArray<FCorridorMeshSectionData>& OutSections)
+{
+	DUNGEONGEN_SCOPE(STAT_DungeonGen_CorridorMesh);
+	std::vector<DungeonLayout::FCorridorMeshSection> Sections;
+	DungeonLayout::BuildCorridorMesh(Layout, Params, Sections);
+
+	// Same coordinates in Unreal's left-handed frame, where the core's winding is the front face
+	OutSections.Reset(static_cast<int32>(Sections.size()));
+	for (const DungeonLayout::FCorridorMeshSection& Section : Sections)
+	{
+		FCorridorMeshSectionData& Data = OutSections.AddDefaulted_GetRef();
+		const int32 NumVertices = static_cast<int32>(Section.Vertices.size());
+		Data.Vertices.Reserve(NumVertices);
+		Data.Normals.Reserve(NumVertices);
+		Data.UVs.Reserve(NumVertices);
+		for (const DungeonLayout::FCorridorMeshVertex& Vertex : Section.Vertices)
+		{
+			Data.Vertices.Add(FVector(Vertex.Position.X, Vertex.Position.Y, Z + Vertex.Z));
+			Data.Normals.Add(FVector(Vertex.NormalX, Vertex.NormalY, Vertex.NormalZ));
+			Data.UVs.Add(FVector2D(Vertex.U, Vertex.V));
+		}
+		Data.Triangles.Append(Section.Indices.data(), static_cast<int32>(Section.Indices.size()));
+	}
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Runs the layout core off the game thread
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Layout/DungeonLayout.h"
+#include "Layout/LayoutCache.h"
+#include "Layout/LayoutCorridorMesh.h"
+
+// One procedural mesh section of corridors, in world space
+struct FCorridorMeshSectionData
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UVs;
+};
+
+struct FAsyncDungeonLayout
+{
+	DungeonLayout::FDungeonLayout Layout;
+	DungeonLayout::FSeparationResult Separation;
+	// Stage timings and counters, empty when no stage ran
+	DungeonLayout::FLayoutStats Stats;
+	// Wall time of the whole pipeline on the worker
+	double Seconds = 0.0;
+	// Came from the layout cache, no stage ran
+	bool bFromCache = false;
+	// Came from a layout file, see ADungeonGenerator::LoadLayoutFile
+	bool bFromFile = false;
+	// Built on the worker too when corridor meshes are on
+	TArray<FCorridorMeshSectionData> CorridorMesh;
+};
+
+// Layouts shared by every generator of the process, kept in Saved/DungeonLayouts between runs
+DUNGEONGEN_API DungeonLayout::FLayoutCache& GetDungeonLayoutCache();
+
+// DungeonLayout::BuildCorridorMesh, then one section per region converted for UProceduralMeshComponent with the floor
+// at Z. Runs on the calling thread, meant for a worker.
+DUNGEONGEN_API void BuildCorridorMeshSections(const DungeonLayout::FDungeonLayout& Layout, const DungeonLayout::FCorridorMeshParams& Params, double Z, TArray<FCorridorMeshSectionData>& OutSections);
+
+// Scatter, separation, triangulation, MST and corridors on the thread pool, or a copy of the cached layout for
+// Params when bUseCache is set. Params is copied, the task shares nothing with the caller but the cache.
+// The future is fulfilled on the worker thread.
+DUNGEONGEN_API TFuture<FAsyncDungeonLayout> GenerateDungeonLayoutAsync(const DungeonLayout::FLayoutParams& Params, bool bUseCache = true);
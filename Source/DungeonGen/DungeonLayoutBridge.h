@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Conversions between the engine independent layout core and engine types
+
+#include "CoreMinimal.h"
+#include "Layout/LayoutTypes.h"
+
+namespace DungeonLayout
+{
+	inline FVector ToWorld(const FVec2& Point, double Z)
+	{
+		return FVector(Point.X, Point.Y, Z);
+	}
+
+	inline FVector2D ToVector2D(const FVec2& Point)
+	{
+		return FVector2D(Point.X, Point.Y);
+	}
+
+	inline FVec2 ToLayout(const FVector& Vector)
+	{
+		return FVec2(Vector.X, Vector.Y);
+	}
+}
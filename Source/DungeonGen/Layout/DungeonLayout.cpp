@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DungeonLayout.h"
+
+#include "LayoutCorridorRouter.h"
+#include "LayoutCorridors.h"
+#include "LayoutDelaunay.h"
+#include "LayoutGraph.h"
+#include "LayoutRooms.h"
+#include "LayoutSeparation.h"
+
+#include <utility>
+
+namespace DungeonLayout
+{
+	void GatherSelectedCenters(const FDungeonLayout& Layout, std::vector<FVec2>& OutPoints)
+	{
+		OutPoints.clear();
+		OutPoints.reserve(Layout.SelectedRooms.size());
+		for (int32_t RoomIndex : Layout.SelectedRooms)
+		{
+			OutPoints.push_back(Layout.Rooms[RoomIndex].Center);
+		}
+	}
+
+	void SetMinimumSpanningTree(FDungeonLayout& Layout, const std::vector<FLayoutEdge>& SelectedTree)
+	{
+		Layout.MinimumSpanningTree.clear();
+		Layout.MinimumSpanningTree.reserve(SelectedTree.size());
+		for (const FLayoutEdge& Edge : SelectedTree)
+		{
+			Layout.MinimumSpanningTree.push_back(FLayoutEdge(Layout.SelectedRooms[Edge.A], Layout.SelectedRooms[Edge.B], Edge.Weight));
+		}
+	}
+
+	void ConnectRooms(const std::vector<FVec2>& Points, EMstAlgorithm Algorithm, FRoomConnectivity& OutConnectivity, FLayoutStats* Stats)
+	{
+		{
+			FLayoutStageScope Scope(ELayoutStage::Delaunay, Stats);
+			Triangulate(Points, OutConnectivity.Triangles, Stats);
+		}
+		{
+			FLayoutStageScope Scope(ELayoutStage::RoomGraph, Stats);
+			BuildRoomGraph(Points, OutConnectivity.Triangles, OutConnectivity.Graph);
+		}
+		{
+			FLayoutStageScope Scope(ELayoutStage::SpanningTree, Stats);
+			ComputeMinimumSpanningTree(OutConnectivity.Graph, OutConnectivity.SpanningTree, Algorithm);
+		}
+		if (Stats)
+		{
+			Stats->GraphEdges += static_cast<int32_t>(OutConnectivity.Graph.Edges.size());
+			Stats->SpanningTreeEdges += static_cast<int32_t>(OutConnectivity.SpanningTree.size());
+		}
+	}
+
+	void BuildLayoutCorridors(const FLayoutParams& Params, FDungeonLayout& Layout, FLayoutStats* Stats)
+	{
+		FLayoutStageScope Scope(ELayoutStage::Corridors, Stats);
+		switch (Params.CorridorRouting)
+		{
+		case ECorridorRouting::Grid:
+			RouteCorridors(Layout, Params.CorridorCellSize);
+			break;
+		default:
+			BuildCorridors(Layout);
+			break;
+		}
+		if (Stats)
+		{
+			Stats->CorridorSegments += static_cast<int32_t>(Layout.Corridors.size());
+		}
+	}
+
+	void FinishDungeonLayout(const FLayoutParams& Params, FDungeonLayout& Layout, FLayoutStats* Stats)
+	{
+		Layout.CorridorRooms.clear();
+		Layout.Corridors.clear();
+		std::vector<FVec2> Points;
+		{
+			FLayoutStageScope Scope(ELayoutStage::Selection, Stats);
+			SelectBiggestRooms(Layout.Rooms, Params.NumberOfBigRoomsToSelect, Layout.SelectedRooms);
+			GatherSelectedCenters(Layout, Points);
+		}
+
+		FRoomConnectivity Connectivity;
+		ConnectRooms(Points, Params.MstAlgorithm, Connectivity, Stats);
+		Layout.Triangles = std::move(Connectivity.Triangles);
+		SetMinimumSpanningTree(Layout, Connectivity.SpanningTree);
+
+		BuildLayoutCorridors(Params, Layout, Stats);
+	}
+
+	FDungeonLayout GenerateDungeonLayout(const FLayoutParams& Params, FSeparationResult* OutSeparation, FLayoutStats* OutStats)
+	{
+		FDungeonLayout Layout;
+
+		{
+			FLayoutStageScope Scope(ELayoutStage::Scatter, OutStats);
+			ScatterRooms(Params, Layout.Rooms);
+		}
+		FSeparationResult Separation;
+		{
+			FLayoutStageScope Scope(ELayoutStage::Separation, OutStats);
+			Separation = SeparateRooms(Layout.Rooms, Params.MaxSeparationIterations, Params.SeparationSolver);
+		}
+		if (OutSeparation)
+		{
+			*OutSeparation = Separation;
+		}
+		if (OutStats)
+		{
+			OutStats->SeparationIterations += Separation.Iterations;
+			OutStats->OverlapPairsTested += Separation.PairsTested;
+		}
+		FinishDungeonLayout(Params, Layout, OutStats);
+		return Layout;
+	}
+}
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Engine independent dungeon layout pipeline:
+// scatter -> separation -> selection -> Delaunay -> room graph -> MST -> corridors.
+// ADungeonGenerator drives the same stages and only spawns actors for the final rooms.
+
+#include "LayoutGraph.h"
+#include "LayoutSeparation.h"
+#include "LayoutStats.h"
+#include "LayoutTypes.h"
+
+namespace DungeonLayout
+{
+	// Output of the graph stages over the selected room centers, indices refer to those points
+	struct FRoomConnectivity
+	{
+		std::vector<FLayoutTriangle> Triangles;
+		FLayoutGraph Graph;
+		std::vector<FLayoutEdge> SpanningTree;
+	};
+
+	// Centers of Layout.SelectedRooms, in selection order. These are the points of the graph stages.
+	void GatherSelectedCenters(const FDungeonLayout& Layout, std::vector<FVec2>& OutPoints);
+
+	// Delaunay triangulation, room graph and minimum spanning tree back to back. Touches no shared state,
+	// safe to run on a worker thread. Stats, when given, gets the timings and counters of the three stages.
+	void ConnectRooms(const std::vector<FVec2>& Points, EMstAlgorithm Algorithm, FRoomConnectivity& OutConnectivity, FLayoutStats* Stats = nullptr);
+
+	// Converts a tree over selected point indices to room indices and stores it in Layout.MinimumSpanningTree
+	void SetMinimumSpanningTree(FDungeonLayout& Layout, const std::vector<FLayoutEdge>& SelectedTree);
+
+	// BuildCorridors or RouteCorridors, as Params.CorridorRouting says
+	void BuildLayoutCorridors(const FLayoutParams& Params, FDungeonLayout& Layout, FLayoutStats* Stats = nullptr);
+
+	// Selection, graph stages and corridors over the separated Layout.Rooms. Replaces everything else in Layout.
+	void FinishDungeonLayout(const FLayoutParams& Params, FDungeonLayout& Layout, FLayoutStats* Stats = nullptr);
+
+	// Runs every stage in one go. Only reads Params, safe to call from any thread.
+	FDungeonLayout GenerateDungeonLayout(const FLayoutParams& Params, FSeparationResult* OutSeparation = nullptr, FLayoutStats* OutStats = nullptr);
+}
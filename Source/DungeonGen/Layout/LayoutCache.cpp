@@ -0,0 +1,307 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		constexpr uint32_t LayoutCacheFileMagic = 0x464C4344; // "DCLF"
+		const char* const LayoutCacheFileExtension = ".layout";
+
+		template <typename T>
+		void AppendKeyValue(std::vector<uint8_t>& Bytes, const T& Value)
+		{
+			const size_t Offset = Bytes.size();
+			Bytes.resize(Offset + sizeof(T));
+			std::memcpy(Bytes.data() + Offset, &Value, sizeof(T));
+		}
+
+		// FNV-1a
+		uint64_t HashKeyBytes(const std::vector<uint8_t>& Bytes)
+		{
+			uint64_t Hash = 0xCBF29CE484222325ull;
+			for (uint8_t Byte : Bytes)
+			{
+				Hash = (Hash ^ Byte) * 0x100000001B3ull;
+			}
+			return Hash;
+		}
+	}
+
+	FLayoutCacheKey MakeLayoutCacheKey(const FLayoutParams& Params)
+	{
+		FLayoutCacheKey Key;
+		std::vector<uint8_t>& Bytes = Key.Bytes;
+		AppendKeyValue(Bytes, LayoutAlgorithmVersion);
+		AppendKeyValue(Bytes, Params.RoomsToSpawn);
+		AppendKeyValue(Bytes, Params.NumberOfBigRoomsToSelect);
+		AppendKeyValue(Bytes, Params.RoomSizeMin);
+		AppendKeyValue(Bytes, Params.RoomSizeMax);
+		AppendKeyValue(Bytes, Params.RoomUnitSize);
+		AppendKeyValue(Bytes, Params.GenerationRadius);
+		AppendKeyValue(Bytes, Params.GenerationCenter.X);
+		AppendKeyValue(Bytes, Params.GenerationCenter.Y);
+		AppendKeyValue(Bytes, Params.Seed);
+		AppendKeyValue(Bytes, Params.MaxSeparationIterations);
+		AppendKeyValue(Bytes, static_cast<uint8_t>(Params.SeparationSolver));
+		AppendKeyValue(Bytes, static_cast<uint8_t>(Params.MstAlgorithm));
+		AppendKeyValue(Bytes, static_cast<uint8_t>(Params.CorridorRouting));
+		AppendKeyValue(Bytes, Params.CorridorCellSize);
+		Key.Hash = HashKeyBytes(Bytes);
+		return Key;
+	}
+
+	FLayoutCache::FLayoutCache(size_t InMaxMemoryEntries, const std::string& InDirectory, size_t InMaxDiskEntries)
+		: MaxMemoryEntries(InMaxMemoryEntries)
+		, MaxDiskEntries(InMaxDiskEntries)
+		, Directory(InDirectory)
+	{
+		if (!Directory.empty())
+		{
+			std::error_code Error;
+			std::filesystem::create_directories(Directory, Error);
+			ScanDirectory();
+		}
+	}
+
+	bool FLayoutCache::Find(const FLayoutParams& Params, FCachedLayout& OutCached)
+	{
+		const FLayoutCacheKey Key = MakeLayoutCacheKey(Params);
+		bool bOnDisk = false;
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			const auto Found = MemoryIndex.find(Key.Hash);
+			if (Found != MemoryIndex.end() && Found->second->Key == Key)
+			{
+				MemoryEntries.splice(MemoryEntries.begin(), MemoryEntries, Found->second);
+				OutCached = Found->second->Cached;
+				++Stats.MemoryHits;
+				return true;
+			}
+			bOnDisk = DiskIndex.count(Key.Hash) > 0;
+		}
+
+		if (bOnDisk && ReadFile(Key, OutCached))
+		{
+			std::vector<uint64_t> Evicted;
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				++Stats.DiskHits;
+				AddToMemory(Key, OutCached);
+				Evicted = TouchFile(Key.Hash);
+			}
+			std::error_code Error;
+			std::filesystem::last_write_time(GetFilePath(Key.Hash), std::filesystem::file_time_type::clock::now(), Error);
+			for (uint64_t Hash : Evicted)
+			{
+				std::filesystem::remove(GetFilePath(Hash), Error);
+			}
+			return true;
+		}
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		++Stats.Misses;
+		return false;
+	}
+
+	void FLayoutCache::Add(const FLayoutParams& Params, const FCachedLayout& Cached)
+	{
+		const FLayoutCacheKey Key = MakeLayoutCacheKey(Params);
+		std::vector<uint64_t> Evicted;
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			AddToMemory(Key, Cached);
+			if (!Directory.empty())
+			{
+				Evicted = TouchFile(Key.Hash);
+			}
+		}
+
+		if (!Directory.empty())
+		{
+			WriteFile(Key, Cached);
+			std::error_code Error;
+			for (uint64_t Hash : Evicted)
+			{
+				std::filesystem::remove(GetFilePath(Hash), Error);
+			}
+		}
+	}
+
+	void FLayoutCache::ClearMemory()
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		MemoryEntries.clear();
+		MemoryIndex.clear();
+	}
+
+	FLayoutCacheStats FLayoutCache::GetStats() const
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		FLayoutCacheStats Result = Stats;
+		Result.MemoryEntries = MemoryEntries.size();
+		Result.DiskEntries = DiskEntries.size();
+		return Result;
+	}
+
+	std::string FLayoutCache::GetFilePath(uint64_t Hash) const
+	{
+		char FileName[32];
+		std::snprintf(FileName, sizeof(FileName), "%016llx", static_cast<unsigned long long>(Hash));
+		return (std::filesystem::path(Directory) / (std::string(FileName) + LayoutCacheFileExtension)).string();
+	}
+
+	bool FLayoutCache::ReadFile(const FLayoutCacheKey& Key, FCachedLayout& OutCached) const
+	{
+		std::ifstream File(GetFilePath(Key.Hash), std::ios::binary);
+		if (!File)
+		{
+			return false;
+		}
+		const std::vector<uint8_t> Bytes((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+
+		// Magic, key size, key, layout
+		const size_t HeaderSize = sizeof(uint32_t) + sizeof(uint64_t);
+		if (Bytes.size() < HeaderSize)
+		{
+			return false;
+		}
+		uint32_t Magic = 0;
+		uint64_t KeySize = 0;
+		std::memcpy(&Magic, Bytes.data(), sizeof(Magic));
+		std::memcpy(&KeySize, Bytes.data() + sizeof(Magic), sizeof(KeySize));
+		if (Magic != LayoutCacheFileMagic || KeySize != Key.Bytes.size() || Bytes.size() - HeaderSize < KeySize
+			|| !std::equal(Key.Bytes.begin(), Key.Bytes.end(), Bytes.begin() + HeaderSize))
+		{
+			return false;
+		}
+
+		const size_t LayoutOffset = HeaderSize + static_cast<size_t>(KeySize);
+		return ReadLayout(Bytes.data() + LayoutOffset, Bytes.size() - LayoutOffset, OutCached);
+	}
+
+	void FLayoutCache::WriteFile(const FLayoutCacheKey& Key, const FCachedLayout& Cached) const
+	{
+		std::vector<uint8_t> Bytes;
+		AppendKeyValue(Bytes, LayoutCacheFileMagic);
+		AppendKeyValue(Bytes, static_cast<uint64_t>(Key.Bytes.size()));
+		Bytes.insert(Bytes.end(), Key.Bytes.begin(), Key.Bytes.end());
+		WriteLayout(Cached, Bytes);
+
+		// Written aside then renamed, a reader never sees half a file
+		static std::atomic<uint32_t> TempCounter(0);
+		const std::string Path = GetFilePath(Key.Hash);
+		const std::string TempPath = Path + "." + std::to_string(TempCounter++) + ".tmp";
+		{
+			std::ofstream File(TempPath, std::ios::binary | std::ios::trunc);
+			File.write(reinterpret_cast<const char*>(Bytes.data()), static_cast<std::streamsize>(Bytes.size()));
+			if (!File)
+			{
+				File.close();
+				std::error_code Error;
+				std::filesystem::remove(TempPath, Error);
+				return;
+			}
+		}
+		std::error_code Error;
+		std::filesystem::rename(TempPath, Path, Error);
+		if (Error)
+		{
+			std::filesystem::remove(TempPath, Error);
+		}
+	}
+
+	void FLayoutCache::ScanDirectory()
+	{
+		std::vector<std::pair<std::filesystem::file_time_type, uint64_t>> Files;
+		std::error_code Error;
+		for (std::filesystem::directory_iterator It(Directory, Error), End; !Error && It != End; It.increment(Error))
+		{
+			const std::filesystem::path& Path = It->path();
+			if (Path.extension() != LayoutCacheFileExtension)
+			{
+				continue;
+			}
+			const std::string Stem = Path.stem().string();
+			char* ParseEnd = nullptr;
+			const uint64_t Hash = std::strtoull(Stem.c_str(), &ParseEnd, 16);
+			if (Stem.size() != 16 || *ParseEnd != '\0')
+			{
+				continue;
+			}
+			std::error_code TimeError;
+			Files.emplace_back(std::filesystem::last_write_time(Path, TimeError), Hash);
+		}
+
+		// Oldest first, each one is pushed to the front
+		std::sort(Files.begin(), Files.end());
+		for (const auto& File : Files)
+		{
+			for (uint64_t Hash : TouchFile(File.second))
+			{
+				std::filesystem::remove(GetFilePath(Hash), Error);
+			}
+		}
+	}
+
+	void FLayoutCache::AddToMemory(const FLayoutCacheKey& Key, const FCachedLayout& Cached)
+	{
+		if (MaxMemoryEntries == 0)
+		{
+			return;
+		}
+
+		const auto Found = MemoryIndex.find(Key.Hash);
+		if (Found != MemoryIndex.end())
+		{
+			Found->second->Key = Key;
+			Found->second->Cached = Cached;
+			MemoryEntries.splice(MemoryEntries.begin(), MemoryEntries, Found->second);
+			return;
+		}
+
+		MemoryEntries.push_front(FMemoryEntry{ Key, Cached });
+		MemoryIndex[Key.Hash] = MemoryEntries.begin();
+		while (MemoryEntries.size() > MaxMemoryEntries)
+		{
+			MemoryIndex.erase(MemoryEntries.back().Key.Hash);
+			MemoryEntries.pop_back();
+			++Stats.Evictions;
+		}
+	}
+
+	std::vector<uint64_t> FLayoutCache::TouchFile(uint64_t Hash)
+	{
+		const auto Found = DiskIndex.find(Hash);
+		if (Found != DiskIndex.end())
+		{
+			DiskEntries.splice(DiskEntries.begin(), DiskEntries, Found->second);
+			return {};
+		}
+
+		DiskEntries.push_front(Hash);
+		DiskIndex[Hash] = DiskEntries.begin();
+
+		std::vector<uint64_t> Evicted;
+		while (DiskEntries.size() > MaxDiskEntries)
+		{
+			Evicted.push_back(DiskEntries.back());
+			DiskIndex.erase(DiskEntries.back());
+			DiskEntries.pop_back();
+			++Stats.Evictions;
+		}
+		return Evicted;
+	}
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Finished layouts by generation parameters. A layout is a pure function of FLayoutParams, so a hit can
+// skip every stage of GenerateDungeonLayout.
+
+#include "LayoutSerialization.h"
+#include "LayoutTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace DungeonLayout
+{
+	// Bump whenever a stage changes its output for the same parameters, it invalidates every cached layout
+	constexpr uint32_t LayoutAlgorithmVersion = 1;
+
+	// Every parameter that shapes the layout plus LayoutAlgorithmVersion. Bytes is compared on lookup so a
+	// hash collision cannot return the wrong dungeon.
+	struct FLayoutCacheKey
+	{
+		uint64_t Hash = 0;
+		std::vector<uint8_t> Bytes;
+
+		bool operator==(const FLayoutCacheKey& Other) const { return Hash == Other.Hash && Bytes == Other.Bytes; }
+	};
+
+	FLayoutCacheKey MakeLayoutCacheKey(const FLayoutParams& Params);
+
+	struct FLayoutCacheStats
+	{
+		uint64_t MemoryHits = 0;
+		uint64_t DiskHits = 0;
+		uint64_t Misses = 0;
+		// Layouts dropped from memory and files deleted from disk
+		uint64_t Evictions = 0;
+		size_t MemoryEntries = 0;
+		size_t DiskEntries = 0;
+	};
+
+	// LRU cache in memory, backed by an LRU directory of layout files when Directory is set. Thread safe, files
+	// are read and written outside the lock.
+	class FLayoutCache
+	{
+	public:
+		explicit FLayoutCache(size_t InMaxMemoryEntries = 32, const std::string& InDirectory = std::string(), size_t InMaxDiskEntries = 1024);
+
+		// Copies the cached layout for Params into OutCached, memory first then disk
+		bool Find(const FLayoutParams& Params, FCachedLayout& OutCached);
+
+		void Add(const FLayoutParams& Params, const FCachedLayout& Cached);
+
+		// Drops the memory entries, files stay
+		void ClearMemory();
+
+		FLayoutCacheStats GetStats() const;
+
+	private:
+		struct FMemoryEntry
+		{
+			FLayoutCacheKey Key;
+			FCachedLayout Cached;
+		};
+
+		std::string GetFilePath(uint64_t Hash) const;
+		bool ReadFile(const FLayoutCacheKey& Key, FCachedLayout& OutCached) const;
+		void WriteFile(const FLayoutCacheKey& Key, const FCachedLayout& Cached) const;
+		void ScanDirectory();
+		void AddToMemory(const FLayoutCacheKey& Key, const FCachedLayout& Cached);
+		// Marks Hash as the newest file, returns the files to delete
+		std::vector<uint64_t> TouchFile(uint64_t Hash);
+
+		size_t MaxMemoryEntries;
+		size_t MaxDiskEntries;
+		std::string Directory;
+
+		mutable std::mutex Mutex;
+		// Most recently used first
+		std::list<FMemoryEntry> MemoryEntries;
+		std::unordered_map<uint64_t, std::list<FMemoryEntry>::iterator> MemoryIndex;
+		std::list<uint64_t> DiskEntries;
+		std::unordered_map<uint64_t, std::list<uint64_t>::iterator> DiskIndex;
+		FLayoutCacheStats Stats;
+	};
+}
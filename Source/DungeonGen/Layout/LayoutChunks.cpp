@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutChunks.h"
+
+#include "LayoutCorridors.h"
+#include "LayoutRandom.h"
+#include "LayoutRooms.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		FChunkCoord GetChunkCoordFromKey(uint64_t Key)
+		{
+			return FChunkCoord(static_cast<int32_t>(static_cast<uint32_t>(Key >> 32)), static_cast<int32_t>(static_cast<uint32_t>(Key)));
+		}
+
+		bool IsRoomInside(const FLayoutRoom& Room, const FVec2& Min, const FVec2& Max)
+		{
+			return Room.Min().X >= Min.X && Room.Min().Y >= Min.Y && Room.Max().X <= Max.X && Room.Max().Y <= Max.Y;
+		}
+	}
+
+	FChunkCoord GetChunkCoord(const FChunkParams& Params, const FVec2& Point)
+	{
+		return FChunkCoord(static_cast<int32_t>(std::floor(Point.X / Params.ChunkSize)), static_cast<int32_t>(std::floor(Point.Y / Params.ChunkSize)));
+	}
+
+	FVec2 GetChunkCenter(const FChunkParams& Params, const FChunkCoord& Coord)
+	{
+		return FVec2((Coord.X + 0.5) * Params.ChunkSize, (Coord.Y + 0.5) * Params.ChunkSize);
+	}
+
+	uint64_t GetChunkSeed(uint64_t WorldSeed, const FChunkCoord& Coord)
+	{
+		return FLayoutRandom(WorldSeed).Split(ELayoutStream::Chunk).Split(GetChunkKey(Coord)).NextUInt64();
+	}
+
+	void GenerateChunk(const FChunkParams& Params, const FChunkCoord& Coord, FDungeonChunk& OutChunk)
+	{
+		const FVec2 Center = GetChunkCenter(Params, Coord);
+		const double HalfSize = Params.ChunkSize * 0.5;
+
+		FLayoutParams ChunkParams = Params.Layout;
+		ChunkParams.GenerationCenter = Center;
+		ChunkParams.GenerationRadius = std::min(ChunkParams.GenerationRadius, static_cast<float>(HalfSize));
+		ChunkParams.Seed = GetChunkSeed(Params.Layout.Seed, Coord);
+
+		OutChunk.Coord = Coord;
+		OutChunk.Layout = FDungeonLayout();
+		OutChunk.Stats = FLayoutStats();
+		FDungeonLayout& Layout = OutChunk.Layout;
+		{
+			FLayoutStageScope Scope(ELayoutStage::Scatter, &OutChunk.Stats);
+			ScatterRooms(ChunkParams, Layout.Rooms);
+		}
+		{
+			FLayoutStageScope Scope(ELayoutStage::Separation, &OutChunk.Stats);
+			OutChunk.Separation = SeparateRooms(Layout.Rooms, ChunkParams.MaxSeparationIterations, ChunkParams.SeparationSolver);
+		}
+		OutChunk.Stats.SeparationIterations = OutChunk.Separation.Iterations;
+		OutChunk.Stats.OverlapPairsTested = OutChunk.Separation.PairsTested;
+
+		// Rooms pushed over the border would overlap the neighbour's, keep the others in scatter order
+		const FVec2 Min = Center - FVec2(HalfSize, HalfSize);
+		const FVec2 Max = Center + FVec2(HalfSize, HalfSize);
+		int32_t NumKept = 0;
+		for (const FLayoutRoom& Room : Layout.Rooms)
+		{
+			if (IsRoomInside(Room, Min, Max))
+			{
+				FLayoutRoom& Kept = Layout.Rooms[NumKept];
+				Kept = Room;
+				Kept.Id = NumKept++;
+			}
+		}
+		Layout.Rooms.resize(NumKept);
+
+		FinishDungeonLayout(ChunkParams, Layout, &OutChunk.Stats);
+	}
+
+	bool BuildChunkStitch(const FDungeonChunk& A, const FDungeonChunk& B, FChunkStitch& OutStitch)
+	{
+		const bool bSwap = B.Coord < A.Coord;
+		const FDungeonChunk& First = bSwap ? B : A;
+		const FDungeonChunk& Second = bSwap ? A : B;
+
+		// A few dozen selected rooms per chunk, every pair is cheap enough
+		double BestDistSquared = DBL_MAX;
+		int32_t BestFirst = -1;
+		int32_t BestSecond = -1;
+		for (int32_t FirstRoom : First.Layout.SelectedRooms)
+		{
+			for (int32_t SecondRoom : Second.Layout.SelectedRooms)
+			{
+				const double DistSquared = FVec2::DistSquared(First.Layout.Rooms[FirstRoom].Center, Second.Layout.Rooms[SecondRoom].Center);
+				if (DistSquared < BestDistSquared)
+				{
+					BestDistSquared = DistSquared;
+					BestFirst = FirstRoom;
+					BestSecond = SecondRoom;
+				}
+			}
+		}
+		if (BestFirst < 0)
+		{
+			return false;
+		}
+
+		// The corridor of a two room layout
+		FDungeonLayout Bridge;
+		Bridge.Rooms.push_back(First.Layout.Rooms[BestFirst]);
+		Bridge.Rooms.push_back(Second.Layout.Rooms[BestSecond]);
+		Bridge.Rooms[0].Id = 0;
+		Bridge.Rooms[1].Id = 1;
+		Bridge.SelectedRooms = { 0, 1 };
+		Bridge.MinimumSpanningTree.push_back(FLayoutEdge(0, 1, static_cast<float>(std::sqrt(BestDistSquared))));
+		BuildCorridors(Bridge);
+
+		OutStitch.A = First.Coord;
+		OutStitch.B = Second.Coord;
+		OutStitch.RoomA = BestFirst;
+		OutStitch.RoomB = BestSecond;
+		OutStitch.Corridors = std::move(Bridge.Corridors);
+		return true;
+	}
+
+	FChunkStreamer::FChunkStreamer(const FChunkParams& InParams)
+		: Params(InParams)
+	{
+	}
+
+	double FChunkStreamer::GetViewerDistanceSquared(const FChunkCoord& Coord, const std::vector<FVec2>& Viewers) const
+	{
+		const FVec2 Center = GetChunkCenter(Params, Coord);
+		double Nearest = DBL_MAX;
+		for (const FVec2& Viewer : Viewers)
+		{
+			Nearest = std::min(Nearest, FVec2::DistSquared(Center, Viewer));
+		}
+		return Nearest;
+	}
+
+	void FChunkStreamer::Update(const std::vector<FVec2>& Viewers, std::vector<FChunkCoord>& OutRequested, std::vector<FChunkCoord>& OutEvicted)
+	{
+		OutRequested.clear();
+		OutEvicted.clear();
+		const double LoadRadiusSquared = Params.LoadRadius * Params.LoadRadius;
+		const double UnloadRadiusSquared = std::max(Params.UnloadRadius, Params.LoadRadius) * std::max(Params.UnloadRadius, Params.LoadRadius);
+
+		// Out of reach of every viewer. The others are candidates for eviction when the cap is hit, farthest last.
+		std::vector<std::pair<double, FChunkCoord>> Evictable;
+		for (auto It = Chunks.begin(); It != Chunks.end();)
+		{
+			const FChunkCoord Coord = GetChunkCoordFromKey(It->first);
+			const double DistSquared = GetViewerDistanceSquared(Coord, Viewers);
+			if (DistSquared > UnloadRadiusSquared)
+			{
+				OutEvicted.push_back(Coord);
+				It = Chunks.erase(It);
+				continue;
+			}
+			if (DistSquared > LoadRadiusSquared)
+			{
+				Evictable.push_back(std::make_pair(DistSquared, Coord));
+			}
+			++It;
+		}
+		std::sort(Evictable.begin(), Evictable.end(), [](const std::pair<double, FChunkCoord>& Lhs, const std::pair<double, FChunkCoord>& Rhs)
+		{
+			return Lhs.first != Rhs.first ? Lhs.first < Rhs.first : Lhs.second < Rhs.second;
+		});
+
+		// Every missing chunk within LoadRadius of a viewer, nearest first
+		std::vector<std::pair<double, FChunkCoord>> Wanted;
+		for (const FVec2& Viewer : Viewers)
+		{
+			const FChunkCoord Min = GetChunkCoord(Params, Viewer - FVec2(Params.LoadRadius, Params.LoadRadius));
+			const FChunkCoord Max = GetChunkCoord(Params, Viewer + FVec2(Params.LoadRadius, Params.LoadRadius));
+			for (int32_t Y = Min.Y; Y <= Max.Y; ++Y)
+			{
+				for (int32_t X = Min.X; X <= Max.X; ++X)
+				{
+					const FChunkCoord Coord(X, Y);
+					if (FVec2::DistSquared(GetChunkCenter(Params, Coord), Viewer) <= LoadRadiusSquared && !IsTracked(Coord))
+					{
+						Wanted.push_back(std::make_pair(GetViewerDistanceSquared(Coord, Viewers), Coord));
+					}
+				}
+			}
+		}
+		std::sort(Wanted.begin(), Wanted.end(), [](const std::pair<double, FChunkCoord>& Lhs, const std::pair<double, FChunkCoord>& Rhs)
+		{
+			return Lhs.first != Rhs.first ? Lhs.first < Rhs.first : Lhs.second < Rhs.second;
+		});
+		Wanted.erase(std::unique(Wanted.begin(), Wanted.end(), [](const std::pair<double, FChunkCoord>& Lhs, const std::pair<double, FChunkCoord>& Rhs)
+		{
+			return Lhs.second == Rhs.second;
+		}), Wanted.end());
+
+		for (const std::pair<double, FChunkCoord>& Entry : Wanted)
+		{
+			if (static_cast<int32_t>(Chunks.size()) >= Params.MaxChunks)
+			{
+				// Only a chunk beyond LoadRadius and farther than this one makes room
+				if (Evictable.empty() || Evictable.back().first <= Entry.first)
+				{
+					break;
+				}
+				OutEvicted.push_back(Evictable.back().second);
+				Chunks.erase(GetChunkKey(Evictable.back().second));
+				Evictable.pop_back();
+			}
+			Chunks.emplace(GetChunkKey(Entry.second), nullptr);
+			OutRequested.push_back(Entry.second);
+		}
+	}
+
+	bool FChunkStreamer::AddChunk(FDungeonChunk&& Chunk, std::vector<FChunkStitch>& OutStitches)
+	{
+		OutStitches.clear();
+		auto It = Chunks.find(GetChunkKey(Chunk.Coord));
+		if (It == Chunks.end() || It->second)
+		{
+			// Evicted since it was requested, or a duplicate
+			return false;
+		}
+		It->second.reset(new FDungeonChunk(std::move(Chunk)));
+		const FDungeonChunk& Added = *It->second;
+
+		const FChunkCoord Neighbors[4] = {
+			FChunkCoord(Added.Coord.X - 1, Added.Coord.Y),
+			FChunkCoord(Added.Coord.X + 1, Added.Coord.Y),
+			FChunkCoord(Added.Coord.X, Added.Coord.Y - 1),
+			FChunkCoord(Added.Coord.X, Added.Coord.Y + 1)
+		};
+		for (const FChunkCoord& Neighbor : Neighbors)
+		{
+			FChunkStitch Stitch;
+			const FDungeonChunk* Other = FindChunk(Neighbor);
+			if (Other && BuildChunkStitch(Added, *Other, Stitch))
+			{
+				OutStitches.push_back(std::move(Stitch));
+			}
+		}
+		return true;
+	}
+
+	const FDungeonChunk* FChunkStreamer::FindChunk(const FChunkCoord& Coord) const
+	{
+		const auto It = Chunks.find(GetChunkKey(Coord));
+		return It != Chunks.end() ? It->second.get() : nullptr;
+	}
+
+	bool FChunkStreamer::IsTracked(const FChunkCoord& Coord) const
+	{
+		return Chunks.find(GetChunkKey(Coord)) != Chunks.end();
+	}
+
+	int32_t FChunkStreamer::NumGeneratedChunks() const
+	{
+		int32_t NumGenerated = 0;
+		for (const auto& Entry : Chunks)
+		{
+			NumGenerated += Entry.second ? 1 : 0;
+		}
+		return NumGenerated;
+	}
+}
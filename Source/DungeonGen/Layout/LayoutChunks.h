@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Unbounded dungeons as a grid of square chunks. A chunk is a whole dungeon of its own, generated from the world
+// seed and its coordinates only: scatter, separation, selection, graph stages and corridors. Neighbouring chunks
+// are joined by a stitch corridor between their closest selected rooms. FChunkStreamer decides which chunks to
+// generate and which to drop around moving viewers, so memory stays bounded however far they travel.
+
+#include "DungeonLayout.h"
+#include "LayoutSeparation.h"
+#include "LayoutStats.h"
+#include "LayoutTypes.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace DungeonLayout
+{
+	struct FChunkCoord
+	{
+		int32_t X = 0;
+		int32_t Y = 0;
+
+		FChunkCoord() {}
+		FChunkCoord(int32_t InX, int32_t InY) : X(InX), Y(InY) {}
+
+		bool operator==(const FChunkCoord& Other) const { return X == Other.X && Y == Other.Y; }
+		bool operator!=(const FChunkCoord& Other) const { return !(*this == Other); }
+		bool operator<(const FChunkCoord& Other) const { return Y != Other.Y ? Y < Other.Y : X < Other.X; }
+	};
+
+	inline uint64_t GetChunkKey(const FChunkCoord& Coord)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(Coord.X)) << 32) | static_cast<uint32_t>(Coord.Y);
+	}
+
+	struct FChunkParams
+	{
+		// Pipeline of every chunk. Seed is the world seed, GenerationCenter is set per chunk and GenerationRadius is
+		// clamped to the chunk.
+		FLayoutParams Layout;
+		// Side of a chunk in world units
+		double ChunkSize = 20000.0;
+		// Chunks whose center is within LoadRadius of a viewer are generated...
+		double LoadRadius = 30000.0;
+		// ...and dropped once no viewer is within UnloadRadius. Above LoadRadius, so a viewer going back and forth
+		// over a chunk border does not make chunks come and go.
+		double UnloadRadius = 45000.0;
+		// Most chunks kept, generated or being generated. The chunks farthest from the viewers make room first.
+		int32_t MaxChunks = 64;
+	};
+
+	struct FDungeonChunk
+	{
+		FChunkCoord Coord;
+		// In world units, like a dungeon generated in one go
+		FDungeonLayout Layout;
+		FSeparationResult Separation;
+		FLayoutStats Stats;
+	};
+
+	// Corridor between two neighbouring chunks, A before B in FChunkCoord order
+	struct FChunkStitch
+	{
+		FChunkCoord A;
+		FChunkCoord B;
+		// Joined rooms, indices into the Layout.Rooms of chunk A and chunk B
+		int32_t RoomA = -1;
+		int32_t RoomB = -1;
+		// Straight or L-shaped like BuildCorridors, EdgeIndex is 0
+		std::vector<FCorridorSegment> Corridors;
+	};
+
+	FChunkCoord GetChunkCoord(const FChunkParams& Params, const FVec2& Point);
+	FVec2 GetChunkCenter(const FChunkParams& Params, const FChunkCoord& Coord);
+
+	// Seed of the chunk's own pipeline, from the world seed and the coordinates only
+	uint64_t GetChunkSeed(uint64_t WorldSeed, const FChunkCoord& Coord);
+
+	// The whole pipeline for one chunk. Rooms are scattered in the disc inscribed in the chunk at most, and the
+	// rooms the separation pushes out of the chunk are dropped before the selection, so chunks never overlap and
+	// a chunk does not depend on its neighbours. Only reads Params, safe to call from any thread.
+	void GenerateChunk(const FChunkParams& Params, const FChunkCoord& Coord, FDungeonChunk& OutChunk);
+
+	// Joins the closest pair of selected rooms of two neighbouring chunks. Returns false when either chunk has no
+	// selected room. Rooms crossed by the stitch are not added to either chunk's CorridorRooms.
+	bool BuildChunkStitch(const FDungeonChunk& A, const FDungeonChunk& B, FChunkStitch& OutStitch);
+
+	// Chunk bookkeeping around a set of viewers. Does not generate anything: Update says which chunks to generate
+	// and which to drop, the host generates them on its workers and hands them back with AddChunk.
+	class FChunkStreamer
+	{
+	public:
+		explicit FChunkStreamer(const FChunkParams& InParams);
+
+		const FChunkParams& GetParams() const { return Params; }
+
+		// Moves the window to Viewers. OutRequested gets the chunks to generate, nearest to a viewer first, never
+		// more than MaxChunks are tracked. OutEvicted gets the chunks dropped, generated or not, their stitches go
+		// with them.
+		void Update(const std::vector<FVec2>& Viewers, std::vector<FChunkCoord>& OutRequested, std::vector<FChunkCoord>& OutEvicted);
+
+		// Takes a requested chunk once generated. Returns false and drops it when it was evicted meanwhile.
+		// OutStitches gets the stitches to the neighbours already generated.
+		bool AddChunk(FDungeonChunk&& Chunk, std::vector<FChunkStitch>& OutStitches);
+
+		// Null while the chunk is not generated
+		const FDungeonChunk* FindChunk(const FChunkCoord& Coord) const;
+		bool IsTracked(const FChunkCoord& Coord) const;
+
+		int32_t NumTrackedChunks() const { return static_cast<int32_t>(Chunks.size()); }
+		int32_t NumGeneratedChunks() const;
+
+	private:
+		double GetViewerDistanceSquared(const FChunkCoord& Coord, const std::vector<FVec2>& Viewers) const;
+
+		FChunkParams Params;
+		// Null for the chunks requested and not generated yet
+		std::unordered_map<uint64_t, std::unique_ptr<FDungeonChunk>> Chunks;
+	};
+}
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutCompression.h"
+
+#include <cstring>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		constexpr size_t MinMatch = 4;
+		constexpr size_t MaxOffset = 65535;
+		constexpr uint32_t HashBits = 14;
+
+		uint32_t Read32(const uint8_t* Data)
+		{
+			uint32_t Value;
+			std::memcpy(&Value, Data, sizeof(Value));
+			return Value;
+		}
+
+		uint32_t HashSequence(uint32_t Value)
+		{
+			return (Value * 2654435761u) >> (32 - HashBits);
+		}
+
+		// Lengths past the 15 of the token nibble go in extra bytes, 255 meaning "more follows"
+		void WriteExtraLength(size_t Length, std::vector<uint8_t>& OutBytes)
+		{
+			for (; Length >= 255; Length -= 255)
+			{
+				OutBytes.push_back(255);
+			}
+			OutBytes.push_back(static_cast<uint8_t>(Length));
+		}
+
+		bool ReadExtraLength(const uint8_t* Data, size_t Size, size_t& InOutOffset, size_t Limit, size_t& InOutLength)
+		{
+			uint8_t Byte = 255;
+			while (Byte == 255)
+			{
+				if (InOutOffset == Size || InOutLength > Limit)
+				{
+					return false;
+				}
+				Byte = Data[InOutOffset++];
+				InOutLength += Byte;
+			}
+			return true;
+		}
+
+		// Token, literals, then the match unless MatchLength is 0 (the last sequence)
+		void WriteSequence(const uint8_t* Literals, size_t NumLiterals, size_t Offset, size_t MatchLength, std::vector<uint8_t>& OutBytes)
+		{
+			const size_t MatchCode = MatchLength > 0 ? MatchLength - MinMatch : 0;
+			OutBytes.push_back(static_cast<uint8_t>((NumLiterals < 15 ? NumLiterals : 15) << 4 | (MatchCode < 15 ? MatchCode : 15)));
+			if (NumLiterals >= 15)
+			{
+				WriteExtraLength(NumLiterals - 15, OutBytes);
+			}
+			OutBytes.insert(OutBytes.end(), Literals, Literals + NumLiterals);
+
+			if (MatchLength == 0)
+			{
+				return;
+			}
+			OutBytes.push_back(static_cast<uint8_t>(Offset & 0xFF));
+			OutBytes.push_back(static_cast<uint8_t>(Offset >> 8));
+			if (MatchCode >= 15)
+			{
+				WriteExtraLength(MatchCode - 15, OutBytes);
+			}
+		}
+	}
+
+	void CompressBytes(const uint8_t* Data, size_t Size, std::vector<uint8_t>& OutBytes)
+	{
+		// Last position seen for each hashed 4 byte sequence, plus one so 0 means none
+		std::vector<uint32_t> Table(size_t(1) << HashBits, 0);
+
+		size_t Anchor = 0;
+		size_t Position = 0;
+		while (Position + MinMatch <= Size)
+		{
+			const uint32_t Sequence = Read32(Data + Position);
+			uint32_t& Slot = Table[HashSequence(Sequence)];
+			const size_t Candidate = Slot;
+			Slot = static_cast<uint32_t>(Position + 1);
+
+			if (Candidate == 0 || Position - (Candidate - 1) > MaxOffset || Read32(Data + Candidate - 1) != Sequence)
+			{
+				++Position;
+				continue;
+			}
+
+			const size_t Match = Candidate - 1;
+			size_t MatchLength = MinMatch;
+			while (Position + MatchLength < Size && Data[Match + MatchLength] == Data[Position + MatchLength])
+			{
+				++MatchLength;
+			}
+			WriteSequence(Data + Anchor, Position - Anchor, Position - Match, MatchLength, OutBytes);
+			Position += MatchLength;
+			Anchor = Position;
+		}
+		WriteSequence(Data + Anchor, Size - Anchor, 0, 0, OutBytes);
+	}
+
+	bool DecompressBytes(const uint8_t* Data, size_t Size, uint8_t* Out, size_t OutSize)
+	{
+		size_t In = 0;
+		size_t Written = 0;
+		while (In < Size)
+		{
+			const uint8_t Token = Data[In++];
+			size_t NumLiterals = Token >> 4;
+			if (NumLiterals == 15 && !ReadExtraLength(Data, Size, In, OutSize, NumLiterals))
+			{
+				return false;
+			}
+			if (NumLiterals > Size - In || NumLiterals > OutSize - Written)
+			{
+				return false;
+			}
+			if (NumLiterals > 0)
+			{
+				std::memcpy(Out + Written, Data + In, NumLiterals);
+			}
+			In += NumLiterals;
+			Written += NumLiterals;
+
+			if (In == Size)
+			{
+				break;
+			}
+
+			if (Size - In < 2)
+			{
+				return false;
+			}
+			const size_t Offset = Data[In] | static_cast<size_t>(Data[In + 1]) << 8;
+			In += 2;
+			size_t MatchLength = Token & 0xF;
+			if (MatchLength == 15 && !ReadExtraLength(Data, Size, In, OutSize, MatchLength))
+			{
+				return false;
+			}
+			MatchLength += MinMatch;
+			if (Offset == 0 || Offset > Written || MatchLength > OutSize - Written)
+			{
+				return false;
+			}
+
+			// Byte by byte, a match may overlap the bytes it produces
+			const uint8_t* Source = Out + Written - Offset;
+			for (size_t i = 0; i < MatchLength; ++i)
+			{
+				Out[Written + i] = Source[i];
+			}
+			Written += MatchLength;
+		}
+		return Written == OutSize;
+	}
+}
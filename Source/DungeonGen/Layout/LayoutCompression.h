@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Small LZ77 byte codec (LZ4 block layout) for layout files. The core has no third party dependency and
+// the engine's FCompression is not reachable from here.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DungeonLayout
+{
+	// Appends the compressed form of [Data, Data + Size) to OutBytes
+	void CompressBytes(const uint8_t* Data, size_t Size, std::vector<uint8_t>& OutBytes);
+
+	// Decompresses exactly OutSize bytes into Out. False on corrupt input or a size mismatch.
+	bool DecompressBytes(const uint8_t* Data, size_t Size, uint8_t* Out, size_t OutSize);
+}
@@ -0,0 +1,257 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutCorridorMesh.h"
+
+#include "LayoutCorridorRouter.h"
+#include "LayoutParallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		// Sides of a cell: +X, -X, +Y, -Y
+		constexpr int32_t SideX[4] = { 1, -1, 0, 0 };
+		constexpr int32_t SideY[4] = { 0, 0, 1, -1 };
+
+		enum class ECellSide : uint8_t
+		{
+			Open,
+			Wall,
+			Doorway
+		};
+
+		// Walked from A to B the inside of the corridor is on the right, which is where the face points
+		struct FSideEdge
+		{
+			FVec2 A;
+			FVec2 B;
+		};
+
+		FSideEdge GetSideEdge(int32_t Side, const FVec2& Min, const FVec2& Max)
+		{
+			switch (Side)
+			{
+			case 0:
+				return { FVec2(Max.X, Max.Y), FVec2(Max.X, Min.Y) };
+			case 1:
+				return { FVec2(Min.X, Min.Y), FVec2(Min.X, Max.Y) };
+			case 2:
+				return { FVec2(Min.X, Max.Y), FVec2(Max.X, Max.Y) };
+			default:
+				return { FVec2(Max.X, Min.Y), FVec2(Min.X, Min.Y) };
+			}
+		}
+
+		ECellSide ClassifySide(const FOccupancyGrid& Grid, int32_t X, int32_t Y, int32_t Side)
+		{
+			const int32_t NextX = X + SideX[Side];
+			const int32_t NextY = Y + SideY[Side];
+			if (NextX < 0 || NextX >= Grid.GetWidth() || NextY < 0 || NextY >= Grid.GetHeight())
+			{
+				return ECellSide::Wall;
+			}
+			const int32_t Next = Grid.GetCell(NextX, NextY);
+			if (!Grid.IsCorridor(Next))
+			{
+				// Running along a room is not entering it
+				return ECellSide::Wall;
+			}
+			return Grid.IsRoom(Next) ? ECellSide::Doorway : ECellSide::Open;
+		}
+
+		// Fills 4 vertices and 6 indices at the given offsets
+		void WriteQuad(FCorridorMeshSection& Section, int32_t VertexOffset, int32_t IndexOffset, const FCorridorMeshVertex (&Corners)[4])
+		{
+			std::copy(Corners, Corners + 4, Section.Vertices.begin() + VertexOffset);
+			const int32_t QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+			for (int32_t i = 0; i < 6; ++i)
+			{
+				Section.Indices[IndexOffset + i] = VertexOffset + QuadIndices[i];
+			}
+		}
+
+		FCorridorMeshVertex MakeVertex(const FVec2& Position, float Z, float NormalX, float NormalY, float NormalZ, float U, float V)
+		{
+			FCorridorMeshVertex Vertex;
+			Vertex.Position = Position;
+			Vertex.Z = Z;
+			Vertex.NormalX = NormalX;
+			Vertex.NormalY = NormalY;
+			Vertex.NormalZ = NormalZ;
+			Vertex.U = U;
+			Vertex.V = V;
+			return Vertex;
+		}
+
+		void BuildRegion(const FOccupancyGrid& Grid, const FCorridorMeshParams& Params, const int32_t* Cells, int32_t NumRegionCells, FCorridorMeshSection& Section)
+		{
+			const bool bLintel = Params.DoorHeight < Params.WallHeight;
+			auto CountQuads = [&Grid, bLintel](int32_t X, int32_t Y)
+			{
+				int32_t NumQuads = 1;
+				for (int32_t Side = 0; Side < 4; ++Side)
+				{
+					const ECellSide Kind = ClassifySide(Grid, X, Y, Side);
+					NumQuads += Kind == ECellSide::Wall || (Kind == ECellSide::Doorway && bLintel) ? 1 : 0;
+				}
+				return NumQuads;
+			};
+
+			int32_t NumQuads = 0;
+			for (int32_t i = 0; i < NumRegionCells; ++i)
+			{
+				NumQuads += CountQuads(Grid.GetCellX(Cells[i]), Grid.GetCellY(Cells[i]));
+			}
+			Section.Vertices.resize(static_cast<size_t>(NumQuads) * 4);
+			Section.Indices.resize(static_cast<size_t>(NumQuads) * 6);
+
+			const double CellSize = Grid.GetCellSize();
+			const float InvCellSize = static_cast<float>(1.0 / CellSize);
+			int32_t Quad = 0;
+			for (int32_t i = 0; i < NumRegionCells; ++i)
+			{
+				const int32_t X = Grid.GetCellX(Cells[i]);
+				const int32_t Y = Grid.GetCellY(Cells[i]);
+				const FVec2 HalfCell(CellSize * 0.5, CellSize * 0.5);
+				const FVec2 Min = Grid.GetCellCenter(Cells[i]) - HalfCell;
+				const FVec2 Max = Grid.GetCellCenter(Cells[i]) + HalfCell;
+
+				const FCorridorMeshVertex Floor[4] = {
+					MakeVertex(FVec2(Min.X, Min.Y), 0.f, 0.f, 0.f, 1.f, static_cast<float>(X), static_cast<float>(Y)),
+					MakeVertex(FVec2(Max.X, Min.Y), 0.f, 0.f, 0.f, 1.f, static_cast<float>(X + 1), static_cast<float>(Y)),
+					MakeVertex(FVec2(Max.X, Max.Y), 0.f, 0.f, 0.f, 1.f, static_cast<float>(X + 1), static_cast<float>(Y + 1)),
+					MakeVertex(FVec2(Min.X, Max.Y), 0.f, 0.f, 0.f, 1.f, static_cast<float>(X), static_cast<float>(Y + 1))
+				};
+				WriteQuad(Section, Quad * 4, Quad * 6, Floor);
+				++Quad;
+
+				for (int32_t Side = 0; Side < 4; ++Side)
+				{
+					const ECellSide Kind = ClassifySide(Grid, X, Y, Side);
+					if (Kind == ECellSide::Open || (Kind == ECellSide::Doorway && !bLintel))
+					{
+						continue;
+					}
+
+					const float Bottom = Kind == ECellSide::Wall ? 0.f : Params.DoorHeight;
+					const float Top = Params.WallHeight;
+					const FSideEdge Edge = GetSideEdge(Side, Min, Max);
+					const float NormalX = static_cast<float>(-SideX[Side]);
+					const float NormalY = static_cast<float>(-SideY[Side]);
+					// Along the wall in cell sizes, continuous between neighbouring cells
+					const float U0 = static_cast<float>(SideX[Side] != 0 ? Y : X);
+					const float U1 = U0 + 1.f;
+					const FCorridorMeshVertex Wall[4] = {
+						MakeVertex(Edge.A, Bottom, NormalX, NormalY, 0.f, U0, Bottom * InvCellSize),
+						MakeVertex(Edge.B, Bottom, NormalX, NormalY, 0.f, U1, Bottom * InvCellSize),
+						MakeVertex(Edge.B, Top, NormalX, NormalY, 0.f, U1, Top * InvCellSize),
+						MakeVertex(Edge.A, Top, NormalX, NormalY, 0.f, U0, Top * InvCellSize)
+					};
+					WriteQuad(Section, Quad * 4, Quad * 6, Wall);
+					++Quad;
+				}
+			}
+		}
+	}
+
+	void BuildCorridorMesh(const FDungeonLayout& Layout, const FCorridorMeshParams& Params, std::vector<FCorridorMeshSection>& OutSections)
+	{
+		OutSections.clear();
+		if (Layout.Corridors.empty())
+		{
+			return;
+		}
+
+		FOccupancyGrid Grid;
+		Grid.Build(Layout.Rooms, Params.CellSize);
+		const double SampleStep = Grid.GetCellSize() * 0.5;
+
+		// Half a cell between samples, no cell of an axis aligned segment is skipped. The arena holds every sample.
+		const int32_t NumSegments = static_cast<int32_t>(Layout.Corridors.size());
+		std::vector<int32_t> SampleStarts(NumSegments + 1, 0);
+		for (int32_t i = 0; i < NumSegments; ++i)
+		{
+			const FCorridorSegment& Segment = Layout.Corridors[i];
+			const int32_t NumSteps = static_cast<int32_t>(std::ceil(FVec2::Dist(Segment.Start, Segment.End) / SampleStep));
+			SampleStarts[i + 1] = SampleStarts[i] + NumSteps + 1;
+		}
+		std::vector<int32_t> SampleCells(SampleStarts.back());
+		ParallelForRange(NumSegments, 64, [&Layout, &Grid, &SampleStarts, &SampleCells](int32_t Begin, int32_t End)
+		{
+			for (int32_t i = Begin; i < End; ++i)
+			{
+				const FCorridorSegment& Segment = Layout.Corridors[i];
+				const int32_t NumSamples = SampleStarts[i + 1] - SampleStarts[i];
+				const int32_t NumSteps = NumSamples - 1;
+				for (int32_t Step = 0; Step < NumSamples; ++Step)
+				{
+					const double Alpha = NumSteps > 0 ? static_cast<double>(Step) / NumSteps : 0.0;
+					SampleCells[SampleStarts[i] + Step] = Grid.FindCell(Segment.Start + (Segment.End - Segment.Start) * Alpha);
+				}
+			}
+		});
+
+		// Marking is cheap next to the geometry and keeps the bitset writes on one thread
+		std::vector<int32_t> FloorCells;
+		for (int32_t Cell : SampleCells)
+		{
+			if (!Grid.IsCorridor(Cell))
+			{
+				Grid.MarkCorridor(Cell);
+				if (!Grid.IsRoom(Cell))
+				{
+					FloorCells.push_back(Cell);
+				}
+			}
+		}
+
+		// Counting sort of the floor cells by region, in rasterization order within a region
+		const int32_t RegionCells = std::max(Params.RegionCells, 1);
+		const int32_t NumRegionsX = (Grid.GetWidth() + RegionCells - 1) / RegionCells;
+		const int32_t NumRegionsY = (Grid.GetHeight() + RegionCells - 1) / RegionCells;
+		auto GetRegion = [&Grid, RegionCells, NumRegionsX](int32_t Cell)
+		{
+			return (Grid.GetCellY(Cell) / RegionCells) * NumRegionsX + Grid.GetCellX(Cell) / RegionCells;
+		};
+		std::vector<int32_t> RegionStarts(static_cast<size_t>(NumRegionsX) * NumRegionsY + 1, 0);
+		for (int32_t Cell : FloorCells)
+		{
+			++RegionStarts[GetRegion(Cell) + 1];
+		}
+		for (size_t i = 1; i < RegionStarts.size(); ++i)
+		{
+			RegionStarts[i] += RegionStarts[i - 1];
+		}
+		std::vector<int32_t> RegionCellList(FloorCells.size());
+		std::vector<int32_t> Cursor(RegionStarts.begin(), RegionStarts.end() - 1);
+		for (int32_t Cell : FloorCells)
+		{
+			RegionCellList[Cursor[GetRegion(Cell)]++] = Cell;
+		}
+
+		std::vector<int32_t> Regions;
+		for (int32_t Region = 0; Region + 1 < static_cast<int32_t>(RegionStarts.size()); ++Region)
+		{
+			if (RegionStarts[Region + 1] > RegionStarts[Region])
+			{
+				Regions.push_back(Region);
+			}
+		}
+
+		OutSections.resize(Regions.size());
+		ParallelForRange(static_cast<int32_t>(Regions.size()), 1, [&](int32_t Begin, int32_t End)
+		{
+			for (int32_t i = Begin; i < End; ++i)
+			{
+				const int32_t Region = Regions[i];
+				FCorridorMeshSection& Section = OutSections[i];
+				Section.RegionX = Region % NumRegionsX;
+				Section.RegionY = Region / NumRegionsX;
+				BuildRegion(Grid, Params, RegionCellList.data() + RegionStarts[Region], RegionStarts[Region + 1] - RegionStarts[Region], Section);
+			}
+		});
+	}
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Corridor geometry: the corridor segments are rasterized into an occupancy grid, then every corridor cell outside
+// the rooms gets a floor, a wall on each side facing nothing walkable and a doorway lintel on each side where the
+// corridor enters a room. The mesh is split in square regions, one section each, built on worker threads.
+
+#include "LayoutTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace DungeonLayout
+{
+	struct FCorridorMeshParams
+	{
+		// Corridor width, also the cell size of the rasterization. Matches grid routing with the same cell size.
+		double CellSize = 100.0;
+		float WallHeight = 300.f;
+		// Doorways are open up to here, a lintel closes the wall above. No lintel when it reaches WallHeight.
+		float DoorHeight = 220.f;
+		// Side of a region in cells
+		int32_t RegionCells = 32;
+	};
+
+	// Positions are in layout units, Z from the floor. Front faces wind counter-clockwise seen from the side the
+	// normal points to, in a right-handed X, Y, Z frame; UVs are in cell sizes.
+	struct FCorridorMeshVertex
+	{
+		FVec2 Position;
+		float Z = 0.f;
+		float NormalX = 0.f;
+		float NormalY = 0.f;
+		float NormalZ = 0.f;
+		float U = 0.f;
+		float V = 0.f;
+	};
+
+	// Geometry of one region, quads as two triangles
+	struct FCorridorMeshSection
+	{
+		int32_t RegionX = 0;
+		int32_t RegionY = 0;
+		std::vector<FCorridorMeshVertex> Vertices;
+		std::vector<int32_t> Indices;
+	};
+
+	// One section per region holding corridor cells, in region order. Segments are rasterized in parallel into a
+	// preallocated cell arena, and every region counts its quads first so its buffers are allocated once.
+	// The result does not depend on the thread count.
+	void BuildCorridorMesh(const FDungeonLayout& Layout, const FCorridorMeshParams& Params, std::vector<FCorridorMeshSection>& OutSections);
+}
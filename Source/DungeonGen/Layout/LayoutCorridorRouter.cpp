@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutCorridorRouter.h"
+
+#include "LayoutCorridors.h"
+#include "LayoutParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		// Step costs by what the entered cell holds. The heuristic uses the cheapest one to stay admissible.
+		constexpr uint32_t CorridorStepCost = 3;
+		constexpr uint32_t RoomStepCost = 4;
+		constexpr uint32_t EmptyStepCost = 5;
+		constexpr uint32_t TurnCost = 3;
+
+		// Edges routed against the same corridor snapshot. Fixed so the result does not depend on the thread count.
+		constexpr int32_t CorridorRouteBatchSize = 64;
+
+		// Headings: +X, -X, +Y, -Y. Heading ^ 1 is the opposite one.
+		constexpr int32_t HeadingX[4] = { 1, -1, 0, 0 };
+		constexpr int32_t HeadingY[4] = { 0, 0, 1, -1 };
+	}
+
+	void FOccupancyGrid::Build(const std::vector<FLayoutRoom>& Rooms, double InCellSize, int32_t Margin)
+	{
+		CellSize = InCellSize > 0.0 ? InCellSize : 1.0;
+		Margin = std::max(Margin, 0);
+
+		FVec2 Min;
+		FVec2 Max;
+		if (!Rooms.empty())
+		{
+			Min = Rooms[0].Min();
+			Max = Rooms[0].Max();
+			for (const FLayoutRoom& Room : Rooms)
+			{
+				Min = FVec2(std::min(Min.X, Room.Min().X), std::min(Min.Y, Room.Min().Y));
+				Max = FVec2(std::max(Max.X, Room.Max().X), std::max(Max.Y, Room.Max().Y));
+			}
+		}
+
+		Origin = Min - FVec2(Margin * CellSize, Margin * CellSize);
+		Width = static_cast<int32_t>(std::ceil((Max.X - Min.X) / CellSize)) + 2 * Margin + 1;
+		Height = static_cast<int32_t>(std::ceil((Max.Y - Min.Y) / CellSize)) + 2 * Margin + 1;
+
+		const size_t NumWords = (static_cast<size_t>(NumCells()) + 63) / 64;
+		RoomBits.assign(NumWords, 0);
+		CorridorBits.assign(NumWords, 0);
+
+		for (const FLayoutRoom& Room : Rooms)
+		{
+			// Cells whose center lies inside the room
+			const FVec2 RoomMin = Room.Min() - Origin;
+			const FVec2 RoomMax = Room.Max() - Origin;
+			const int32_t MinX = std::max(static_cast<int32_t>(std::ceil(RoomMin.X / CellSize - 0.5)), 0);
+			const int32_t MinY = std::max(static_cast<int32_t>(std::ceil(RoomMin.Y / CellSize - 0.5)), 0);
+			const int32_t MaxX = std::min(static_cast<int32_t>(std::floor(RoomMax.X / CellSize - 0.5)), Width - 1);
+			const int32_t MaxY = std::min(static_cast<int32_t>(std::floor(RoomMax.Y / CellSize - 0.5)), Height - 1);
+			for (int32_t Y = MinY; Y <= MaxY; ++Y)
+			{
+				for (int32_t X = MinX; X <= MaxX; ++X)
+				{
+					const int32_t Cell = GetCell(X, Y);
+					RoomBits[Cell >> 6] |= uint64_t(1) << (Cell & 63);
+				}
+			}
+		}
+	}
+
+	int32_t FOccupancyGrid::FindCell(const FVec2& Point) const
+	{
+		const int32_t X = static_cast<int32_t>(std::floor((Point.X - Origin.X) / CellSize));
+		const int32_t Y = static_cast<int32_t>(std::floor((Point.Y - Origin.Y) / CellSize));
+		return GetCell(std::min(std::max(X, 0), Width - 1), std::min(std::max(Y, 0), Height - 1));
+	}
+
+	FVec2 FOccupancyGrid::GetCellCenter(int32_t Cell) const
+	{
+		return Origin + FVec2((GetCellX(Cell) + 0.5) * CellSize, (GetCellY(Cell) + 0.5) * CellSize);
+	}
+
+	bool FCorridorPathfinder::FindPath(const FOccupancyGrid& Grid, int32_t StartCell, int32_t GoalCell, std::vector<int32_t>& OutCells, int32_t Margin)
+	{
+		OutCells.clear();
+
+		const int32_t StartX = Grid.GetCellX(StartCell);
+		const int32_t StartY = Grid.GetCellY(StartCell);
+		const int32_t GoalX = Grid.GetCellX(GoalCell);
+		const int32_t GoalY = Grid.GetCellY(GoalCell);
+		const int32_t MinX = std::max(std::min(StartX, GoalX) - Margin, 0);
+		const int32_t MinY = std::max(std::min(StartY, GoalY) - Margin, 0);
+		const int32_t MaxX = std::min(std::max(StartX, GoalX) + Margin, Grid.GetWidth() - 1);
+		const int32_t MaxY = std::min(std::max(StartY, GoalY) + Margin, Grid.GetHeight() - 1);
+		const int32_t WindowWidth = MaxX - MinX + 1;
+		const size_t NumStates = static_cast<size_t>(WindowWidth) * (MaxY - MinY + 1) * 4;
+
+		Costs.assign(NumStates, std::numeric_limits<uint32_t>::max());
+		Parents.resize(NumStates);
+		Open.clear();
+
+		auto GetState = [MinX, MinY, WindowWidth](int32_t X, int32_t Y, int32_t Heading)
+		{
+			return ((Y - MinY) * WindowWidth + (X - MinX)) * 4 + Heading;
+		};
+		auto Heuristic = [GoalX, GoalY](int32_t X, int32_t Y)
+		{
+			return static_cast<uint32_t>(std::abs(X - GoalX) + std::abs(Y - GoalY)) * CorridorStepCost;
+		};
+
+		// Any heading is free at the start
+		for (int32_t Heading = 0; Heading < 4; ++Heading)
+		{
+			const int32_t State = GetState(StartX, StartY, Heading);
+			Costs[State] = 0;
+			Parents[State] = -1;
+			Open.emplace_back(Heuristic(StartX, StartY), State);
+		}
+		std::make_heap(Open.begin(), Open.end(), std::greater<std::pair<uint32_t, int32_t>>());
+
+		while (!Open.empty())
+		{
+			std::pop_heap(Open.begin(), Open.end(), std::greater<std::pair<uint32_t, int32_t>>());
+			const std::pair<uint32_t, int32_t> Entry = Open.back();
+			Open.pop_back();
+
+			const int32_t State = Entry.second;
+			const int32_t Heading = State & 3;
+			const int32_t LocalCell = State >> 2;
+			const int32_t X = MinX + LocalCell % WindowWidth;
+			const int32_t Y = MinY + LocalCell / WindowWidth;
+			const uint32_t Cost = Costs[State];
+			if (Entry.first != Cost + Heuristic(X, Y))
+			{
+				// Reached cheaper since it was pushed
+				continue;
+			}
+
+			if (X == GoalX && Y == GoalY)
+			{
+				for (int32_t PathState = State; PathState >= 0; PathState = Parents[PathState])
+				{
+					const int32_t PathCell = PathState >> 2;
+					OutCells.push_back(Grid.GetCell(MinX + PathCell % WindowWidth, MinY + PathCell / WindowWidth));
+				}
+				std::reverse(OutCells.begin(), OutCells.end());
+				return true;
+			}
+
+			for (int32_t NextHeading = 0; NextHeading < 4; ++NextHeading)
+			{
+				if (NextHeading == (Heading ^ 1))
+				{
+					continue;
+				}
+				const int32_t NextX = X + HeadingX[NextHeading];
+				const int32_t NextY = Y + HeadingY[NextHeading];
+				if (NextX < MinX || NextX > MaxX || NextY < MinY || NextY > MaxY)
+				{
+					continue;
+				}
+
+				const int32_t NextCell = Grid.GetCell(NextX, NextY);
+				const uint32_t StepCost = Grid.IsCorridor(NextCell) ? CorridorStepCost : Grid.IsRoom(NextCell) ? RoomStepCost : EmptyStepCost;
+				const uint32_t NextCost = Cost + StepCost + (NextHeading != Heading ? TurnCost : 0);
+				const int32_t NextState = GetState(NextX, NextY, NextHeading);
+				if (NextCost < Costs[NextState])
+				{
+					Costs[NextState] = NextCost;
+					Parents[NextState] = State;
+					Open.emplace_back(NextCost + Heuristic(NextX, NextY), NextState);
+					std::push_heap(Open.begin(), Open.end(), std::greater<std::pair<uint32_t, int32_t>>());
+				}
+			}
+		}
+		return false;
+	}
+
+	void RouteCorridorRuns(const FDungeonLayout& Layout, FOccupancyGrid& Grid, std::vector<FCorridorCellRun>& OutRuns)
+	{
+		const int32_t NumEdges = static_cast<int32_t>(Layout.MinimumSpanningTree.size());
+		std::vector<std::vector<int32_t>> Paths(NumEdges);
+
+		for (int32_t BatchBegin = 0; BatchBegin < NumEdges; BatchBegin += CorridorRouteBatchSize)
+		{
+			const int32_t BatchSize = std::min(CorridorRouteBatchSize, NumEdges - BatchBegin);
+
+			// The grid is only read while the batch runs
+			const FOccupancyGrid& Snapshot = Grid;
+			ParallelForRange(BatchSize, 4, [&Layout, &Snapshot, &Paths, BatchBegin](int32_t Begin, int32_t End)
+			{
+				FCorridorPathfinder Pathfinder;
+				for (int32_t i = Begin; i < End; ++i)
+				{
+					const FLayoutEdge& Edge = Layout.MinimumSpanningTree[BatchBegin + i];
+					const int32_t StartCell = Snapshot.FindCell(Layout.Rooms[Edge.A].Center);
+					const int32_t GoalCell = Snapshot.FindCell(Layout.Rooms[Edge.B].Center);
+					Pathfinder.FindPath(Snapshot, StartCell, GoalCell, Paths[BatchBegin + i]);
+				}
+			});
+
+			for (int32_t EdgeIndex = BatchBegin; EdgeIndex < BatchBegin + BatchSize; ++EdgeIndex)
+			{
+				for (int32_t Cell : Paths[EdgeIndex])
+				{
+					Grid.MarkCorridor(Cell);
+				}
+			}
+		}
+
+		for (int32_t EdgeIndex = 0; EdgeIndex < NumEdges; ++EdgeIndex)
+		{
+			const std::vector<int32_t>& Path = Paths[EdgeIndex];
+			if (Path.empty())
+			{
+				continue;
+			}
+
+			// A run ends where the next step changes direction
+			FCorridorCellRun Run;
+			Run.EdgeIndex = EdgeIndex;
+			Run.StartCell = Path[0];
+			int32_t RunStep = 0;
+			for (size_t i = 1; i < Path.size(); ++i)
+			{
+				const int32_t Step = Path[i] - Path[i - 1];
+				if (RunStep != 0 && Step != RunStep)
+				{
+					Run.EndCell = Path[i - 1];
+					OutRuns.push_back(Run);
+					Run.StartCell = Path[i - 1];
+				}
+				RunStep = Step;
+			}
+			Run.EndCell = Path.back();
+			OutRuns.push_back(Run);
+		}
+	}
+
+	void RouteCorridors(FDungeonLayout& Layout, double CellSize)
+	{
+		FOccupancyGrid Grid;
+		Grid.Build(Layout.Rooms, CellSize);
+		std::vector<FCorridorCellRun> Runs;
+		RouteCorridorRuns(Layout, Grid, Runs);
+
+		FCorridorRoomFinder RoomFinder(Layout);
+		Layout.Corridors.reserve(Layout.Corridors.size() + Runs.size());
+		for (const FCorridorCellRun& Run : Runs)
+		{
+			if (Run.StartCell == Run.EndCell)
+			{
+				// Both rooms in one cell
+				continue;
+			}
+			FCorridorSegment Segment;
+			Segment.Start = Grid.GetCellCenter(Run.StartCell);
+			Segment.End = Grid.GetCellCenter(Run.EndCell);
+			Segment.EdgeIndex = Run.EdgeIndex;
+			Layout.Corridors.push_back(Segment);
+			RoomFinder.Add(Segment.Start, Segment.End);
+		}
+	}
+}
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Grid corridor routing: rooms are rasterized into a bitset occupancy grid and every spanning tree edge is
+// routed with A*. Steps are cheaper through rooms and cheaper still along corridors already routed, and
+// turns cost extra, so corridors merge and stay straight.
+
+#include "LayoutTypes.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace DungeonLayout
+{
+	class FOccupancyGrid
+	{
+	public:
+		// Covers every room plus Margin cells on each side. A cell belongs to a room when its center is inside it.
+		void Build(const std::vector<FLayoutRoom>& Rooms, double InCellSize, int32_t Margin = 4);
+
+		int32_t GetWidth() const { return Width; }
+		int32_t GetHeight() const { return Height; }
+		int32_t NumCells() const { return Width * Height; }
+		double GetCellSize() const { return CellSize; }
+
+		int32_t GetCellX(int32_t Cell) const { return Cell % Width; }
+		int32_t GetCellY(int32_t Cell) const { return Cell / Width; }
+		int32_t GetCell(int32_t X, int32_t Y) const { return Y * Width + X; }
+
+		// Cell containing Point, clamped to the grid
+		int32_t FindCell(const FVec2& Point) const;
+		FVec2 GetCellCenter(int32_t Cell) const;
+
+		bool IsRoom(int32_t Cell) const { return TestBit(RoomBits, Cell); }
+		bool IsCorridor(int32_t Cell) const { return TestBit(CorridorBits, Cell); }
+		void MarkCorridor(int32_t Cell) { CorridorBits[Cell >> 6] |= uint64_t(1) << (Cell & 63); }
+
+	private:
+		static bool TestBit(const std::vector<uint64_t>& Bits, int32_t Cell)
+		{
+			return (Bits[Cell >> 6] >> (Cell & 63)) & 1;
+		}
+
+		double CellSize = 1.0;
+		FVec2 Origin;
+		int32_t Width = 0;
+		int32_t Height = 0;
+		std::vector<uint64_t> RoomBits;
+		std::vector<uint64_t> CorridorBits;
+	};
+
+	// A* over (cell, heading) states so turns can be charged. Keeps its buffers between searches, use one per thread.
+	class FCorridorPathfinder
+	{
+	public:
+		// Cells from StartCell to GoalCell, both included. The search stays within Margin cells of the bounding box of
+		// the two cells; false when GoalCell cannot be reached.
+		bool FindPath(const FOccupancyGrid& Grid, int32_t StartCell, int32_t GoalCell, std::vector<int32_t>& OutCells, int32_t Margin = 8);
+
+	private:
+		// Indexed by state within the search window, which is all a search touches
+		std::vector<uint32_t> Costs;
+		std::vector<int32_t> Parents;
+		// (estimated total cost, state), min heap
+		std::vector<std::pair<uint32_t, int32_t>> Open;
+	};
+
+	// Straight piece of a routed corridor, both end cells included. Consecutive runs of an edge share their corner cell.
+	struct FCorridorCellRun
+	{
+		int32_t EdgeIndex = -1;
+		int32_t StartCell = -1;
+		int32_t EndCell = -1;
+	};
+
+	// Routes every edge of Layout.MinimumSpanningTree between the cells of its room centers, in tree order, and marks the
+	// corridor cells on Grid. Edges are routed in fixed size batches on worker threads; an edge sees the corridors of the
+	// previous batches only, which keeps the result independent of the thread count.
+	void RouteCorridorRuns(const FDungeonLayout& Layout, FOccupancyGrid& Grid, std::vector<FCorridorCellRun>& OutRuns);
+
+	// Grid counterpart of BuildCorridors: one segment per run between cell centers, and every unselected room crossed by
+	// a segment added to Layout.CorridorRooms
+	void RouteCorridors(FDungeonLayout& Layout, double CellSize);
+}
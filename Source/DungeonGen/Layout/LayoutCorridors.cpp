@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutCorridors.h"
+
+#include <algorithm>
+
+namespace DungeonLayout
+{
+	bool SegmentIntersectsRoom(const FVec2& Start, const FVec2& End, const FLayoutRoom& Room)
+	{
+		const FVec2 Min = Room.Min();
+		const FVec2 Max = Room.Max();
+		const double Dir[2] = { End.X - Start.X, End.Y - Start.Y };
+		const double Origin[2] = { Start.X, Start.Y };
+		const double BoxMin[2] = { Min.X, Min.Y };
+		const double BoxMax[2] = { Max.X, Max.Y };
+
+		double TMin = 0.0;
+		double TMax = 1.0;
+		for (int32_t Axis = 0; Axis < 2; ++Axis)
+		{
+			if (Dir[Axis] == 0.0)
+			{
+				// Parallel to the slab: must start inside it
+				if (Origin[Axis] < BoxMin[Axis] || Origin[Axis] > BoxMax[Axis])
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const double InvDir = 1.0 / Dir[Axis];
+			double T0 = (BoxMin[Axis] - Origin[Axis]) * InvDir;
+			double T1 = (BoxMax[Axis] - Origin[Axis]) * InvDir;
+			if (T0 > T1)
+			{
+				std::swap(T0, T1);
+			}
+
+			TMin = std::max(TMin, T0);
+			TMax = std::min(TMax, T1);
+			if (TMin > TMax)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	FCorridorRoomFinder::FCorridorRoomFinder(FDungeonLayout& InLayout)
+		: Layout(InLayout)
+	{
+		Grid.Build(Layout.Rooms);
+		RoomFlags.assign(Layout.Rooms.size(), 0);
+		for (int32_t RoomIndex : Layout.SelectedRooms)
+		{
+			RoomFlags[RoomIndex] |= Selected;
+		}
+		for (int32_t RoomIndex : Layout.CorridorRooms)
+		{
+			RoomFlags[RoomIndex] |= Corridor;
+		}
+	}
+
+	void FCorridorRoomFinder::Add(const FVec2& Start, const FVec2& End)
+	{
+		Hits.clear();
+		const FVec2 Min(std::min(Start.X, End.X), std::min(Start.Y, End.Y));
+		const FVec2 Max(std::max(Start.X, End.X), std::max(Start.Y, End.Y));
+		Grid.ForEachCandidate(Min, Max, [this, &Start, &End](int32_t RoomIndex)
+		{
+			// Flagged on the first hit, so a room spanning several cells is added once
+			if (RoomFlags[RoomIndex] == 0 && SegmentIntersectsRoom(Start, End, Layout.Rooms[RoomIndex]))
+			{
+				RoomFlags[RoomIndex] |= Corridor;
+				Hits.push_back(RoomIndex);
+			}
+		});
+
+		std::sort(Hits.begin(), Hits.end());
+		Layout.CorridorRooms.insert(Layout.CorridorRooms.end(), Hits.begin(), Hits.end());
+	}
+
+	void FindIntersectingRooms(FDungeonLayout& Layout, const FVec2& Start, const FVec2& End)
+	{
+		FCorridorRoomFinder Finder(Layout);
+		Finder.Add(Start, End);
+	}
+
+	void BuildCorridors(FDungeonLayout& Layout)
+	{
+		FCorridorRoomFinder RoomFinder(Layout);
+		auto AddSegment = [&Layout, &RoomFinder](const FVec2& From, const FVec2& To, int32_t EdgeIndex)
+		{
+			FCorridorSegment Segment;
+			Segment.Start = From;
+			Segment.End = To;
+			Segment.EdgeIndex = EdgeIndex;
+			Layout.Corridors.push_back(Segment);
+			RoomFinder.Add(From, To);
+		};
+
+		for (int32_t EdgeIndex = 0; EdgeIndex < static_cast<int32_t>(Layout.MinimumSpanningTree.size()); ++EdgeIndex)
+		{
+			const FLayoutEdge& Edge = Layout.MinimumSpanningTree[EdgeIndex];
+			const FLayoutRoom& RoomA = Layout.Rooms[Edge.A];
+			const FLayoutRoom& RoomB = Layout.Rooms[Edge.B];
+
+			const FVec2 MinA = RoomA.Min();
+			const FVec2 MaxA = RoomA.Max();
+			const FVec2 MinB = RoomB.Min();
+			const FVec2 MaxB = RoomB.Max();
+
+			const bool bOverlapX = (MinA.X <= MaxB.X) && (MaxA.X >= MinB.X);
+			const bool bOverlapY = (MinA.Y <= MaxB.Y) && (MaxA.Y >= MinB.Y);
+
+			if (bOverlapX)
+			{
+				// Vertical corridor: align X in the middle of the shared range
+				const double MidX = (std::max(MinA.X, MinB.X) + std::min(MaxA.X, MaxB.X)) * 0.5;
+				AddSegment(FVec2(MidX, RoomA.Center.Y), FVec2(MidX, RoomB.Center.Y), EdgeIndex);
+			}
+			else if (bOverlapY)
+			{
+				// Horizontal corridor: align Y in the middle of the shared range
+				const double MidY = (std::max(MinA.Y, MinB.Y) + std::min(MaxA.Y, MaxB.Y)) * 0.5;
+				AddSegment(FVec2(RoomA.Center.X, MidY), FVec2(RoomB.Center.X, MidY), EdgeIndex);
+			}
+			else
+			{
+				// L-shaped: first go in X, then in Y
+				const FVec2 Corner(RoomB.Center.X, RoomA.Center.Y);
+				AddSegment(RoomA.Center, Corner, EdgeIndex);
+				AddSegment(Corner, RoomB.Center, EdgeIndex);
+			}
+		}
+	}
+}
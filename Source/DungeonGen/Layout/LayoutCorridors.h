@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LayoutRoomGrid.h"
+#include "LayoutTypes.h"
+
+namespace DungeonLayout
+{
+	// Slab test of the segment [Start, End] against the room rectangle
+	bool SegmentIntersectsRoom(const FVec2& Start, const FVec2& End, const FLayoutRoom& Room);
+
+	// Straight corridor when the rooms overlap on one axis, L-shaped (X first, then Y) otherwise.
+	// Appends the segments of Layout.MinimumSpanningTree to Layout.Corridors and every unselected room
+	// crossed by a segment to Layout.CorridorRooms.
+	void BuildCorridors(FDungeonLayout& Layout);
+
+	// Finds the unselected rooms crossed by corridor segments. Builds a FRoomQueryGrid over Layout.Rooms and one flag per
+	// room for selected and corridor membership, so a segment only tests the rooms of the cells it covers.
+	// Layout.Rooms must not move while the finder is used.
+	class FCorridorRoomFinder
+	{
+	public:
+		explicit FCorridorRoomFinder(FDungeonLayout& InLayout);
+
+		// Appends the rooms crossed by [Start, End] that are neither selected nor corridor rooms yet to
+		// Layout.CorridorRooms, in room order
+		void Add(const FVec2& Start, const FVec2& End);
+
+	private:
+		enum ERoomFlags : uint8_t
+		{
+			Selected = 1 << 0,
+			Corridor = 1 << 1
+		};
+
+		FDungeonLayout& Layout;
+		FRoomQueryGrid Grid;
+		std::vector<uint8_t> RoomFlags;
+		std::vector<int32_t> Hits;
+	};
+
+	// Adds the unselected rooms crossed by [Start, End] to Layout.CorridorRooms. Builds a FCorridorRoomFinder for the
+	// one segment, keep one around for more.
+	void FindIntersectingRooms(FDungeonLayout& Layout, const FVec2& Start, const FVec2& End);
+}
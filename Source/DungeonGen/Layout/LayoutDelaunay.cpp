@@ -0,0 +1,625 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutDelaunay.h"
+
+#include "LayoutPredicates.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		struct FDelaunayEdge
+		{
+			int32_t A;
+			int32_t B;
+
+			bool operator==(const FDelaunayEdge& Other) const
+			{
+				return (A == Other.A && B == Other.B) || (A == Other.B && B == Other.A);
+			}
+		};
+
+		// Position along a Hilbert curve of a point quantized on a 2^16 grid
+		uint64_t HilbertIndex(uint32_t X, uint32_t Y)
+		{
+			uint64_t Index = 0;
+			for (uint32_t Size = 1u << 15; Size > 0; Size >>= 1)
+			{
+				const uint32_t RX = (X & Size) ? 1 : 0;
+				const uint32_t RY = (Y & Size) ? 1 : 0;
+				Index += static_cast<uint64_t>(Size) * Size * ((3 * RX) ^ RY);
+				if (RY == 0)
+				{
+					if (RX == 1)
+					{
+						X = Size - 1 - X;
+						Y = Size - 1 - Y;
+					}
+					std::swap(X, Y);
+				}
+			}
+			return Index;
+		}
+
+		// Triangle mesh stored as structure of arrays. Triangle T is counter clockwise with corners
+		// Vertices[3T..3T+2]; Adjacent[3T+i] is the triangle across the edge opposite corner i, that is the
+		// edge corner i+1 -> corner i+2, or -1 on the outer boundary. The circumcircle of every triangle is
+		// computed once when it is created, so the cavity search only compares squared distances.
+		class FDelaunayMesh
+		{
+		public:
+			// Points followed by the three super triangle vertices
+			std::vector<FVec2> Points;
+
+			std::vector<int32_t> Vertices;
+			std::vector<int32_t> Adjacent;
+			std::vector<double> CircleX;
+			std::vector<double> CircleY;
+			// Negative when the triangle is too thin for the cached circle to be trusted
+			std::vector<double> CircleRadiusSquared;
+			std::vector<uint8_t> Alive;
+
+			void Init(const std::vector<FVec2>& InPoints);
+			bool Insert(int32_t VertexIndex);
+
+			int32_t NumTriangles() const
+			{
+				return static_cast<int32_t>(Alive.size());
+			}
+
+			// Bad triangles replaced by the last successful insertion
+			int32_t GetCavitySize() const
+			{
+				return static_cast<int32_t>(Cavity.size());
+			}
+
+		private:
+			struct FCavityEdge
+			{
+				int32_t A;
+				int32_t B;
+				int32_t Outer;
+			};
+
+			int32_t Locate(const FVec2& Point) const;
+			int32_t AllocateTriangle();
+			void SetTriangle(int32_t Triangle, int32_t A, int32_t B, int32_t C);
+			bool IsInCircumcircle(int32_t Triangle, const FVec2& Point) const;
+
+			std::vector<int32_t> FreeTriangles;
+			int32_t LastTriangle = 0;
+
+			// Scratch reused between insertions
+			std::vector<uint32_t> VisitStamps;
+			std::vector<uint8_t> BadFlags;
+			uint32_t CurrentStamp = 0;
+			std::vector<int32_t> Stack;
+			std::vector<int32_t> Cavity;
+			std::vector<FCavityEdge> CavityBoundary;
+			std::vector<int32_t> NewTriangleFromVertex;
+		};
+
+		void FDelaunayMesh::Init(const std::vector<FVec2>& InPoints)
+		{
+			Points = InPoints;
+			const int32_t NumPoints = static_cast<int32_t>(InPoints.size());
+
+			// Make sure the super triangle is counter clockwise
+			FVec2 SuperVertices[3];
+			ComputeSuperTriangle(InPoints, SuperVertices[0], SuperVertices[1], SuperVertices[2]);
+			if (Orient2D(SuperVertices[0], SuperVertices[1], SuperVertices[2]) < 0)
+			{
+				std::swap(SuperVertices[1], SuperVertices[2]);
+			}
+			Points.push_back(SuperVertices[0]);
+			Points.push_back(SuperVertices[1]);
+			Points.push_back(SuperVertices[2]);
+
+			const size_t ExpectedTriangles = InPoints.size() * 2 + 1;
+			Vertices.clear();
+			Adjacent.clear();
+			CircleX.clear();
+			CircleY.clear();
+			CircleRadiusSquared.clear();
+			Alive.clear();
+			Vertices.reserve(ExpectedTriangles * 3);
+			Adjacent.reserve(ExpectedTriangles * 3);
+			CircleX.reserve(ExpectedTriangles);
+			CircleY.reserve(ExpectedTriangles);
+			CircleRadiusSquared.reserve(ExpectedTriangles);
+			Alive.reserve(ExpectedTriangles);
+			FreeTriangles.clear();
+
+			const int32_t Root = AllocateTriangle();
+			SetTriangle(Root, NumPoints, NumPoints + 1, NumPoints + 2);
+			LastTriangle = Root;
+
+			VisitStamps.clear();
+			BadFlags.clear();
+			CurrentStamp = 0;
+			NewTriangleFromVertex.assign(Points.size(), -1);
+		}
+
+		int32_t FDelaunayMesh::AllocateTriangle()
+		{
+			if (!FreeTriangles.empty())
+			{
+				const int32_t Triangle = FreeTriangles.back();
+				FreeTriangles.pop_back();
+				return Triangle;
+			}
+			Vertices.insert(Vertices.end(), 3, -1);
+			Adjacent.insert(Adjacent.end(), 3, -1);
+			CircleX.push_back(0);
+			CircleY.push_back(0);
+			CircleRadiusSquared.push_back(-1);
+			Alive.push_back(0);
+			return NumTriangles() - 1;
+		}
+
+		void FDelaunayMesh::SetTriangle(int32_t Triangle, int32_t A, int32_t B, int32_t C)
+		{
+			int32_t* Corners = &Vertices[Triangle * 3];
+			Corners[0] = A;
+			Corners[1] = B;
+			Corners[2] = C;
+			Adjacent[Triangle * 3] = Adjacent[Triangle * 3 + 1] = Adjacent[Triangle * 3 + 2] = -1;
+			Alive[Triangle] = 1;
+
+			// Circumcenter relative to A
+			const FVec2& Origin = Points[A];
+			const double BX = Points[B].X - Origin.X, BY = Points[B].Y - Origin.Y;
+			const double CX = Points[C].X - Origin.X, CY = Points[C].Y - Origin.Y;
+			const double BB = BX * BX + BY * BY;
+			const double CC = CX * CX + CY * CY;
+			const double Denom = 2 * (BX * CY - BY * CX);
+
+			// The center error grows as the triangle flattens, don't cache slivers
+			if (std::fabs(Denom) <= 1.e-3 * (BB + CC))
+			{
+				CircleX[Triangle] = Origin.X;
+				CircleY[Triangle] = Origin.Y;
+				CircleRadiusSquared[Triangle] = -1;
+				return;
+			}
+
+			const double UX = (CY * BB - BY * CC) / Denom;
+			const double UY = (BX * CC - CX * BB) / Denom;
+			CircleX[Triangle] = Origin.X + UX;
+			CircleY[Triangle] = Origin.Y + UY;
+			CircleRadiusSquared[Triangle] = UX * UX + UY * UY;
+		}
+
+		bool FDelaunayMesh::IsInCircumcircle(int32_t Triangle, const FVec2& Point) const
+		{
+			const double RadiusSquared = CircleRadiusSquared[Triangle];
+			if (RadiusSquared >= 0)
+			{
+				const double DX = Point.X - CircleX[Triangle];
+				const double DY = Point.Y - CircleY[Triangle];
+				const double DistSquared = DX * DX + DY * DY;
+
+				// Only points close to the circle need the exact predicate. The band covers the error of the
+				// cached center, relative to the radius, and the rounding of the coordinate differences.
+				const double Magnitude = std::max(std::max(std::fabs(Point.X), std::fabs(Point.Y)),
+					std::max(std::fabs(CircleX[Triangle]), std::fabs(CircleY[Triangle])));
+				const double Tolerance = RadiusSquared * 1.e-9 + Magnitude * Magnitude * 1.e-18;
+				if (DistSquared < RadiusSquared - Tolerance)
+				{
+					return true;
+				}
+				if (DistSquared > RadiusSquared + Tolerance)
+				{
+					return false;
+				}
+			}
+
+			const int32_t* Corners = &Vertices[Triangle * 3];
+			return InCircle(Points[Corners[0]], Points[Corners[1]], Points[Corners[2]], Point) > 0;
+		}
+
+		int32_t FDelaunayMesh::Locate(const FVec2& Point) const
+		{
+			// Visibility walk: cross any edge the point is on the far side of. Rotating the first edge tested
+			// each step keeps the walk from cycling.
+			int32_t Triangle = LastTriangle;
+			const int32_t MaxSteps = NumTriangles() * 3 + 16;
+			for (int32_t Step = 0; Step < MaxSteps; ++Step)
+			{
+				const int32_t* Corners = &Vertices[Triangle * 3];
+				int32_t Next = -1;
+				for (int32_t k = 0; k < 3; ++k)
+				{
+					const int32_t Edge = (k + Step) % 3;
+					if (Orient2D(Points[Corners[(Edge + 1) % 3]], Points[Corners[(Edge + 2) % 3]], Point) < 0)
+					{
+						Next = Adjacent[Triangle * 3 + Edge];
+						break;
+					}
+				}
+
+				if (Next < 0)
+				{
+					// Inside (or outside the super triangle, which Init rules out)
+					return Triangle;
+				}
+				Triangle = Next;
+			}
+
+			// Should not happen, fall back to a scan
+			for (int32_t i = 0; i < NumTriangles(); ++i)
+			{
+				const int32_t* Corners = &Vertices[i * 3];
+				if (Alive[i]
+					&& Orient2D(Points[Corners[0]], Points[Corners[1]], Point) >= 0
+					&& Orient2D(Points[Corners[1]], Points[Corners[2]], Point) >= 0
+					&& Orient2D(Points[Corners[2]], Points[Corners[0]], Point) >= 0)
+				{
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		bool FDelaunayMesh::Insert(int32_t VertexIndex)
+		{
+			const FVec2& Point = Points[VertexIndex];
+			const int32_t Start = Locate(Point);
+			if (Start < 0)
+			{
+				return false;
+			}
+
+			for (int32_t k = 0; k < 3; ++k)
+			{
+				if (Points[Vertices[Start * 3 + k]] == Point)
+				{
+					return false;
+				}
+			}
+
+			if (VisitStamps.size() < Alive.size())
+			{
+				VisitStamps.resize(Alive.size() * 2, 0);
+				BadFlags.resize(Alive.size() * 2, 0);
+			}
+			++CurrentStamp;
+
+			// Flood fill the triangles whose circumcircle contains the point, starting from the one containing it
+			Cavity.clear();
+			CavityBoundary.clear();
+			Stack.clear();
+			Stack.push_back(Start);
+			VisitStamps[Start] = CurrentStamp;
+			BadFlags[Start] = 1;
+
+			while (!Stack.empty())
+			{
+				const int32_t Triangle = Stack.back();
+				Stack.pop_back();
+				Cavity.push_back(Triangle);
+
+				for (int32_t Edge = 0; Edge < 3; ++Edge)
+				{
+					const int32_t Neighbor = Adjacent[Triangle * 3 + Edge];
+					if (Neighbor >= 0)
+					{
+						if (VisitStamps[Neighbor] != CurrentStamp)
+						{
+							VisitStamps[Neighbor] = CurrentStamp;
+							BadFlags[Neighbor] = IsInCircumcircle(Neighbor, Point) ? 1 : 0;
+							if (BadFlags[Neighbor])
+							{
+								Stack.push_back(Neighbor);
+								continue;
+							}
+						}
+						else if (BadFlags[Neighbor])
+						{
+							// Interior edge of the cavity
+							continue;
+						}
+					}
+
+					CavityBoundary.push_back({ Vertices[Triangle * 3 + (Edge + 1) % 3], Vertices[Triangle * 3 + (Edge + 2) % 3], Neighbor });
+				}
+			}
+
+			for (int32_t Triangle : Cavity)
+			{
+				Alive[Triangle] = 0;
+				FreeTriangles.push_back(Triangle);
+			}
+
+			// Fan the cavity boundary around the point
+			for (const FCavityEdge& Edge : CavityBoundary)
+			{
+				const int32_t NewTriangle = AllocateTriangle();
+				SetTriangle(NewTriangle, Edge.A, Edge.B, VertexIndex);
+				Adjacent[NewTriangle * 3 + 2] = Edge.Outer;
+				NewTriangleFromVertex[Edge.A] = NewTriangle;
+
+				if (Edge.Outer >= 0)
+				{
+					// Match the shared edge B -> A rather than the old triangle index, freed slots are being
+					// reused by this very loop
+					const int32_t* OuterCorners = &Vertices[Edge.Outer * 3];
+					for (int32_t k = 0; k < 3; ++k)
+					{
+						if (OuterCorners[(k + 1) % 3] == Edge.B && OuterCorners[(k + 2) % 3] == Edge.A)
+						{
+							Adjacent[Edge.Outer * 3 + k] = NewTriangle;
+							break;
+						}
+					}
+				}
+			}
+
+			// The boundary is a closed loop: the triangle starting at B follows the one on A -> B
+			for (const FCavityEdge& Edge : CavityBoundary)
+			{
+				const int32_t Triangle = NewTriangleFromVertex[Edge.A];
+				const int32_t NextTriangle = NewTriangleFromVertex[Edge.B];
+				Adjacent[Triangle * 3] = NextTriangle;
+				Adjacent[NextTriangle * 3 + 1] = Triangle;
+				LastTriangle = Triangle;
+			}
+
+			return true;
+		}
+
+		// Triangles of the brute force triangulation with their circumcircles, structure of arrays so the
+		// bad triangle search is a flat loop over three arrays. Points ends with the super triangle vertices.
+		struct FCircumcircleStore
+		{
+			std::vector<FVec2> Points;
+			std::vector<FLayoutTriangle> Triangles;
+			std::vector<double> CenterX;
+			std::vector<double> CenterY;
+			std::vector<double> RadiusSquared;
+			std::vector<uint8_t> BadFlags;
+
+			void Add(const FLayoutTriangle& Triangle)
+			{
+				FVec2 Center;
+				double Radius;
+				// Degenerate triangles get a zero radius and are never bad
+				ComputeCircumscribedCircle(Points[Triangle.A], Points[Triangle.B], Points[Triangle.C], Center, Radius);
+
+				Triangles.push_back(Triangle);
+				CenterX.push_back(Center.X);
+				CenterY.push_back(Center.Y);
+				RadiusSquared.push_back(Radius * Radius);
+			}
+
+			void RemoveSwap(size_t Index)
+			{
+				Triangles[Index] = Triangles.back();
+				CenterX[Index] = CenterX.back();
+				CenterY[Index] = CenterY.back();
+				RadiusSquared[Index] = RadiusSquared.back();
+				Triangles.pop_back();
+				CenterX.pop_back();
+				CenterY.pop_back();
+				RadiusSquared.pop_back();
+			}
+		};
+
+		// Bowyer-Watson insertion of one point, testing every triangle
+		void BruteForceDelaunayStep(FCircumcircleStore& Store, int32_t PointIndex)
+		{
+			const FVec2 Point = Store.Points[PointIndex];
+
+			// Find bad triangles
+			const size_t NumTriangles = Store.Triangles.size();
+			Store.BadFlags.resize(NumTriangles);
+			const double* CenterX = Store.CenterX.data();
+			const double* CenterY = Store.CenterY.data();
+			const double* RadiusSquared = Store.RadiusSquared.data();
+			uint8_t* BadFlags = Store.BadFlags.data();
+			for (size_t i = 0; i < NumTriangles; ++i)
+			{
+				const double DX = Point.X - CenterX[i];
+				const double DY = Point.Y - CenterY[i];
+				BadFlags[i] = DX * DX + DY * DY < RadiusSquared[i];
+			}
+
+			// Find boundary (edges that are unique)
+			std::vector<FDelaunayEdge> Polygon;
+
+			for (size_t i = 0; i < NumTriangles; ++i)
+			{
+				if (!BadFlags[i])
+				{
+					continue;
+				}
+
+				const FLayoutTriangle& BadTri = Store.Triangles[i];
+				const FDelaunayEdge Edges[3] = {
+					{ BadTri.A, BadTri.B },
+					{ BadTri.B, BadTri.C },
+					{ BadTri.C, BadTri.A }
+				};
+
+				for (const FDelaunayEdge& Edge : Edges)
+				{
+					const auto Shared = std::find(Polygon.begin(), Polygon.end(), Edge);
+					if (Shared != Polygon.end())
+					{
+						Polygon.erase(Shared);
+					}
+					else
+					{
+						Polygon.push_back(Edge);
+					}
+				}
+			}
+
+			// Remove bad triangles, from the back so the swapped in triangles were already tested
+			for (size_t i = NumTriangles; i-- > 0;)
+			{
+				if (BadFlags[i])
+				{
+					Store.RemoveSwap(i);
+				}
+			}
+
+			// Create new triangles
+			for (const FDelaunayEdge& Edge : Polygon)
+			{
+				Store.Add(FLayoutTriangle(Edge.A, Edge.B, PointIndex));
+			}
+		}
+	}
+
+	void ComputeSuperTriangle(const std::vector<FVec2>& Points, FVec2& OutA, FVec2& OutB, FVec2& OutC)
+	{
+		// Compute overall bounding box
+		FVec2 Min(DBL_MAX, DBL_MAX);
+		FVec2 Max(-DBL_MAX, -DBL_MAX);
+
+		for (const FVec2& Point : Points)
+		{
+			Min.X = std::min(Min.X, Point.X);
+			Min.Y = std::min(Min.Y, Point.Y);
+			Max.X = std::max(Max.X, Point.X);
+			Max.Y = std::max(Max.Y, Point.Y);
+		}
+
+		if (Points.empty())
+		{
+			Min = FVec2();
+			Max = FVec2();
+		}
+
+		// Expand bounding box (10%), never let it collapse to a line
+		const double MarginX = std::max((Max.X - Min.X) * 0.1, 1.0);
+		const double MarginY = std::max((Max.Y - Min.Y) * 0.1, 1.0);
+
+		Min.X -= MarginX;
+		Min.Y -= MarginY;
+		Max.X += MarginX;
+		Max.Y += MarginY;
+
+		// Build a big triangle that fully contains the bounding box
+		OutA = FVec2(Min.X - (Max.X - Min.X), Min.Y - (Max.Y - Min.Y)); // bottom-left far
+		OutB = FVec2(Max.X + (Max.X - Min.X), Min.Y - (Max.Y - Min.Y)); // bottom-right far
+		OutC = FVec2((Min.X + Max.X) / 2, Max.Y + (Max.Y - Min.Y) * 2.0); // top-center far
+	}
+
+	bool ComputeCircumscribedCircle(const FVec2& A, const FVec2& B, const FVec2& C, FVec2& OutCenter, double& OutRadius)
+	{
+		// Calculate midpoints
+		const FVec2 MidAB = (A + B) * 0.5;
+		const FVec2 MidBC = (B + C) * 0.5;
+
+		// Calculate perpendicular directions
+		const FVec2 DirAB = B - A;
+		const FVec2 DirBC = C - B;
+
+		const FVec2 PerpAB(-DirAB.Y, DirAB.X);
+		const FVec2 PerpBC(-DirBC.Y, DirBC.X);
+
+		// Solve intersection: MidAB + PerpAB * t = MidBC + PerpBC * s
+		const double Denom = PerpAB.X * PerpBC.Y - PerpAB.Y * PerpBC.X;
+
+		if (std::fabs(Denom) < 1.e-8)
+		{
+			// Triangle is degenerate (points colinear): use average
+			OutCenter = (A + B + C) * (1.0 / 3.0);
+			OutRadius = 0.0;
+			return false;
+		}
+
+		const FVec2 Delta = MidBC - MidAB;
+		const double T = (Delta.X * PerpBC.Y - Delta.Y * PerpBC.X) / Denom;
+
+		OutCenter = MidAB + PerpAB * T;
+		OutRadius = FVec2::Dist(OutCenter, A);
+		return true;
+	}
+
+	void Triangulate(const std::vector<FVec2>& Points, std::vector<FLayoutTriangle>& OutTriangles, FLayoutStats* OutStats)
+	{
+		OutTriangles.clear();
+		const int32_t NumPoints = static_cast<int32_t>(Points.size());
+
+		FDelaunayMesh Mesh;
+		Mesh.Init(Points);
+
+		// Hilbert order keeps consecutive points close, so each walk is only a few steps long
+		FVec2 Min(DBL_MAX, DBL_MAX);
+		FVec2 Max(-DBL_MAX, -DBL_MAX);
+		for (const FVec2& Point : Points)
+		{
+			Min.X = std::min(Min.X, Point.X);
+			Min.Y = std::min(Min.Y, Point.Y);
+			Max.X = std::max(Max.X, Point.X);
+			Max.Y = std::max(Max.Y, Point.Y);
+		}
+		const double Scale = 65535.0 / std::max(std::max(Max.X - Min.X, Max.Y - Min.Y), 1.e-9);
+
+		std::vector<std::pair<uint64_t, int32_t>> InsertionOrder(NumPoints);
+		for (int32_t i = 0; i < NumPoints; ++i)
+		{
+			const uint32_t X = static_cast<uint32_t>((Points[i].X - Min.X) * Scale);
+			const uint32_t Y = static_cast<uint32_t>((Points[i].Y - Min.Y) * Scale);
+			InsertionOrder[i] = std::make_pair(HilbertIndex(X, Y), i);
+		}
+		std::sort(InsertionOrder.begin(), InsertionOrder.end());
+
+		for (const std::pair<uint64_t, int32_t>& Entry : InsertionOrder)
+		{
+			if (Mesh.Insert(Entry.second) && OutStats)
+			{
+				++OutStats->DelaunayInsertions;
+				OutStats->DelaunayBadTriangles += Mesh.GetCavitySize();
+				OutStats->MaxDelaunayBadTriangles = std::max(OutStats->MaxDelaunayBadTriangles, Mesh.GetCavitySize());
+			}
+		}
+
+		// Keep the triangles that don't use a super triangle vertex
+		OutTriangles.reserve(Mesh.NumTriangles());
+		for (int32_t Triangle = 0; Triangle < Mesh.NumTriangles(); ++Triangle)
+		{
+			const int32_t* Corners = &Mesh.Vertices[Triangle * 3];
+			if (Mesh.Alive[Triangle] && Corners[0] < NumPoints && Corners[1] < NumPoints && Corners[2] < NumPoints)
+			{
+				OutTriangles.push_back(FLayoutTriangle(Corners[0], Corners[1], Corners[2]));
+			}
+		}
+	}
+
+	void TriangulateBruteForce(const std::vector<FVec2>& Points, std::vector<FLayoutTriangle>& OutTriangles)
+	{
+		const int32_t NumPoints = static_cast<int32_t>(Points.size());
+
+		FCircumcircleStore Store;
+		Store.Points = Points;
+		FVec2 SuperVertices[3];
+		ComputeSuperTriangle(Points, SuperVertices[0], SuperVertices[1], SuperVertices[2]);
+		Store.Points.insert(Store.Points.end(), SuperVertices, SuperVertices + 3);
+		Store.Add(FLayoutTriangle(NumPoints, NumPoints + 1, NumPoints + 2));
+
+		for (int32_t i = 0; i < NumPoints; ++i)
+		{
+			BruteForceDelaunayStep(Store, i);
+		}
+
+		// Remove triangles containing super-triangle vertices, make the rest counter clockwise
+		OutTriangles.clear();
+		for (const FLayoutTriangle& Tri : Store.Triangles)
+		{
+			if (Tri.A < NumPoints && Tri.B < NumPoints && Tri.C < NumPoints)
+			{
+				const bool bClockwise = Orient2D(Points[Tri.A], Points[Tri.B], Points[Tri.C]) < 0;
+				OutTriangles.push_back(bClockwise ? FLayoutTriangle(Tri.A, Tri.C, Tri.B) : Tri);
+			}
+		}
+	}
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LayoutStats.h"
+#include "LayoutTypes.h"
+
+namespace DungeonLayout
+{
+	// Triangle enclosing every point, with a margin
+	void ComputeSuperTriangle(const std::vector<FVec2>& Points, FVec2& OutA, FVec2& OutB, FVec2& OutC);
+
+	// Returns false for degenerate (colinear) triangles
+	bool ComputeCircumscribedCircle(const FVec2& A, const FVec2& B, const FVec2& C, FVec2& OutCenter, double& OutRadius);
+
+	// Delaunay triangulation of Points, counter clockwise triangles indexing Points. The super triangle is removed
+	// from the result.
+	// Bowyer-Watson on a triangle mesh with adjacency: points are inserted in Hilbert curve order, located by
+	// walking from the last inserted triangle and their cavity is found by flood fill, so an insertion only
+	// touches the triangles around the point. Circumcircles are cached per triangle. Duplicate points are skipped.
+	// OutStats, when given, gets the insertions and their bad triangle counts added.
+	void Triangulate(const std::vector<FVec2>& Points, std::vector<FLayoutTriangle>& OutTriangles, FLayoutStats* OutStats = nullptr);
+
+	// Textbook Bowyer-Watson testing every triangle for every point, O(N^2), with each circumcircle computed once.
+	// Kept as a reference for tests and benchmarks.
+	void TriangulateBruteForce(const std::vector<FVec2>& Points, std::vector<FLayoutTriangle>& OutTriangles);
+}
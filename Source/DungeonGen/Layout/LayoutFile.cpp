@@ -0,0 +1,341 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutFile.h"
+
+#include "LayoutCompression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		constexpr uint32_t LayoutFileMagic = 0x59414C44; // "DLAY"
+		// Worst case expansion of a CompressBytes block, a bigger TablesSize is a corrupt header
+		constexpr uint64_t MaxCompressionRatio = 255;
+
+		// Byte offset of every table. Each holds 4 byte values, so every table stays 4 byte aligned.
+		struct FTableOffsets
+		{
+			uint64_t RoomCenterX = 0;
+			uint64_t RoomCenterY = 0;
+			uint64_t RoomHalfExtentX = 0;
+			uint64_t RoomHalfExtentY = 0;
+			uint64_t RoomArea = 0;
+			uint64_t SelectedRooms = 0;
+			uint64_t CorridorRooms = 0;
+			uint64_t EdgeA = 0;
+			uint64_t EdgeB = 0;
+			uint64_t EdgeWeight = 0;
+			uint64_t SegmentStartX = 0;
+			uint64_t SegmentStartY = 0;
+			uint64_t SegmentEndX = 0;
+			uint64_t SegmentEndY = 0;
+			uint64_t SegmentEdge = 0;
+			uint64_t Size = 0;
+		};
+
+		FTableOffsets ComputeTableOffsets(const FLayoutFileHeader& Header)
+		{
+			FTableOffsets Offsets;
+			uint64_t Offset = 0;
+			auto Take = [&Offset](uint32_t Count)
+			{
+				const uint64_t Start = Offset;
+				Offset += static_cast<uint64_t>(Count) * 4;
+				return Start;
+			};
+			Offsets.RoomCenterX = Take(Header.NumRooms);
+			Offsets.RoomCenterY = Take(Header.NumRooms);
+			Offsets.RoomHalfExtentX = Take(Header.NumRooms);
+			Offsets.RoomHalfExtentY = Take(Header.NumRooms);
+			Offsets.RoomArea = Take(Header.NumRooms);
+			Offsets.SelectedRooms = Take(Header.NumSelectedRooms);
+			Offsets.CorridorRooms = Take(Header.NumCorridorRooms);
+			Offsets.EdgeA = Take(Header.NumEdges);
+			Offsets.EdgeB = Take(Header.NumEdges);
+			Offsets.EdgeWeight = Take(Header.NumEdges);
+			Offsets.SegmentStartX = Take(Header.NumCorridorSegments);
+			Offsets.SegmentStartY = Take(Header.NumCorridorSegments);
+			Offsets.SegmentEndX = Take(Header.NumCorridorSegments);
+			Offsets.SegmentEndY = Take(Header.NumCorridorSegments);
+			Offsets.SegmentEdge = Take(Header.NumCorridorSegments);
+			Offsets.Size = Offset;
+			return Offsets;
+		}
+
+		template <typename T>
+		void PutValue(std::vector<uint8_t>& Tables, uint64_t TableOffset, size_t Index, T Value)
+		{
+			static_assert(sizeof(T) == 4, "Every table holds 4 byte values");
+			std::memcpy(Tables.data() + TableOffset + Index * sizeof(T), &Value, sizeof(T));
+		}
+
+		template <typename T>
+		const T* GetTable(const uint8_t* Tables, uint64_t TableOffset)
+		{
+			return reinterpret_cast<const T*>(Tables + TableOffset);
+		}
+
+		bool AreIndicesBelow(const uint32_t* Indices, uint32_t Count, uint32_t Limit)
+		{
+			for (uint32_t i = 0; i < Count; ++i)
+			{
+				if (Indices[i] >= Limit)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Center of the room bounds, the stored floats then stay small
+		FVec2 ComputeOrigin(const FDungeonLayout& Layout)
+		{
+			if (Layout.Rooms.empty())
+			{
+				return FVec2();
+			}
+			FVec2 Min = Layout.Rooms[0].Min();
+			FVec2 Max = Layout.Rooms[0].Max();
+			for (const FLayoutRoom& Room : Layout.Rooms)
+			{
+				Min = FVec2(std::min(Min.X, Room.Min().X), std::min(Min.Y, Room.Min().Y));
+				Max = FVec2(std::max(Max.X, Room.Max().X), std::max(Max.Y, Room.Max().Y));
+			}
+			return (Min + Max) * 0.5;
+		}
+	}
+
+	void WriteLayoutFile(const FDungeonLayout& Layout, bool bCompress, std::vector<uint8_t>& OutBytes)
+	{
+		FLayoutFileHeader Header;
+		Header.Magic = LayoutFileMagic;
+		Header.Version = LayoutFileVersion;
+		Header.NumRooms = static_cast<uint32_t>(Layout.Rooms.size());
+		Header.NumSelectedRooms = static_cast<uint32_t>(Layout.SelectedRooms.size());
+		Header.NumCorridorRooms = static_cast<uint32_t>(Layout.CorridorRooms.size());
+		Header.NumEdges = static_cast<uint32_t>(Layout.MinimumSpanningTree.size());
+		Header.NumCorridorSegments = static_cast<uint32_t>(Layout.Corridors.size());
+		const FVec2 Origin = ComputeOrigin(Layout);
+		Header.OriginX = Origin.X;
+		Header.OriginY = Origin.Y;
+
+		const FTableOffsets Offsets = ComputeTableOffsets(Header);
+		std::vector<uint8_t> Tables(static_cast<size_t>(Offsets.Size));
+		for (size_t i = 0; i < Layout.Rooms.size(); ++i)
+		{
+			const FLayoutRoom& Room = Layout.Rooms[i];
+			PutValue(Tables, Offsets.RoomCenterX, i, static_cast<float>(Room.Center.X - Origin.X));
+			PutValue(Tables, Offsets.RoomCenterY, i, static_cast<float>(Room.Center.Y - Origin.Y));
+			PutValue(Tables, Offsets.RoomHalfExtentX, i, static_cast<float>(Room.HalfExtents.X));
+			PutValue(Tables, Offsets.RoomHalfExtentY, i, static_cast<float>(Room.HalfExtents.Y));
+			PutValue(Tables, Offsets.RoomArea, i, Room.Area);
+		}
+		for (size_t i = 0; i < Layout.SelectedRooms.size(); ++i)
+		{
+			PutValue(Tables, Offsets.SelectedRooms, i, static_cast<uint32_t>(Layout.SelectedRooms[i]));
+		}
+		for (size_t i = 0; i < Layout.CorridorRooms.size(); ++i)
+		{
+			PutValue(Tables, Offsets.CorridorRooms, i, static_cast<uint32_t>(Layout.CorridorRooms[i]));
+		}
+		for (size_t i = 0; i < Layout.MinimumSpanningTree.size(); ++i)
+		{
+			const FLayoutEdge& Edge = Layout.MinimumSpanningTree[i];
+			PutValue(Tables, Offsets.EdgeA, i, static_cast<uint32_t>(Edge.A));
+			PutValue(Tables, Offsets.EdgeB, i, static_cast<uint32_t>(Edge.B));
+			PutValue(Tables, Offsets.EdgeWeight, i, Edge.Weight);
+		}
+		for (size_t i = 0; i < Layout.Corridors.size(); ++i)
+		{
+			const FCorridorSegment& Segment = Layout.Corridors[i];
+			PutValue(Tables, Offsets.SegmentStartX, i, static_cast<float>(Segment.Start.X - Origin.X));
+			PutValue(Tables, Offsets.SegmentStartY, i, static_cast<float>(Segment.Start.Y - Origin.Y));
+			PutValue(Tables, Offsets.SegmentEndX, i, static_cast<float>(Segment.End.X - Origin.X));
+			PutValue(Tables, Offsets.SegmentEndY, i, static_cast<float>(Segment.End.Y - Origin.Y));
+			PutValue(Tables, Offsets.SegmentEdge, i, static_cast<uint32_t>(Segment.EdgeIndex));
+		}
+
+		std::vector<uint8_t> Compressed;
+		if (bCompress)
+		{
+			CompressBytes(Tables.data(), Tables.size(), Compressed);
+		}
+		const bool bStoreCompressed = bCompress && Compressed.size() < Tables.size();
+		const std::vector<uint8_t>& Stored = bStoreCompressed ? Compressed : Tables;
+		Header.Flags = static_cast<uint16_t>(bStoreCompressed ? ELayoutFileFlags::Compressed : ELayoutFileFlags::None);
+		Header.TablesSize = Offsets.Size;
+		Header.StoredSize = Stored.size();
+
+		const size_t HeaderOffset = OutBytes.size();
+		OutBytes.resize(HeaderOffset + sizeof(Header));
+		std::memcpy(OutBytes.data() + HeaderOffset, &Header, sizeof(Header));
+		OutBytes.insert(OutBytes.end(), Stored.begin(), Stored.end());
+	}
+
+	bool SaveLayoutFile(const FDungeonLayout& Layout, const std::string& Path, bool bCompress)
+	{
+		std::vector<uint8_t> Bytes;
+		WriteLayoutFile(Layout, bCompress, Bytes);
+
+		static std::atomic<uint32_t> TempCounter(0);
+		const std::string TempPath = Path + "." + std::to_string(TempCounter++) + ".tmp";
+		{
+			std::ofstream File(TempPath, std::ios::binary | std::ios::trunc);
+			File.write(reinterpret_cast<const char*>(Bytes.data()), static_cast<std::streamsize>(Bytes.size()));
+			if (!File)
+			{
+				File.close();
+				std::error_code Error;
+				std::filesystem::remove(TempPath, Error);
+				return false;
+			}
+		}
+		std::error_code Error;
+		std::filesystem::rename(TempPath, Path, Error);
+		if (Error)
+		{
+			std::filesystem::remove(TempPath, Error);
+			return false;
+		}
+		return true;
+	}
+
+	bool FLayoutFileView::Init(const uint8_t* Data, size_t Size)
+	{
+		Reset();
+		if (!Data || Size < sizeof(FLayoutFileHeader) || reinterpret_cast<uintptr_t>(Data) % alignof(uint32_t) != 0)
+		{
+			return false;
+		}
+
+		std::memcpy(&Header, Data, sizeof(Header));
+		const uint16_t KnownFlags = static_cast<uint16_t>(ELayoutFileFlags::Compressed);
+		if (Header.Magic != LayoutFileMagic || Header.Version != LayoutFileVersion || (Header.Flags & ~KnownFlags) != 0
+			|| Header.StoredSize != Size - sizeof(Header) || Header.TablesSize != ComputeTableOffsets(Header).Size)
+		{
+			Reset();
+			return false;
+		}
+
+		const uint8_t* Stored = Data + sizeof(Header);
+		if (!IsCompressed())
+		{
+			// Counts claiming more tables than the file holds would read past it
+			if (Header.TablesSize != Header.StoredSize)
+			{
+				Reset();
+				return false;
+			}
+			Tables = Stored;
+		}
+		else
+		{
+			if (Header.TablesSize > Header.StoredSize * MaxCompressionRatio)
+			{
+				Reset();
+				return false;
+			}
+			Decompressed.resize(static_cast<size_t>(Header.TablesSize));
+			if (!DecompressBytes(Stored, static_cast<size_t>(Header.StoredSize), Decompressed.data(), Decompressed.size()))
+			{
+				Reset();
+				return false;
+			}
+			Tables = Decompressed.data();
+		}
+
+		if (!InitTables())
+		{
+			Reset();
+			return false;
+		}
+		return true;
+	}
+
+	bool FLayoutFileView::InitTables()
+	{
+		const FTableOffsets Offsets = ComputeTableOffsets(Header);
+		RoomCenterX = GetTable<float>(Tables, Offsets.RoomCenterX);
+		RoomCenterY = GetTable<float>(Tables, Offsets.RoomCenterY);
+		RoomHalfExtentX = GetTable<float>(Tables, Offsets.RoomHalfExtentX);
+		RoomHalfExtentY = GetTable<float>(Tables, Offsets.RoomHalfExtentY);
+		RoomArea = GetTable<float>(Tables, Offsets.RoomArea);
+		SelectedRooms = GetTable<uint32_t>(Tables, Offsets.SelectedRooms);
+		CorridorRooms = GetTable<uint32_t>(Tables, Offsets.CorridorRooms);
+		EdgeA = GetTable<uint32_t>(Tables, Offsets.EdgeA);
+		EdgeB = GetTable<uint32_t>(Tables, Offsets.EdgeB);
+		EdgeWeight = GetTable<float>(Tables, Offsets.EdgeWeight);
+		SegmentStartX = GetTable<float>(Tables, Offsets.SegmentStartX);
+		SegmentStartY = GetTable<float>(Tables, Offsets.SegmentStartY);
+		SegmentEndX = GetTable<float>(Tables, Offsets.SegmentEndX);
+		SegmentEndY = GetTable<float>(Tables, Offsets.SegmentEndY);
+		SegmentEdge = GetTable<uint32_t>(Tables, Offsets.SegmentEdge);
+
+		// The spawning code indexes with these without checking
+		return AreIndicesBelow(SelectedRooms, Header.NumSelectedRooms, Header.NumRooms)
+			&& AreIndicesBelow(CorridorRooms, Header.NumCorridorRooms, Header.NumRooms)
+			&& AreIndicesBelow(EdgeA, Header.NumEdges, Header.NumRooms)
+			&& AreIndicesBelow(EdgeB, Header.NumEdges, Header.NumRooms)
+			&& AreIndicesBelow(SegmentEdge, Header.NumCorridorSegments, Header.NumEdges);
+	}
+
+	void FLayoutFileView::Reset()
+	{
+		Header = FLayoutFileHeader();
+		std::vector<uint8_t>().swap(Decompressed);
+		Tables = nullptr;
+	}
+
+	FLayoutRoom FLayoutFileView::GetRoom(uint32_t Index) const
+	{
+		FLayoutRoom Room;
+		Room.Center = FVec2(Header.OriginX + RoomCenterX[Index], Header.OriginY + RoomCenterY[Index]);
+		Room.HalfExtents = FVec2(RoomHalfExtentX[Index], RoomHalfExtentY[Index]);
+		Room.Area = RoomArea[Index];
+		Room.Id = static_cast<int32_t>(Index);
+		return Room;
+	}
+
+	FLayoutEdge FLayoutFileView::GetEdge(uint32_t Index) const
+	{
+		return FLayoutEdge(static_cast<int32_t>(EdgeA[Index]), static_cast<int32_t>(EdgeB[Index]), EdgeWeight[Index]);
+	}
+
+	FCorridorSegment FLayoutFileView::GetCorridorSegment(uint32_t Index) const
+	{
+		FCorridorSegment Segment;
+		Segment.Start = FVec2(Header.OriginX + SegmentStartX[Index], Header.OriginY + SegmentStartY[Index]);
+		Segment.End = FVec2(Header.OriginX + SegmentEndX[Index], Header.OriginY + SegmentEndY[Index]);
+		Segment.EdgeIndex = static_cast<int32_t>(SegmentEdge[Index]);
+		return Segment;
+	}
+
+	void FLayoutFileView::CopyTo(FDungeonLayout& OutLayout) const
+	{
+		OutLayout.Rooms.resize(Header.NumRooms);
+		for (uint32_t i = 0; i < Header.NumRooms; ++i)
+		{
+			OutLayout.Rooms[i] = GetRoom(i);
+		}
+		OutLayout.SelectedRooms.assign(SelectedRooms, SelectedRooms + Header.NumSelectedRooms);
+		OutLayout.CorridorRooms.assign(CorridorRooms, CorridorRooms + Header.NumCorridorRooms);
+		OutLayout.Triangles.clear();
+		OutLayout.MinimumSpanningTree.resize(Header.NumEdges);
+		for (uint32_t i = 0; i < Header.NumEdges; ++i)
+		{
+			OutLayout.MinimumSpanningTree[i] = GetEdge(i);
+		}
+		OutLayout.Corridors.resize(Header.NumCorridorSegments);
+		for (uint32_t i = 0; i < Header.NumCorridorSegments; ++i)
+		{
+			OutLayout.Corridors[i] = GetCorridorSegment(i);
+		}
+	}
+}
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Versioned binary layout files, for pre-generated and authored dungeons. Unlike the layout cache files
+// they do not depend on generation parameters, and they are laid out to be used in place once mapped:
+//
+//   FLayoutFileHeader, then the tables, optionally compressed as one block
+//   rooms     SoA: CenterX, CenterY, HalfExtentX, HalfExtentY, Area (float, centers relative to the origin)
+//   selected  room indices (uint32), biggest first
+//   corridor  room indices (uint32)
+//   edges     SoA: A, B (uint32 room indices), Weight (float)
+//   segments  SoA: StartX, StartY, EndX, EndY (float, relative to the origin), EdgeIndex (uint32)
+//
+// Triangles and separation stats are not stored, nothing downstream of the spanning tree needs them.
+
+#include "LayoutTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// FMappedLayoutFile maps files with the platform API. The engine module maps them with IMappedFileHandle instead
+// and hands the bytes to FLayoutFileView, it builds with this at 0 to keep platform headers out of its unity files.
+#ifndef DUNGEON_LAYOUT_FILE_MAPPING
+#define DUNGEON_LAYOUT_FILE_MAPPING 1
+#endif
+
+namespace DungeonLayout
+{
+	// Bump on any change to the header or the tables, older files are then rejected
+	constexpr uint16_t LayoutFileVersion = 1;
+
+	enum class ELayoutFileFlags : uint16_t
+	{
+		None = 0,
+		// The tables are one CompressBytes block of TablesSize bytes once decompressed
+		Compressed = 1 << 0
+	};
+
+	struct FLayoutFileHeader
+	{
+		uint32_t Magic = 0;
+		uint16_t Version = 0;
+		uint16_t Flags = 0;
+		uint32_t NumRooms = 0;
+		uint32_t NumSelectedRooms = 0;
+		uint32_t NumCorridorRooms = 0;
+		uint32_t NumEdges = 0;
+		uint32_t NumCorridorSegments = 0;
+		uint32_t Reserved = 0;
+		// Stored positions are relative to it, keeps float precision around far away dungeons
+		double OriginX = 0.0;
+		double OriginY = 0.0;
+		uint64_t TablesSize = 0;
+		// Bytes after the header, TablesSize unless compressed
+		uint64_t StoredSize = 0;
+	};
+	static_assert(sizeof(FLayoutFileHeader) == 64, "The header is part of the file format");
+
+	// Appends the file form of Layout to OutBytes. Compression is skipped when it does not make the file smaller.
+	void WriteLayoutFile(const FDungeonLayout& Layout, bool bCompress, std::vector<uint8_t>& OutBytes);
+
+	// Writes aside then renames, a reader never maps half a file
+	bool SaveLayoutFile(const FDungeonLayout& Layout, const std::string& Path, bool bCompress);
+
+	// Read only view of a layout file. Uncompressed files are read in place, Data must then outlive the view;
+	// compressed ones are decompressed into a buffer owned by the view. Init checks every index once, the
+	// accessors do not.
+	class FLayoutFileView
+	{
+	public:
+		FLayoutFileView() {}
+		FLayoutFileView(const FLayoutFileView&) = delete;
+		FLayoutFileView& operator=(const FLayoutFileView&) = delete;
+
+		// False on a foreign, truncated or inconsistent file. Data must be 4 byte aligned.
+		bool Init(const uint8_t* Data, size_t Size);
+		void Reset();
+
+		bool IsValid() const { return Tables != nullptr; }
+		bool IsCompressed() const { return (Header.Flags & static_cast<uint16_t>(ELayoutFileFlags::Compressed)) != 0; }
+		const FLayoutFileHeader& GetHeader() const { return Header; }
+
+		uint32_t GetNumRooms() const { return Header.NumRooms; }
+		FLayoutRoom GetRoom(uint32_t Index) const;
+
+		uint32_t GetNumSelectedRooms() const { return Header.NumSelectedRooms; }
+		const uint32_t* GetSelectedRooms() const { return SelectedRooms; }
+
+		uint32_t GetNumCorridorRooms() const { return Header.NumCorridorRooms; }
+		const uint32_t* GetCorridorRooms() const { return CorridorRooms; }
+
+		uint32_t GetNumEdges() const { return Header.NumEdges; }
+		FLayoutEdge GetEdge(uint32_t Index) const;
+
+		uint32_t GetNumCorridorSegments() const { return Header.NumCorridorSegments; }
+		FCorridorSegment GetCorridorSegment(uint32_t Index) const;
+
+		// One pass over the tables into exactly sized arrays, OutLayout.Triangles is left empty
+		void CopyTo(FDungeonLayout& OutLayout) const;
+
+	private:
+		bool InitTables();
+
+		FLayoutFileHeader Header;
+		std::vector<uint8_t> Decompressed;
+		const uint8_t* Tables = nullptr;
+
+		const float* RoomCenterX = nullptr;
+		const float* RoomCenterY = nullptr;
+		const float* RoomHalfExtentX = nullptr;
+		const float* RoomHalfExtentY = nullptr;
+		const float* RoomArea = nullptr;
+		const uint32_t* SelectedRooms = nullptr;
+		const uint32_t* CorridorRooms = nullptr;
+		const uint32_t* EdgeA = nullptr;
+		const uint32_t* EdgeB = nullptr;
+		const float* EdgeWeight = nullptr;
+		const float* SegmentStartX = nullptr;
+		const float* SegmentStartY = nullptr;
+		const float* SegmentEndX = nullptr;
+		const float* SegmentEndY = nullptr;
+		const uint32_t* SegmentEdge = nullptr;
+	};
+
+#if DUNGEON_LAYOUT_FILE_MAPPING
+	// Layout file mapped read only into memory, the view reads straight from the mapping
+	class FMappedLayoutFile
+	{
+	public:
+		FMappedLayoutFile() {}
+		~FMappedLayoutFile();
+		FMappedLayoutFile(const FMappedLayoutFile&) = delete;
+		FMappedLayoutFile& operator=(const FMappedLayoutFile&) = delete;
+
+		// Closes the previous file first. False when the file cannot be mapped or is not a valid layout file.
+		bool Open(const std::string& Path);
+		void Close();
+
+		const FLayoutFileView& GetView() const { return View; }
+
+	private:
+		const uint8_t* Data = nullptr;
+		size_t Size = 0;
+#if defined(_WIN32)
+		void* MappingHandle = nullptr;
+#endif
+		FLayoutFileView View;
+	};
+#endif
+}
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Platform side of FMappedLayoutFile, kept out of LayoutFile.cpp so the platform headers stay in this file.
+// Not compiled by the engine module, see DUNGEON_LAYOUT_FILE_MAPPING.
+
+#include "LayoutFile.h"
+
+#if DUNGEON_LAYOUT_FILE_MAPPING
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+#include <climits>
+#include <string>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DungeonLayout
+{
+#if defined(_WIN32)
+	namespace
+	{
+		// Empty when Path is not valid UTF-8
+		std::wstring ToWidePath(const std::string& Path)
+		{
+			if (Path.empty() || Path.size() > static_cast<size_t>(INT_MAX))
+			{
+				return std::wstring();
+			}
+			const int PathSize = static_cast<int>(Path.size());
+			const int WideSize = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, Path.data(), PathSize, nullptr, 0);
+			if (WideSize <= 0)
+			{
+				return std::wstring();
+			}
+			std::wstring WidePath(static_cast<size_t>(WideSize), L'\0');
+			MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, Path.data(), PathSize, &WidePath[0], WideSize);
+			return WidePath;
+		}
+	}
+#endif
+
+	FMappedLayoutFile::~FMappedLayoutFile()
+	{
+		Close();
+	}
+
+	bool FMappedLayoutFile::Open(const std::string& Path)
+	{
+		Close();
+
+#if defined(_WIN32)
+		const std::wstring WidePath = ToWidePath(Path);
+		if (WidePath.empty())
+		{
+			return false;
+		}
+		const HANDLE File = CreateFileW(WidePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER FileSize;
+		if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart <= 0)
+		{
+			CloseHandle(File);
+			return false;
+		}
+		const HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(File);
+		if (!Mapping)
+		{
+			return false;
+		}
+		const void* Mapped = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!Mapped)
+		{
+			CloseHandle(Mapping);
+			return false;
+		}
+		MappingHandle = Mapping;
+		Size = static_cast<size_t>(FileSize.QuadPart);
+#else
+		const int File = open(Path.c_str(), O_RDONLY);
+		if (File < 0)
+		{
+			return false;
+		}
+		struct stat FileStat;
+		if (fstat(File, &FileStat) != 0 || FileStat.st_size <= 0)
+		{
+			close(File);
+			return false;
+		}
+		const void* Mapped = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+		// The mapping keeps the file alive
+		close(File);
+		if (Mapped == MAP_FAILED)
+		{
+			return false;
+		}
+		Size = static_cast<size_t>(FileStat.st_size);
+#endif
+
+		Data = static_cast<const uint8_t*>(Mapped);
+		if (!View.Init(Data, Size))
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void FMappedLayoutFile::Close()
+	{
+		View.Reset();
+		if (!Data)
+		{
+			return;
+		}
+
+#if defined(_WIN32)
+		UnmapViewOfFile(Data);
+		CloseHandle(MappingHandle);
+		MappingHandle = nullptr;
+#else
+		munmap(const_cast<uint8_t*>(Data), Size);
+#endif
+		Data = nullptr;
+		Size = 0;
+	}
+}
+
+#endif
@@ -0,0 +1,409 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutGraph.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <utility>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		// Min heap of node ids keyed by weight with decrease-key. Four children per node keeps it shallow
+		// and the children of a node on one cache line.
+		class FSpanningTreeHeap
+		{
+		public:
+			explicit FSpanningTreeHeap(int32_t NumNodes)
+				: Positions(NumNodes, -1)
+			{
+				Nodes.reserve(NumNodes);
+				Keys.reserve(NumNodes);
+			}
+
+			bool IsEmpty() const
+			{
+				return Nodes.empty();
+			}
+
+			// Inserts Node or lowers its key
+			void Update(int32_t Node, float Key)
+			{
+				int32_t Position = Positions[Node];
+				if (Position < 0)
+				{
+					Position = static_cast<int32_t>(Nodes.size());
+					Nodes.push_back(Node);
+					Keys.push_back(Key);
+					Positions[Node] = Position;
+				}
+				else
+				{
+					Keys[Position] = Key;
+				}
+				SiftUp(Position);
+			}
+
+			int32_t Pop()
+			{
+				const int32_t Top = Nodes[0];
+				Positions[Top] = -1;
+
+				const int32_t Last = static_cast<int32_t>(Nodes.size()) - 1;
+				if (Last > 0)
+				{
+					Nodes[0] = Nodes[Last];
+					Keys[0] = Keys[Last];
+					Positions[Nodes[0]] = 0;
+				}
+				Nodes.pop_back();
+				Keys.pop_back();
+				if (!Nodes.empty())
+				{
+					SiftDown(0);
+				}
+				return Top;
+			}
+
+		private:
+			static constexpr int32_t Arity = 4;
+
+			void Place(int32_t Position, int32_t Node, float Key)
+			{
+				Nodes[Position] = Node;
+				Keys[Position] = Key;
+				Positions[Node] = Position;
+			}
+
+			void SiftUp(int32_t Position)
+			{
+				const int32_t Node = Nodes[Position];
+				const float Key = Keys[Position];
+				while (Position > 0)
+				{
+					const int32_t Parent = (Position - 1) / Arity;
+					if (Keys[Parent] <= Key)
+					{
+						break;
+					}
+					Place(Position, Nodes[Parent], Keys[Parent]);
+					Position = Parent;
+				}
+				Place(Position, Node, Key);
+			}
+
+			void SiftDown(int32_t Position)
+			{
+				const int32_t Num = static_cast<int32_t>(Nodes.size());
+				const int32_t Node = Nodes[Position];
+				const float Key = Keys[Position];
+				while (true)
+				{
+					const int32_t FirstChild = Position * Arity + 1;
+					if (FirstChild >= Num)
+					{
+						break;
+					}
+					const int32_t EndChild = std::min(FirstChild + Arity, Num);
+					int32_t BestChild = FirstChild;
+					for (int32_t Child = FirstChild + 1; Child < EndChild; ++Child)
+					{
+						if (Keys[Child] < Keys[BestChild])
+						{
+							BestChild = Child;
+						}
+					}
+					if (Keys[BestChild] >= Key)
+					{
+						break;
+					}
+					Place(Position, Nodes[BestChild], Keys[BestChild]);
+					Position = BestChild;
+				}
+				Place(Position, Node, Key);
+			}
+
+			std::vector<int32_t> Nodes;
+			std::vector<float> Keys;
+			// Heap position of every node, -1 when not in the heap
+			std::vector<int32_t> Positions;
+		};
+
+		// Disjoint sets with union by size and path halving
+		class FSpanningTreeUnionFind
+		{
+		public:
+			explicit FSpanningTreeUnionFind(int32_t NumNodes)
+				: Parents(NumNodes), Sizes(NumNodes, 1)
+			{
+				for (int32_t i = 0; i < NumNodes; ++i)
+				{
+					Parents[i] = i;
+				}
+			}
+
+			int32_t Find(int32_t Node)
+			{
+				while (Parents[Node] != Node)
+				{
+					Parents[Node] = Parents[Parents[Node]];
+					Node = Parents[Node];
+				}
+				return Node;
+			}
+
+			// Returns false if A and B were already in the same set
+			bool Union(int32_t A, int32_t B)
+			{
+				int32_t RootA = Find(A);
+				int32_t RootB = Find(B);
+				if (RootA == RootB)
+				{
+					return false;
+				}
+				if (Sizes[RootA] < Sizes[RootB])
+				{
+					std::swap(RootA, RootB);
+				}
+				Parents[RootB] = RootA;
+				Sizes[RootA] += Sizes[RootB];
+				return true;
+			}
+
+		private:
+			std::vector<int32_t> Parents;
+			std::vector<int32_t> Sizes;
+		};
+
+		// Edge indices by increasing weight. Weights are never negative, so the bits of the float sort like
+		// an unsigned integer: four stable 8 bit counting passes (LSD radix sort).
+		void RadixSortEdgesByWeight(const std::vector<FLayoutEdge>& Edges, std::vector<int32_t>& OutOrder)
+		{
+			const int32_t NumEdges = static_cast<int32_t>(Edges.size());
+			OutOrder.clear();
+			if (NumEdges == 0)
+			{
+				return;
+			}
+
+			std::vector<uint32_t> Keys(NumEdges);
+			for (int32_t i = 0; i < NumEdges; ++i)
+			{
+				const float Weight = std::max(Edges[i].Weight, 0.f);
+				std::memcpy(&Keys[i], &Weight, sizeof(uint32_t));
+			}
+
+			OutOrder.resize(NumEdges);
+			for (int32_t i = 0; i < NumEdges; ++i)
+			{
+				OutOrder[i] = i;
+			}
+
+			std::vector<int32_t> Scratch(NumEdges);
+			for (int32_t Shift = 0; Shift < 32; Shift += 8)
+			{
+				int32_t Counts[257] = {};
+				for (int32_t EdgeIndex : OutOrder)
+				{
+					++Counts[((Keys[EdgeIndex] >> Shift) & 0xFF) + 1];
+				}
+				// Every key has the same byte, nothing to reorder
+				if (Counts[((Keys[0] >> Shift) & 0xFF) + 1] == NumEdges)
+				{
+					continue;
+				}
+				for (int32_t Bucket = 0; Bucket < 256; ++Bucket)
+				{
+					Counts[Bucket + 1] += Counts[Bucket];
+				}
+				for (int32_t EdgeIndex : OutOrder)
+				{
+					Scratch[Counts[(Keys[EdgeIndex] >> Shift) & 0xFF]++] = EdgeIndex;
+				}
+				OutOrder.swap(Scratch);
+			}
+		}
+	}
+
+	void BuildGraphFromEdges(int32_t NumNodes, const std::vector<FLayoutEdge>& Edges, FLayoutGraph& OutGraph)
+	{
+		OutGraph.Edges = Edges;
+		OutGraph.Offsets.assign(NumNodes + 1, 0);
+
+		// Count degrees, prefix sum, then fill both directions of every edge
+		for (const FLayoutEdge& Edge : Edges)
+		{
+			++OutGraph.Offsets[Edge.A + 1];
+			++OutGraph.Offsets[Edge.B + 1];
+		}
+		for (int32_t i = 0; i < NumNodes; ++i)
+		{
+			OutGraph.Offsets[i + 1] += OutGraph.Offsets[i];
+		}
+
+		OutGraph.Neighbors.resize(Edges.size() * 2);
+		OutGraph.Weights.resize(Edges.size() * 2);
+		std::vector<int32_t> Cursor(OutGraph.Offsets.begin(), OutGraph.Offsets.end() - 1);
+		for (const FLayoutEdge& Edge : Edges)
+		{
+			const int32_t SlotA = Cursor[Edge.A]++;
+			OutGraph.Neighbors[SlotA] = Edge.B;
+			OutGraph.Weights[SlotA] = Edge.Weight;
+
+			const int32_t SlotB = Cursor[Edge.B]++;
+			OutGraph.Neighbors[SlotB] = Edge.A;
+			OutGraph.Weights[SlotB] = Edge.Weight;
+		}
+	}
+
+	void BuildRoomGraph(const std::vector<FVec2>& Points, const std::vector<FLayoutTriangle>& Triangles, FLayoutGraph& OutGraph)
+	{
+		const int32_t NumPoints = static_cast<int32_t>(Points.size());
+
+		// Bucket every triangle side by its lower index. Interior sides show up twice, once per triangle.
+		std::vector<int32_t> BucketOffsets(NumPoints + 1, 0);
+		auto ForEachSide = [&Triangles, NumPoints](auto&& Fn)
+		{
+			for (const FLayoutTriangle& Tri : Triangles)
+			{
+				const int32_t Corners[3] = { Tri.A, Tri.B, Tri.C };
+				for (int32_t i = 0; i < 3; ++i)
+				{
+					const int32_t From = Corners[i];
+					const int32_t To = Corners[(i + 1) % 3];
+					if (From >= 0 && To >= 0 && From < NumPoints && To < NumPoints && From != To)
+					{
+						Fn(std::min(From, To), std::max(From, To));
+					}
+				}
+			}
+		};
+		ForEachSide([&BucketOffsets](int32_t Low, int32_t)
+		{
+			++BucketOffsets[Low + 1];
+		});
+		for (int32_t i = 0; i < NumPoints; ++i)
+		{
+			BucketOffsets[i + 1] += BucketOffsets[i];
+		}
+
+		std::vector<int32_t> Buckets(BucketOffsets[NumPoints]);
+		std::vector<int32_t> Cursor(BucketOffsets.begin(), BucketOffsets.end() - 1);
+		ForEachSide([&Buckets, &Cursor](int32_t Low, int32_t High)
+		{
+			Buckets[Cursor[Low]++] = High;
+		});
+
+		// Within a bucket a repeated neighbor was stamped by the same low index
+		std::vector<FLayoutEdge> Edges;
+		Edges.reserve(Buckets.size() / 2 + NumPoints);
+		std::vector<int32_t> LastLow(NumPoints, -1);
+		for (int32_t Low = 0; Low < NumPoints; ++Low)
+		{
+			for (int32_t i = BucketOffsets[Low]; i < BucketOffsets[Low + 1]; ++i)
+			{
+				const int32_t High = Buckets[i];
+				if (LastLow[High] != Low)
+				{
+					LastLow[High] = Low;
+					Edges.push_back(FLayoutEdge(Low, High, static_cast<float>(FVec2::Dist(Points[Low], Points[High]))));
+				}
+			}
+		}
+
+		BuildGraphFromEdges(NumPoints, Edges, OutGraph);
+	}
+
+	void ComputeMinimumSpanningTree(const FLayoutGraph& Graph, std::vector<FLayoutEdge>& OutTree, EMstAlgorithm Algorithm)
+	{
+		switch (Algorithm)
+		{
+		case EMstAlgorithm::Kruskal:
+			ComputeMinimumSpanningTreeKruskal(Graph, OutTree);
+			break;
+		case EMstAlgorithm::Prim:
+		default:
+			ComputeMinimumSpanningTreePrim(Graph, OutTree);
+			break;
+		}
+	}
+
+	void ComputeMinimumSpanningTreePrim(const FLayoutGraph& Graph, std::vector<FLayoutEdge>& OutTree)
+	{
+		OutTree.clear();
+		const int32_t NumNodes = Graph.NumNodes();
+		if (NumNodes == 0)
+		{
+			return;
+		}
+
+		FSpanningTreeHeap Heap(NumNodes);
+		std::vector<float> BestWeight(NumNodes, FLT_MAX);
+		std::vector<int32_t> BestParent(NumNodes, -1);
+		std::vector<uint8_t> InTree(NumNodes, 0);
+		OutTree.reserve(NumNodes - 1);
+
+		// Restarting from every node left out covers disconnected graphs
+		for (int32_t Root = 0; Root < NumNodes; ++Root)
+		{
+			if (InTree[Root])
+			{
+				continue;
+			}
+			BestWeight[Root] = 0.f;
+			Heap.Update(Root, 0.f);
+
+			while (!Heap.IsEmpty())
+			{
+				const int32_t Node = Heap.Pop();
+				InTree[Node] = 1;
+				if (BestParent[Node] >= 0)
+				{
+					OutTree.push_back(FLayoutEdge(BestParent[Node], Node, BestWeight[Node]));
+				}
+
+				for (int32_t i = Graph.Offsets[Node]; i < Graph.Offsets[Node + 1]; ++i)
+				{
+					const int32_t Neighbor = Graph.Neighbors[i];
+					const float Weight = Graph.Weights[i];
+					if (!InTree[Neighbor] && Weight < BestWeight[Neighbor])
+					{
+						BestWeight[Neighbor] = Weight;
+						BestParent[Neighbor] = Node;
+						Heap.Update(Neighbor, Weight);
+					}
+				}
+			}
+		}
+	}
+
+	void ComputeMinimumSpanningTreeKruskal(const FLayoutGraph& Graph, std::vector<FLayoutEdge>& OutTree)
+	{
+		OutTree.clear();
+		const int32_t NumNodes = Graph.NumNodes();
+		if (NumNodes == 0)
+		{
+			return;
+		}
+
+		std::vector<int32_t> Order;
+		RadixSortEdgesByWeight(Graph.Edges, Order);
+
+		FSpanningTreeUnionFind Sets(NumNodes);
+		OutTree.reserve(NumNodes - 1);
+		for (int32_t EdgeIndex : Order)
+		{
+			const FLayoutEdge& Edge = Graph.Edges[EdgeIndex];
+			if (Sets.Union(Edge.A, Edge.B))
+			{
+				OutTree.push_back(Edge);
+				if (static_cast<int32_t>(OutTree.size()) == NumNodes - 1)
+				{
+					break;
+				}
+			}
+		}
+	}
+}
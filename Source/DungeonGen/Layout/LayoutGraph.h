@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LayoutTypes.h"
+
+namespace DungeonLayout
+{
+	// Undirected room graph in compressed sparse row form. The neighbors of node i are
+	// Neighbors[Offsets[i]] .. Neighbors[Offsets[i + 1] - 1], Weights runs parallel to Neighbors.
+	struct FLayoutGraph
+	{
+		std::vector<int32_t> Offsets;
+		std::vector<int32_t> Neighbors;
+		std::vector<float> Weights;
+		// Every edge once, A < B
+		std::vector<FLayoutEdge> Edges;
+
+		int32_t NumNodes() const
+		{
+			return Offsets.empty() ? 0 : static_cast<int32_t>(Offsets.size()) - 1;
+		}
+
+		int32_t NumEdges() const
+		{
+			return static_cast<int32_t>(Edges.size());
+		}
+	};
+
+	// Builds the adjacency of NumNodes nodes from deduplicated edges
+	void BuildGraphFromEdges(int32_t NumNodes, const std::vector<FLayoutEdge>& Edges, FLayoutGraph& OutGraph);
+
+	// Connects the points sharing a triangle edge, weighted by distance. Linear in the number of triangles:
+	// edges are bucketed by their lower index and deduplicated per bucket.
+	void BuildRoomGraph(const std::vector<FVec2>& Points, const std::vector<FLayoutTriangle>& Triangles, FLayoutGraph& OutGraph);
+
+	// Minimum spanning tree, edges use point indices. A disconnected graph gives a spanning forest.
+	// Both algorithms give a tree of the same total weight, equal weights may be broken differently.
+	void ComputeMinimumSpanningTree(const FLayoutGraph& Graph, std::vector<FLayoutEdge>& OutTree, EMstAlgorithm Algorithm = EMstAlgorithm::Kruskal);
+
+	// Prim's algorithm on an indexed 4-ary heap. Edges point from the tree to the node they add.
+	void ComputeMinimumSpanningTreePrim(const FLayoutGraph& Graph, std::vector<FLayoutEdge>& OutTree);
+
+	// Kruskal's algorithm: edges radix sorted by weight, cycles rejected with union-find
+	void ComputeMinimumSpanningTreeKruskal(const FLayoutGraph& Graph, std::vector<FLayoutEdge>& OutTree);
+}
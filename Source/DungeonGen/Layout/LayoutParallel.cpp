@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutParallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		std::atomic<FParallelForHook> GParallelForHook(nullptr);
+		std::atomic<int32_t> GNumWorkerThreads(0);
+
+		void RunTasksOnThreads(int32_t NumTasks, const std::function<void(int32_t)>& Task)
+		{
+			const int32_t NumThreads = std::min(GetNumWorkerThreads(), NumTasks);
+
+			std::atomic<int32_t> NextTask(0);
+			auto Worker = [&NextTask, &Task, NumTasks]()
+			{
+				for (int32_t TaskIndex = NextTask++; TaskIndex < NumTasks; TaskIndex = NextTask++)
+				{
+					Task(TaskIndex);
+				}
+			};
+
+			// The calling thread works too
+			std::vector<std::thread> Threads;
+			for (int32_t i = 1; i < NumThreads; ++i)
+			{
+				Threads.emplace_back(Worker);
+			}
+			Worker();
+
+			for (std::thread& Thread : Threads)
+			{
+				Thread.join();
+			}
+		}
+	}
+
+	void SetParallelForHook(FParallelForHook Hook)
+	{
+		GParallelForHook = Hook;
+	}
+
+	void SetNumWorkerThreads(int32_t NumThreads)
+	{
+		GNumWorkerThreads = std::max(NumThreads, 0);
+	}
+
+	int32_t GetNumWorkerThreads()
+	{
+		const int32_t NumThreads = GNumWorkerThreads;
+		if (NumThreads > 0)
+		{
+			return NumThreads;
+		}
+		return std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 1);
+	}
+
+	void ParallelForRange(int32_t Num, int32_t MinBatchSize, const std::function<void(int32_t Begin, int32_t End)>& Body)
+	{
+		if (Num <= 0)
+		{
+			return;
+		}
+
+		const FParallelForHook Hook = GParallelForHook;
+		const int32_t MaxTasks = Hook ? 64 : GetNumWorkerThreads() * 4;
+		const int32_t NumTasks = std::max(std::min((Num + MinBatchSize - 1) / std::max(MinBatchSize, 1), MaxTasks), 1);
+		if (NumTasks == 1 || (!Hook && GetNumWorkerThreads() == 1))
+		{
+			Body(0, Num);
+			return;
+		}
+
+		const int32_t BatchSize = (Num + NumTasks - 1) / NumTasks;
+		auto Task = [&Body, Num, BatchSize](int32_t TaskIndex)
+		{
+			const int32_t Begin = TaskIndex * BatchSize;
+			const int32_t End = std::min(Begin + BatchSize, Num);
+			if (Begin < End)
+			{
+				Body(Begin, End);
+			}
+		};
+
+		if (Hook)
+		{
+			Hook(NumTasks, Task);
+		}
+		else
+		{
+			RunTasksOnThreads(NumTasks, Task);
+		}
+	}
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace DungeonLayout
+{
+	// Runs Task(0) .. Task(NumTasks - 1), possibly concurrently, and returns once all of them are done
+	using FParallelForHook = void (*)(int32_t NumTasks, const std::function<void(int32_t)>& Task);
+
+	// Lets the host route layout work to its own scheduler (the DungeonGen module uses ParallelFor).
+	// Without a hook, tasks run on short lived std::threads. nullptr restores the default.
+	void SetParallelForHook(FParallelForHook Hook);
+
+	// Worker count of the default std::thread implementation, defaults to the hardware concurrency
+	void SetNumWorkerThreads(int32_t NumThreads);
+	int32_t GetNumWorkerThreads();
+
+	// Splits [0, Num) in contiguous ranges of at least MinBatchSize and calls Body(Begin, End) for each.
+	// Bodies must only write to data owned by their range for the result to be independent of the thread count.
+	void ParallelForRange(int32_t Num, int32_t MinBatchSize, const std::function<void(int32_t Begin, int32_t End)>& Body);
+}
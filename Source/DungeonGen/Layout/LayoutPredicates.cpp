@@ -0,0 +1,333 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutPredicates.h"
+
+#include <cmath>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		// Half an ulp of 1, the relative rounding error of one operation
+		constexpr double PredicateEpsilon = 1.1102230246251565e-16;
+		constexpr double Orient2DErrorBound = (3.0 + 16.0 * PredicateEpsilon) * PredicateEpsilon;
+		constexpr double InCircleErrorBound = (10.0 + 96.0 * PredicateEpsilon) * PredicateEpsilon;
+
+		// Upper bounds of the expansion lengths below, a product of M and N components has at most 2MN
+		constexpr int32_t MaxProductLength = 8;
+		constexpr int32_t MaxMinorLength = 2 * MaxProductLength;
+		constexpr int32_t MaxLiftedLength = 2 * MaxMinorLength * MaxMinorLength;
+
+		// A + B = Sum + Error exactly
+		inline void TwoSum(double A, double B, double& Sum, double& Error)
+		{
+			Sum = A + B;
+			const double BVirtual = Sum - A;
+			const double AVirtual = Sum - BVirtual;
+			Error = (A - AVirtual) + (B - BVirtual);
+		}
+
+		inline void TwoDiff(double A, double B, double& Difference, double& Error)
+		{
+			TwoSum(A, -B, Difference, Error);
+		}
+
+		// A * B = Product + Error exactly
+		inline void TwoProduct(double A, double B, double& Product, double& Error)
+		{
+			Product = A * B;
+			Error = std::fma(A, B, -Product);
+		}
+
+		// Expansions are arrays of non overlapping components sorted by increasing magnitude, zeros removed.
+		// H = E + F, H has room for ELength + FLength components. Returns the length of H.
+		int32_t ExpansionSum(int32_t ELength, const double* E, int32_t FLength, const double* F, double* H)
+		{
+			if (ELength == 0 || FLength == 0)
+			{
+				const int32_t Length = ELength + FLength;
+				const double* Source = ELength == 0 ? F : E;
+				for (int32_t i = 0; i < Length; ++i)
+				{
+					H[i] = Source[i];
+				}
+				return Length;
+			}
+
+			// Merge by magnitude, then accumulate (Shewchuk's fast_expansion_sum_zeroelim)
+			int32_t EIndex = 0;
+			int32_t FIndex = 0;
+			double ENow = E[0];
+			double FNow = F[0];
+			double Q;
+			if ((FNow > ENow) == (FNow > -ENow))
+			{
+				Q = ENow;
+				ENow = ++EIndex < ELength ? E[EIndex] : 0;
+			}
+			else
+			{
+				Q = FNow;
+				FNow = ++FIndex < FLength ? F[FIndex] : 0;
+			}
+
+			int32_t HIndex = 0;
+			double QNew;
+			double HH;
+			while (EIndex < ELength && FIndex < FLength)
+			{
+				if ((FNow > ENow) == (FNow > -ENow))
+				{
+					TwoSum(Q, ENow, QNew, HH);
+					ENow = ++EIndex < ELength ? E[EIndex] : 0;
+				}
+				else
+				{
+					TwoSum(Q, FNow, QNew, HH);
+					FNow = ++FIndex < FLength ? F[FIndex] : 0;
+				}
+				Q = QNew;
+				if (HH != 0)
+				{
+					H[HIndex++] = HH;
+				}
+			}
+			while (EIndex < ELength)
+			{
+				TwoSum(Q, ENow, QNew, HH);
+				ENow = ++EIndex < ELength ? E[EIndex] : 0;
+				Q = QNew;
+				if (HH != 0)
+				{
+					H[HIndex++] = HH;
+				}
+			}
+			while (FIndex < FLength)
+			{
+				TwoSum(Q, FNow, QNew, HH);
+				FNow = ++FIndex < FLength ? F[FIndex] : 0;
+				Q = QNew;
+				if (HH != 0)
+				{
+					H[HIndex++] = HH;
+				}
+			}
+			if (Q != 0 || HIndex == 0)
+			{
+				H[HIndex++] = Q;
+			}
+			return HIndex;
+		}
+
+		// H = E * B, H has room for 2 * ELength components (Shewchuk's scale_expansion_zeroelim)
+		int32_t ScaleExpansion(int32_t ELength, const double* E, double B, double* H)
+		{
+			int32_t HIndex = 0;
+			double Q;
+			double HH;
+			TwoProduct(E[0], B, Q, HH);
+			if (HH != 0)
+			{
+				H[HIndex++] = HH;
+			}
+			for (int32_t i = 1; i < ELength; ++i)
+			{
+				double Product;
+				double ProductError;
+				TwoProduct(E[i], B, Product, ProductError);
+				double Sum;
+				TwoSum(Q, ProductError, Sum, HH);
+				if (HH != 0)
+				{
+					H[HIndex++] = HH;
+				}
+				TwoSum(Product, Sum, Q, HH);
+				if (HH != 0)
+				{
+					H[HIndex++] = HH;
+				}
+			}
+			if (Q != 0 || HIndex == 0)
+			{
+				H[HIndex++] = Q;
+			}
+			return HIndex;
+		}
+
+		// H = E * F, H has room for 2 * ELength * FLength components
+		int32_t MultiplyExpansions(int32_t ELength, const double* E, int32_t FLength, const double* F, double* H, double* Scratch)
+		{
+			int32_t HLength = 0;
+			double Scaled[2 * MaxMinorLength];
+			for (int32_t i = 0; i < FLength; ++i)
+			{
+				const int32_t ScaledLength = ScaleExpansion(ELength, E, F[i], Scaled);
+				const int32_t SumLength = ExpansionSum(HLength, H, ScaledLength, Scaled, Scratch);
+				for (int32_t k = 0; k < SumLength; ++k)
+				{
+					H[k] = Scratch[k];
+				}
+				HLength = SumLength;
+			}
+			return HLength;
+		}
+
+		// Exact A - B as a two component expansion
+		inline int32_t DifferenceExpansion(double A, double B, double* H)
+		{
+			double Difference;
+			double Error;
+			TwoDiff(A, B, Difference, Error);
+			int32_t Length = 0;
+			if (Error != 0)
+			{
+				H[Length++] = Error;
+			}
+			if (Difference != 0 || Length == 0)
+			{
+				H[Length++] = Difference;
+			}
+			return Length;
+		}
+
+		// Exact (A * D) - (B * C) of two component expansions, H has room for MaxMinorLength components
+		int32_t CrossExpansion(int32_t ALength, const double* A, int32_t BLength, const double* B,
+			int32_t CLength, const double* C, int32_t DLength, const double* D, double* H)
+		{
+			double AD[MaxProductLength];
+			double BC[MaxProductLength];
+			double Scratch[MaxProductLength];
+			const int32_t ADLength = MultiplyExpansions(ALength, A, DLength, D, AD, Scratch);
+			int32_t BCLength = MultiplyExpansions(BLength, B, CLength, C, BC, Scratch);
+			for (int32_t i = 0; i < BCLength; ++i)
+			{
+				BC[i] = -BC[i];
+			}
+			return ExpansionSum(ADLength, AD, BCLength, BC, H);
+		}
+
+		// Sign carrying approximation of an expansion, its largest component
+		inline double Estimate(int32_t Length, const double* E)
+		{
+			return E[Length - 1];
+		}
+	}
+
+	double Orient2DExact(const FVec2& A, const FVec2& B, const FVec2& C)
+	{
+		// (A - C) x (B - C)
+		double ACX[2], ACY[2], BCX[2], BCY[2];
+		const int32_t ACXLength = DifferenceExpansion(A.X, C.X, ACX);
+		const int32_t ACYLength = DifferenceExpansion(A.Y, C.Y, ACY);
+		const int32_t BCXLength = DifferenceExpansion(B.X, C.X, BCX);
+		const int32_t BCYLength = DifferenceExpansion(B.Y, C.Y, BCY);
+
+		double Determinant[MaxMinorLength];
+		const int32_t Length = CrossExpansion(ACXLength, ACX, ACYLength, ACY, BCXLength, BCX, BCYLength, BCY, Determinant);
+		return Estimate(Length, Determinant);
+	}
+
+	double Orient2D(const FVec2& A, const FVec2& B, const FVec2& C)
+	{
+		const double DetLeft = (A.X - C.X) * (B.Y - C.Y);
+		const double DetRight = (A.Y - C.Y) * (B.X - C.X);
+		const double Det = DetLeft - DetRight;
+
+		// Terms of opposite signs can't cancel, the sign of Det is right
+		double DetSum;
+		if (DetLeft > 0)
+		{
+			if (DetRight <= 0)
+			{
+				return Det;
+			}
+			DetSum = DetLeft + DetRight;
+		}
+		else if (DetLeft < 0)
+		{
+			if (DetRight >= 0)
+			{
+				return Det;
+			}
+			DetSum = -DetLeft - DetRight;
+		}
+		else
+		{
+			return Det;
+		}
+
+		if (std::fabs(Det) >= Orient2DErrorBound * DetSum)
+		{
+			return Det;
+		}
+		return Orient2DExact(A, B, C);
+	}
+
+	double InCircleExact(const FVec2& A, const FVec2& B, const FVec2& C, const FVec2& D)
+	{
+		double ADX[2], ADY[2], BDX[2], BDY[2], CDX[2], CDY[2];
+		const int32_t ADXLength = DifferenceExpansion(A.X, D.X, ADX);
+		const int32_t ADYLength = DifferenceExpansion(A.Y, D.Y, ADY);
+		const int32_t BDXLength = DifferenceExpansion(B.X, D.X, BDX);
+		const int32_t BDYLength = DifferenceExpansion(B.Y, D.Y, BDY);
+		const int32_t CDXLength = DifferenceExpansion(C.X, D.X, CDX);
+		const int32_t CDYLength = DifferenceExpansion(C.Y, D.Y, CDY);
+
+		// 2x2 minors
+		double BC[MaxMinorLength], CA[MaxMinorLength], AB[MaxMinorLength];
+		const int32_t BCLength = CrossExpansion(BDXLength, BDX, BDYLength, BDY, CDXLength, CDX, CDYLength, CDY, BC);
+		const int32_t CALength = CrossExpansion(CDXLength, CDX, CDYLength, CDY, ADXLength, ADX, ADYLength, ADY, CA);
+		const int32_t ABLength = CrossExpansion(ADXLength, ADX, ADYLength, ADY, BDXLength, BDX, BDYLength, BDY, AB);
+
+		// Squared distances to D
+		auto Lift = [](int32_t XLength, const double* X, int32_t YLength, const double* Y, double* H)
+		{
+			double XX[MaxProductLength], YY[MaxProductLength], Scratch[MaxProductLength];
+			const int32_t XXLength = MultiplyExpansions(XLength, X, XLength, X, XX, Scratch);
+			const int32_t YYLength = MultiplyExpansions(YLength, Y, YLength, Y, YY, Scratch);
+			return ExpansionSum(XXLength, XX, YYLength, YY, H);
+		};
+		double ALift[MaxMinorLength], BLift[MaxMinorLength], CLift[MaxMinorLength];
+		const int32_t ALiftLength = Lift(ADXLength, ADX, ADYLength, ADY, ALift);
+		const int32_t BLiftLength = Lift(BDXLength, BDX, BDYLength, BDY, BLift);
+		const int32_t CLiftLength = Lift(CDXLength, CDX, CDYLength, CDY, CLift);
+
+		// ALift * BC + BLift * CA + CLift * AB
+		double Scratch[MaxLiftedLength * 3];
+		double ATerm[MaxLiftedLength], BTerm[MaxLiftedLength], CTerm[MaxLiftedLength];
+		const int32_t ATermLength = MultiplyExpansions(ALiftLength, ALift, BCLength, BC, ATerm, Scratch);
+		const int32_t BTermLength = MultiplyExpansions(BLiftLength, BLift, CALength, CA, BTerm, Scratch);
+		const int32_t CTermLength = MultiplyExpansions(CLiftLength, CLift, ABLength, AB, CTerm, Scratch);
+
+		double ABTerm[MaxLiftedLength * 2];
+		const int32_t ABTermLength = ExpansionSum(ATermLength, ATerm, BTermLength, BTerm, ABTerm);
+		const int32_t Length = ExpansionSum(ABTermLength, ABTerm, CTermLength, CTerm, Scratch);
+		return Estimate(Length, Scratch);
+	}
+
+	double InCircle(const FVec2& A, const FVec2& B, const FVec2& C, const FVec2& D)
+	{
+		const double ADX = A.X - D.X, ADY = A.Y - D.Y;
+		const double BDX = B.X - D.X, BDY = B.Y - D.Y;
+		const double CDX = C.X - D.X, CDY = C.Y - D.Y;
+
+		const double BDXCDY = BDX * CDY, CDXBDY = CDX * BDY;
+		const double CDXADY = CDX * ADY, ADXCDY = ADX * CDY;
+		const double ADXBDY = ADX * BDY, BDXADY = BDX * ADY;
+
+		const double ALift = ADX * ADX + ADY * ADY;
+		const double BLift = BDX * BDX + BDY * BDY;
+		const double CLift = CDX * CDX + CDY * CDY;
+
+		const double Det = ALift * (BDXCDY - CDXBDY) + BLift * (CDXADY - ADXCDY) + CLift * (ADXBDY - BDXADY);
+		const double Permanent = (std::fabs(BDXCDY) + std::fabs(CDXBDY)) * ALift
+			+ (std::fabs(CDXADY) + std::fabs(ADXCDY)) * BLift
+			+ (std::fabs(ADXBDY) + std::fabs(BDXADY)) * CLift;
+
+		if (std::fabs(Det) > InCircleErrorBound * Permanent)
+		{
+			return Det;
+		}
+		return InCircleExact(A, B, C, D);
+	}
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LayoutTypes.h"
+
+namespace DungeonLayout
+{
+	// Geometric predicates with exact signs, after Shewchuk's "Adaptive Precision Floating-Point Arithmetic and
+	// Fast Robust Geometric Predicates". The plain floating point determinant is returned whenever its error
+	// bound proves the sign, otherwise the determinant is evaluated exactly with floating point expansions.
+	// Only the sign of the result is meaningful.
+
+	// > 0 when A, B, C are counter clockwise, < 0 when clockwise, 0 when colinear
+	double Orient2D(const FVec2& A, const FVec2& B, const FVec2& C);
+
+	// > 0 when D is inside the circumcircle of the counter clockwise triangle ABC, < 0 outside, 0 on it.
+	// The sign is flipped for a clockwise triangle.
+	double InCircle(const FVec2& A, const FVec2& B, const FVec2& C, const FVec2& D);
+
+	// Same predicates without the filter, always exact. Exposed for tests.
+	double Orient2DExact(const FVec2& A, const FVec2& B, const FVec2& C);
+	double InCircleExact(const FVec2& A, const FVec2& B, const FVec2& C, const FVec2& D);
+}
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+
+namespace DungeonLayout
+{
+	// Substreams of the layout seed, one per pipeline stage that draws random numbers
+	enum class ELayoutStream : uint64_t
+	{
+		Scatter = 1,
+		// Seeds of the chunks of an unbounded dungeon, see LayoutChunks.h
+		Chunk = 2
+	};
+
+	// Small self contained generator (splitmix64) so the layout does not depend on the global FMath stream.
+	// Split derives independent substreams, so what a stage or a room draws never depends on how much
+	// was drawn before it, nor on which thread or frame draws it.
+	class FLayoutRandom
+	{
+	public:
+		explicit FLayoutRandom(uint64_t InSeed = 0) : State(InSeed) {}
+
+		uint64_t NextUInt64()
+		{
+			return Mix(State += 0x9E3779B97F4A7C15ull);
+		}
+
+		// Generator for substream StreamId, leaves this one untouched
+		FLayoutRandom Split(uint64_t StreamId) const
+		{
+			return FLayoutRandom(Mix(State ^ Mix(StreamId + 0xD1B54A32D192ED03ull)));
+		}
+
+		FLayoutRandom Split(ELayoutStream Stream) const
+		{
+			return Split(static_cast<uint64_t>(Stream));
+		}
+
+		// Uniform in [0, 1)
+		double FRand()
+		{
+			return (NextUInt64() >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+		// Uniform in [Min, Max)
+		double FRandRange(double Min, double Max)
+		{
+			return Min + (Max - Min) * FRand();
+		}
+
+	private:
+		static uint64_t Mix(uint64_t Z)
+		{
+			Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBull;
+			return Z ^ (Z >> 31);
+		}
+
+		uint64_t State;
+	};
+}
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutReplication.h"
+
+#include "DungeonLayout.h"
+
+#include <cstring>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		// FNV-1a, fed value by value so padding never reaches the hash
+		class FLayoutHasher
+		{
+		public:
+			template <typename T>
+			void Add(const T& Value)
+			{
+				uint8_t Bytes[sizeof(T)];
+				std::memcpy(Bytes, &Value, sizeof(T));
+				for (uint8_t Byte : Bytes)
+				{
+					Hash = (Hash ^ Byte) * 0x100000001B3ull;
+				}
+			}
+
+			void Add(const FVec2& Value)
+			{
+				Add(Value.X);
+				Add(Value.Y);
+			}
+
+			uint64_t Get() const { return Hash; }
+
+		private:
+			uint64_t Hash = 0xCBF29CE484222325ull;
+		};
+
+		bool IsSameRoom(const FLayoutRoom& A, const FLayoutRoom& B)
+		{
+			return A.Center == B.Center && A.HalfExtents == B.HalfExtents && A.Area == B.Area;
+		}
+	}
+
+	uint64_t ComputeLayoutChecksum(const FDungeonLayout& Layout)
+	{
+		FLayoutHasher Hasher;
+		Hasher.Add(static_cast<uint64_t>(Layout.Rooms.size()));
+		for (const FLayoutRoom& Room : Layout.Rooms)
+		{
+			Hasher.Add(Room.Center);
+			Hasher.Add(Room.HalfExtents);
+			Hasher.Add(Room.Area);
+		}
+		Hasher.Add(static_cast<uint64_t>(Layout.SelectedRooms.size()));
+		for (int32_t RoomIndex : Layout.SelectedRooms)
+		{
+			Hasher.Add(RoomIndex);
+		}
+		Hasher.Add(static_cast<uint64_t>(Layout.CorridorRooms.size()));
+		for (int32_t RoomIndex : Layout.CorridorRooms)
+		{
+			Hasher.Add(RoomIndex);
+		}
+		Hasher.Add(static_cast<uint64_t>(Layout.MinimumSpanningTree.size()));
+		for (const FLayoutEdge& Edge : Layout.MinimumSpanningTree)
+		{
+			Hasher.Add(Edge.A);
+			Hasher.Add(Edge.B);
+		}
+		Hasher.Add(static_cast<uint64_t>(Layout.Corridors.size()));
+		for (const FCorridorSegment& Segment : Layout.Corridors)
+		{
+			Hasher.Add(Segment.Start);
+			Hasher.Add(Segment.End);
+			Hasher.Add(Segment.EdgeIndex);
+		}
+		return Hasher.Get();
+	}
+
+	bool ComputeLayoutDelta(const FDungeonLayout& Expected, const FDungeonLayout& Actual, FLayoutDelta& OutDelta)
+	{
+		OutDelta.Rooms.clear();
+		if (Expected.Rooms.size() != Actual.Rooms.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < Actual.Rooms.size(); ++i)
+		{
+			const FLayoutRoom& Room = Actual.Rooms[i];
+			if (!IsSameRoom(Expected.Rooms[i], Room))
+			{
+				FLayoutRoomCorrection Correction;
+				Correction.Room = static_cast<int32_t>(i);
+				Correction.Center = Room.Center;
+				Correction.HalfExtents = Room.HalfExtents;
+				Correction.Area = Room.Area;
+				OutDelta.Rooms.push_back(Correction);
+			}
+		}
+		return true;
+	}
+
+	bool ApplyLayoutDelta(const FLayoutDelta& Delta, const FLayoutParams& Params, FDungeonLayout& InOutLayout)
+	{
+		for (const FLayoutRoomCorrection& Correction : Delta.Rooms)
+		{
+			if (Correction.Room < 0 || static_cast<size_t>(Correction.Room) >= InOutLayout.Rooms.size())
+			{
+				return false;
+			}
+		}
+		if (Delta.IsEmpty())
+		{
+			return true;
+		}
+
+		for (const FLayoutRoomCorrection& Correction : Delta.Rooms)
+		{
+			FLayoutRoom& Room = InOutLayout.Rooms[Correction.Room];
+			Room.Center = Correction.Center;
+			Room.HalfExtents = Correction.HalfExtents;
+			Room.Area = Correction.Area;
+		}
+		FinishDungeonLayout(Params, InOutLayout);
+		return true;
+	}
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// What a client needs besides FLayoutParams to rebuild the server's dungeon: a checksum to verify it and the
+// rooms to correct when the server's layout is not exactly what the parameters generate.
+
+#include "LayoutTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace DungeonLayout
+{
+	// FNV-1a over the rooms, selections, spanning tree and corridors, bit exact. Triangles are left out.
+	uint64_t ComputeLayoutChecksum(const FDungeonLayout& Layout);
+
+	struct FLayoutRoomCorrection
+	{
+		int32_t Room = -1;
+		FVec2 Center;
+		FVec2 HalfExtents;
+		float Area = 0.f;
+	};
+
+	// Rooms to override, in room order. Everything else follows from the rooms.
+	struct FLayoutDelta
+	{
+		std::vector<FLayoutRoomCorrection> Rooms;
+
+		bool IsEmpty() const { return Rooms.empty(); }
+	};
+
+	// Rooms of Actual that differ from Expected. False when the room counts differ, no delta can describe that.
+	bool ComputeLayoutDelta(const FDungeonLayout& Expected, const FDungeonLayout& Actual, FLayoutDelta& OutDelta);
+
+	// Overrides the corrected rooms of InOutLayout, then redoes selection, graph and corridors with Params.
+	// False, with InOutLayout untouched, when a correction names a room InOutLayout does not have.
+	bool ApplyLayoutDelta(const FLayoutDelta& Delta, const FLayoutParams& Params, FDungeonLayout& InOutLayout);
+}
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutRoomGrid.h"
+
+namespace DungeonLayout
+{
+	void FRoomQueryGrid::Build(const std::vector<FLayoutRoom>& Rooms)
+	{
+		CellStarts.clear();
+		CellRooms.clear();
+		Width = 0;
+		Height = 0;
+		if (Rooms.empty())
+		{
+			return;
+		}
+
+		FVec2 Min = Rooms[0].Min();
+		FVec2 Max = Rooms[0].Max();
+		double MaxRoomSize = 0.0;
+		for (const FLayoutRoom& Room : Rooms)
+		{
+			Min = FVec2(std::min(Min.X, Room.Min().X), std::min(Min.Y, Room.Min().Y));
+			Max = FVec2(std::max(Max.X, Room.Max().X), std::max(Max.Y, Room.Max().Y));
+			MaxRoomSize = std::max(MaxRoomSize, 2.0 * std::max(Room.HalfExtents.X, Room.HalfExtents.Y));
+		}
+
+		// A room overlaps at most 2x2 cells, and about one cell per room keeps the table small for sparse layouts
+		const FVec2 Size = Max - Min;
+		const double CellSizeForCount = std::sqrt(Size.X * Size.Y / static_cast<double>(Rooms.size()));
+		CellSize = std::max(std::max(MaxRoomSize, CellSizeForCount), 1.e-3);
+		InvCellSize = 1.0 / CellSize;
+		Origin = Min;
+		Width = static_cast<int32_t>(Size.X * InvCellSize) + 1;
+		Height = static_cast<int32_t>(Size.Y * InvCellSize) + 1;
+		while (static_cast<double>(Width) * Height > 4.0 * static_cast<double>(Rooms.size()) + 16.0)
+		{
+			// Rooms strung along a line, the area estimate says nothing
+			CellSize *= 2.0;
+			InvCellSize = 1.0 / CellSize;
+			Width = static_cast<int32_t>(Size.X * InvCellSize) + 1;
+			Height = static_cast<int32_t>(Size.Y * InvCellSize) + 1;
+		}
+
+		// Count, exclusive prefix sum, then scatter rooms in index order
+		const int32_t NumGridCells = Width * Height;
+		CellStarts.assign(NumGridCells + 1, 0);
+		auto ForEachRoomCell = [this](const FLayoutRoom& Room, auto&& Fn)
+		{
+			const int32_t MinX = ClampCell((Room.Min().X - Origin.X) * InvCellSize, Width);
+			const int32_t MinY = ClampCell((Room.Min().Y - Origin.Y) * InvCellSize, Height);
+			const int32_t MaxX = ClampCell((Room.Max().X - Origin.X) * InvCellSize, Width);
+			const int32_t MaxY = ClampCell((Room.Max().Y - Origin.Y) * InvCellSize, Height);
+			for (int32_t Y = MinY; Y <= MaxY; ++Y)
+			{
+				for (int32_t X = MinX; X <= MaxX; ++X)
+				{
+					Fn(Y * Width + X);
+				}
+			}
+		};
+
+		for (const FLayoutRoom& Room : Rooms)
+		{
+			ForEachRoomCell(Room, [this](int32_t Cell) { ++CellStarts[Cell]; });
+		}
+		int32_t Running = 0;
+		for (int32_t& Start : CellStarts)
+		{
+			const int32_t Count = Start;
+			Start = Running;
+			Running += Count;
+		}
+
+		CellRooms.resize(Running);
+		std::vector<int32_t> Cursor(CellStarts.begin(), CellStarts.end() - 1);
+		for (int32_t i = 0; i < static_cast<int32_t>(Rooms.size()); ++i)
+		{
+			ForEachRoomCell(Rooms[i], [this, &Cursor, i](int32_t Cell) { CellRooms[Cursor[Cell]++] = i; });
+		}
+	}
+}
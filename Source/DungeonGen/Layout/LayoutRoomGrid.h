@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LayoutTypes.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DungeonLayout
+{
+	// Uniform grid over room rectangles for area queries. Unlike FRoomSpatialHash, which buckets centers for the
+	// separation broadphase, a room is stored in every cell its rectangle overlaps, so a query only has to look at
+	// the cells it covers. Dense, sized from the room bounds; cells are at least as large as the biggest room.
+	class FRoomQueryGrid
+	{
+	public:
+		// O(N), the cell count stays within a small multiple of the room count
+		void Build(const std::vector<FLayoutRoom>& Rooms);
+
+		// Calls Fn(RoomIndex) for every room stored in a cell overlapped by [Min, Max]. A room spanning several
+		// of those cells comes once per cell, and rooms only near the box come too: test the candidates.
+		template <typename FunctionType>
+		void ForEachCandidate(const FVec2& Min, const FVec2& Max, FunctionType&& Fn) const
+		{
+			if (CellStarts.empty())
+			{
+				return;
+			}
+
+			const int32_t MinX = ClampCell((Min.X - Origin.X) * InvCellSize, Width);
+			const int32_t MinY = ClampCell((Min.Y - Origin.Y) * InvCellSize, Height);
+			const int32_t MaxX = ClampCell((Max.X - Origin.X) * InvCellSize, Width);
+			const int32_t MaxY = ClampCell((Max.Y - Origin.Y) * InvCellSize, Height);
+			for (int32_t Y = MinY; Y <= MaxY; ++Y)
+			{
+				for (int32_t X = MinX; X <= MaxX; ++X)
+				{
+					const int32_t Cell = Y * Width + X;
+					for (int32_t i = CellStarts[Cell], End = CellStarts[Cell + 1]; i < End; ++i)
+					{
+						Fn(CellRooms[i]);
+					}
+				}
+			}
+		}
+
+		int32_t GetWidth() const { return Width; }
+		int32_t GetHeight() const { return Height; }
+		double GetCellSize() const { return CellSize; }
+
+	private:
+		static int32_t ClampCell(double Coord, int32_t Size)
+		{
+			return static_cast<int32_t>(std::min(std::max(std::floor(Coord), 0.0), static_cast<double>(Size - 1)));
+		}
+
+		FVec2 Origin;
+		double CellSize = 1.0;
+		double InvCellSize = 1.0;
+		int32_t Width = 0;
+		int32_t Height = 0;
+
+		// Rooms grouped by cell, CellRooms[CellStarts[c] .. CellStarts[c + 1]) overlap cell c
+		std::vector<int32_t> CellStarts;
+		std::vector<int32_t> CellRooms;
+	};
+}
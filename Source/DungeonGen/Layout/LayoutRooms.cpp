@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutRooms.h"
+
+#include <algorithm>
+
+namespace DungeonLayout
+{
+	FVec2 GetRandomPointInCircle(FLayoutRandom& Random, double Radius, const FVec2& Center)
+	{
+		const double R = Radius * std::sqrt(Random.FRand());
+		const double Theta = Random.FRand() * 2.0 * 3.14159265358979323846;
+
+		return Center + FVec2(R * std::cos(Theta), R * std::sin(Theta));
+	}
+
+	void ScatterRooms(const FLayoutParams& Params, const FLayoutRandom& Random, std::vector<FLayoutRoom>& OutRooms)
+	{
+		OutRooms.clear();
+		OutRooms.reserve(Params.RoomsToSpawn > 0 ? Params.RoomsToSpawn : 0);
+
+		for (int32_t i = 0; i < Params.RoomsToSpawn; ++i)
+		{
+			// Room i is the same whatever the room count
+			FLayoutRandom RoomRandom = Random.Split(static_cast<uint64_t>(i));
+
+			FLayoutRoom Room;
+			Room.Id = i;
+			Room.Center = GetRandomPointInCircle(RoomRandom, Params.GenerationRadius, Params.GenerationCenter);
+
+			// Rooms are scaled by whole units, like the actors used to be
+			const int32_t ScaleX = static_cast<int32_t>(RoomRandom.FRandRange(Params.RoomSizeMin, Params.RoomSizeMax));
+			const int32_t ScaleY = static_cast<int32_t>(RoomRandom.FRandRange(Params.RoomSizeMin, Params.RoomSizeMax));
+
+			Room.HalfExtents = FVec2(ScaleX * Params.RoomUnitSize * 0.5, ScaleY * Params.RoomUnitSize * 0.5);
+			Room.Area = static_cast<float>(ScaleX * ScaleY);
+			OutRooms.push_back(Room);
+		}
+	}
+
+	void ScatterRooms(const FLayoutParams& Params, std::vector<FLayoutRoom>& OutRooms)
+	{
+		ScatterRooms(Params, FLayoutRandom(Params.Seed).Split(ELayoutStream::Scatter), OutRooms);
+	}
+
+	void SelectBiggestRooms(const std::vector<FLayoutRoom>& Rooms, int32_t NumberOfBiggestRooms, std::vector<int32_t>& OutSelected)
+	{
+		OutSelected.clear();
+
+		std::vector<int32_t> SortedRooms(Rooms.size());
+		for (int32_t i = 0; i < static_cast<int32_t>(Rooms.size()); ++i)
+		{
+			SortedRooms[i] = i;
+		}
+
+		// Sort descending by area
+		std::stable_sort(SortedRooms.begin(), SortedRooms.end(), [&Rooms](int32_t A, int32_t B)
+		{
+			return Rooms[A].Area > Rooms[B].Area;
+		});
+
+		const int32_t Count = std::min<int32_t>(std::max(NumberOfBiggestRooms, 0), static_cast<int32_t>(SortedRooms.size()));
+		OutSelected.assign(SortedRooms.begin(), SortedRooms.begin() + Count);
+	}
+}
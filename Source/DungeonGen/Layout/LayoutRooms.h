@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LayoutRandom.h"
+#include "LayoutTypes.h"
+
+namespace DungeonLayout
+{
+	// Uniform random point in a disc of the given radius
+	FVec2 GetRandomPointInCircle(FLayoutRandom& Random, double Radius, const FVec2& Center);
+
+	// Scatters Params.RoomsToSpawn rooms with random integer scales in [RoomSizeMin, RoomSizeMax]. Every room
+	// draws from its own substream of Random.
+	void ScatterRooms(const FLayoutParams& Params, const FLayoutRandom& Random, std::vector<FLayoutRoom>& OutRooms);
+
+	// Same, from the scatter substream of Params.Seed. What the pipeline uses.
+	void ScatterRooms(const FLayoutParams& Params, std::vector<FLayoutRoom>& OutRooms);
+
+	// Indices of the NumberOfBiggestRooms biggest rooms, biggest first. Ties keep the scatter order.
+	void SelectBiggestRooms(const std::vector<FLayoutRoom>& Rooms, int32_t NumberOfBiggestRooms, std::vector<int32_t>& OutSelected);
+}
@@ -0,0 +1,281 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutSeparation.h"
+
+#include "LayoutParallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		// How far RoomB has to move away from RoomA (and RoomA the opposite way) along the axis with less overlap.
+		// Returns false if they don't overlap.
+		bool ComputeRoomPairSeparation(const FLayoutRoom& RoomA, const FLayoutRoom& RoomB, FVec2& OutSeparation)
+		{
+			const FVec2 Overlap = ComputeRoomOverlap(RoomA, RoomB);
+			if (Overlap.X <= 0 || Overlap.Y <= 0)
+			{
+				return false;
+			}
+
+			const FVec2 Delta = RoomB.Center - RoomA.Center;
+
+			// Move in the axis with less overlap
+			OutSeparation = FVec2();
+			if (Overlap.X < Overlap.Y)
+			{
+				// add +0.1 to really separate rooms so they're not adjacent (else it still trigger overlap, and also converges faster)
+				OutSeparation.X = (Delta.X < 0 ? -1 : 1) * (Overlap.X * 0.5 + 0.1);
+			}
+			else
+			{
+				OutSeparation.Y = (Delta.Y < 0 ? -1 : 1) * (Overlap.Y * 0.5 + 0.1);
+			}
+			return true;
+		}
+
+		// Pushes both rooms half the way out. Returns false if they don't overlap.
+		bool ResolveRoomPairOverlap(FLayoutRoom& RoomA, FLayoutRoom& RoomB)
+		{
+			FVec2 Separation;
+			if (!ComputeRoomPairSeparation(RoomA, RoomB, Separation))
+			{
+				return false;
+			}
+
+			RoomA.Center -= Separation;
+			RoomB.Center += Separation;
+			return true;
+		}
+
+		// Rooms per parallel batch, below this the scheduling costs more than the work
+		constexpr int32_t SeparationBatchSize = 512;
+	}
+
+	double ComputeBroadphaseCellSize(const FLayoutParams& Params)
+	{
+		return static_cast<double>(Params.RoomSizeMax) * Params.RoomUnitSize;
+	}
+
+	double ComputeBroadphaseCellSize(const std::vector<FLayoutRoom>& Rooms)
+	{
+		double MaxHalfExtent = 0.0;
+		for (const FLayoutRoom& Room : Rooms)
+		{
+			MaxHalfExtent = std::max(MaxHalfExtent, std::max(Room.HalfExtents.X, Room.HalfExtents.Y));
+		}
+		return MaxHalfExtent * 2.0;
+	}
+
+	bool SeparateRoomsStep(std::vector<FLayoutRoom>& Rooms, FRoomSpatialHash& Broadphase, int64_t* OutPairsTested)
+	{
+		Broadphase.Build(Rooms);
+
+		bool bAnyOverlap = false;
+		int64_t PairsTested = 0;
+		const int32_t NumRooms = static_cast<int32_t>(Rooms.size());
+
+		for (int32_t i = 0; i < NumRooms; ++i)
+		{
+			Broadphase.ForEachCandidate(i, [&Rooms, &bAnyOverlap, &PairsTested, i](int32_t j)
+			{
+				// Each pair once (j > i)
+				if (j <= i)
+				{
+					return;
+				}
+				++PairsTested;
+				if (ResolveRoomPairOverlap(Rooms[i], Rooms[j]))
+				{
+					bAnyOverlap = true;
+				}
+			});
+		}
+
+		if (OutPairsTested)
+		{
+			*OutPairsTested += PairsTested;
+		}
+		return bAnyOverlap;
+	}
+
+	bool SeparateRoomsStepJacobi(std::vector<FLayoutRoom>& Rooms, FRoomSpatialHash& Broadphase, std::vector<FVec2>& Displacements,
+		int64_t* OutPairsTested)
+	{
+		Broadphase.Build(Rooms);
+
+		const int32_t NumRooms = static_cast<int32_t>(Rooms.size());
+		Displacements.assign(NumRooms, FVec2());
+		std::atomic<bool> bAnyOverlap(false);
+		std::atomic<int64_t> PairsTested(0);
+
+		// Gather: each room only writes its own displacement, so the result does not depend on how the
+		// rooms are split between threads
+		ParallelForRange(NumRooms, SeparationBatchSize, [&Rooms, &Broadphase, &Displacements, &bAnyOverlap, &PairsTested](int32_t Begin, int32_t End)
+		{
+			bool bRangeOverlap = false;
+			int64_t RangePairsTested = 0;
+			for (int32_t i = Begin; i < End; ++i)
+			{
+				// Largest push in each direction: pushes from several neighbours on the same side don't stack,
+				// which would overshoot, while pushes from opposite sides still cancel out
+				FVec2 MaxPositive;
+				FVec2 MaxNegative;
+				Broadphase.ForEachCandidate(i, [&Rooms, &MaxPositive, &MaxNegative, &bRangeOverlap, &RangePairsTested, i](int32_t j)
+				{
+					if (j == i)
+					{
+						return;
+					}
+					++RangePairsTested;
+
+					// Same orientation as the serial pass so both rooms of a pair agree on the push
+					const bool bIsRoomA = i < j;
+					FVec2 Separation;
+					if (ComputeRoomPairSeparation(Rooms[bIsRoomA ? i : j], Rooms[bIsRoomA ? j : i], Separation))
+					{
+						bRangeOverlap = true;
+						const FVec2 Push = bIsRoomA ? FVec2() - Separation : Separation;
+						MaxPositive.X = std::max(MaxPositive.X, Push.X);
+						MaxPositive.Y = std::max(MaxPositive.Y, Push.Y);
+						MaxNegative.X = std::min(MaxNegative.X, Push.X);
+						MaxNegative.Y = std::min(MaxNegative.Y, Push.Y);
+					}
+				});
+				const FVec2 Displacement = MaxPositive + MaxNegative;
+				Displacements[i] = Displacement;
+			}
+
+			if (bRangeOverlap)
+			{
+				bAnyOverlap = true;
+			}
+			PairsTested += RangePairsTested;
+		});
+		if (OutPairsTested)
+		{
+			*OutPairsTested += PairsTested;
+		}
+
+		// Apply in one batch
+		ParallelForRange(NumRooms, SeparationBatchSize * 8, [&Rooms, &Displacements](int32_t Begin, int32_t End)
+		{
+			for (int32_t i = Begin; i < End; ++i)
+			{
+				Rooms[i].Center += Displacements[i];
+			}
+		});
+
+		return bAnyOverlap;
+	}
+
+	bool SeparateRoomsStepBruteForce(std::vector<FLayoutRoom>& Rooms)
+	{
+		bool bAnyOverlap = false;
+		const int32_t NumRooms = static_cast<int32_t>(Rooms.size());
+
+		for (int32_t i = 0; i < NumRooms; ++i)
+		{
+			for (int32_t j = i + 1; j < NumRooms; ++j)
+			{
+				if (ResolveRoomPairOverlap(Rooms[i], Rooms[j]))
+				{
+					bAnyOverlap = true;
+				}
+			}
+		}
+
+		return bAnyOverlap;
+	}
+
+	double ComputeResidualOverlap(const std::vector<FLayoutRoom>& Rooms, FRoomSpatialHash& Broadphase)
+	{
+		Broadphase.Build(Rooms);
+
+		double Residual = 0.0;
+		for (int32_t i = 0; i < static_cast<int32_t>(Rooms.size()); ++i)
+		{
+			Broadphase.ForEachCandidate(i, [&Rooms, &Residual, i](int32_t j)
+			{
+				const FVec2 Overlap = ComputeRoomOverlap(Rooms[i], Rooms[j]);
+				if (j > i && Overlap.X > 0 && Overlap.Y > 0)
+				{
+					Residual += Overlap.X * Overlap.Y;
+				}
+			});
+		}
+		return Residual;
+	}
+
+	FRoomSeparator::FRoomSeparator(double InCellSize, int32_t InMaxIterations, ESeparationSolver InSolver)
+	{
+		Reset(InCellSize, InMaxIterations, InSolver);
+	}
+
+	void FRoomSeparator::Reset(double InCellSize, int32_t InMaxIterations, ESeparationSolver InSolver)
+	{
+		Broadphase.SetCellSize(InCellSize);
+		MaxIterations = InMaxIterations;
+		Solver = InSolver;
+		bDone = false;
+		Result = FSeparationResult();
+	}
+
+	void FRoomSeparator::Finish(std::vector<FLayoutRoom>& Rooms, bool bInConverged)
+	{
+		bDone = true;
+		Result.bConverged = bInConverged;
+		Result.ResidualOverlap = bInConverged ? 0.0 : ComputeResidualOverlap(Rooms, Broadphase);
+	}
+
+	bool FRoomSeparator::Step(std::vector<FLayoutRoom>& Rooms)
+	{
+		if (bDone)
+		{
+			return true;
+		}
+
+		const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+		const bool bAnyOverlap = Solver == ESeparationSolver::Jacobi
+			? SeparateRoomsStepJacobi(Rooms, Broadphase, Displacements, &Result.PairsTested)
+			: SeparateRoomsStep(Rooms, Broadphase, &Result.PairsTested);
+		++Result.Iterations;
+
+		if (!bAnyOverlap)
+		{
+			Finish(Rooms, true);
+		}
+		else if (Result.Iterations >= MaxIterations)
+		{
+			Finish(Rooms, false);
+		}
+
+		Result.Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		return bDone;
+	}
+
+	bool FRoomSeparator::Run(std::vector<FLayoutRoom>& Rooms, double BudgetMilliseconds)
+	{
+		const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+		while (!Step(Rooms))
+		{
+			const double ElapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+			if (BudgetMilliseconds > 0.0 && ElapsedMilliseconds >= BudgetMilliseconds)
+			{
+				break;
+			}
+		}
+		return bDone;
+	}
+
+	FSeparationResult SeparateRooms(std::vector<FLayoutRoom>& Rooms, int32_t MaxIterations, ESeparationSolver Solver)
+	{
+		FRoomSeparator Separator(ComputeBroadphaseCellSize(Rooms), MaxIterations, Solver);
+		Separator.Run(Rooms, 0.0);
+		return Separator.GetResult();
+	}
+}
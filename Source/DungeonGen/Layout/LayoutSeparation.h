@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LayoutSpatialHash.h"
+#include "LayoutTypes.h"
+
+namespace DungeonLayout
+{
+	// Overlap of two rooms on each axis, positive on both axes when they intersect
+	inline FVec2 ComputeRoomOverlap(const FLayoutRoom& A, const FLayoutRoom& B)
+	{
+		const FVec2 Delta = B.Center - A.Center;
+		return FVec2(A.HalfExtents.X + B.HalfExtents.X - std::fabs(Delta.X),
+			A.HalfExtents.Y + B.HalfExtents.Y - std::fabs(Delta.Y));
+	}
+
+	// Broadphase cell size for rooms scaled up to Params.RoomSizeMax
+	double ComputeBroadphaseCellSize(const FLayoutParams& Params);
+
+	// Broadphase cell size for the biggest of the given rooms
+	double ComputeBroadphaseCellSize(const std::vector<FLayoutRoom>& Rooms);
+
+	// One separation pass. Overlapping rooms are pushed apart along the axis with the smallest overlap.
+	// Only pairs sharing a broadphase neighbourhood are tested, the broadphase is rebuilt first.
+	// Returns true if any overlap was found. OutPairsTested, when given, is incremented by the pairs tested.
+	bool SeparateRoomsStep(std::vector<FLayoutRoom>& Rooms, FRoomSpatialHash& Broadphase, int64_t* OutPairsTested = nullptr);
+
+	// Jacobi pass: per room displacements are accumulated in parallel from the start of pass positions,
+	// then applied in one batch. Displacements is scratch space. Returns true if any overlap was found.
+	// Both rooms of a pair test it, each test is counted in OutPairsTested.
+	bool SeparateRoomsStepJacobi(std::vector<FLayoutRoom>& Rooms, FRoomSpatialHash& Broadphase, std::vector<FVec2>& Displacements,
+		int64_t* OutPairsTested = nullptr);
+
+	// Same pass testing every pair, O(N^2). Kept as a reference for tests and benchmarks.
+	bool SeparateRoomsStepBruteForce(std::vector<FLayoutRoom>& Rooms);
+
+	// Sum of the overlapping areas of every pair, 0 once the rooms are separated
+	double ComputeResidualOverlap(const std::vector<FLayoutRoom>& Rooms, FRoomSpatialHash& Broadphase);
+
+	struct FSeparationResult
+	{
+		// Passes run so far, the last one is the pass that found no overlap when converged
+		int32_t Iterations = 0;
+		double Seconds = 0.0;
+		// Remaining overlapping area, only up to date once the separation is done
+		double ResidualOverlap = 0.0;
+		bool bConverged = false;
+		// Room pairs tested for overlap by all the passes
+		int64_t PairsTested = 0;
+	};
+
+	// Resumable separation: runs passes until convergence, MaxIterations, or the time budget of the current call.
+	// Lets the caller spread the separation over frames, run it in one go, or step it one pass at a time.
+	class FRoomSeparator
+	{
+	public:
+		FRoomSeparator(double InCellSize = 1000.0, int32_t InMaxIterations = 10000, ESeparationSolver InSolver = ESeparationSolver::GaussSeidel);
+
+		// Starts over on a new set of rooms
+		void Reset(double InCellSize, int32_t InMaxIterations, ESeparationSolver InSolver = ESeparationSolver::GaussSeidel);
+
+		// One pass. Returns true once the separation is done.
+		bool Step(std::vector<FLayoutRoom>& Rooms);
+
+		// Runs passes until done or BudgetMilliseconds is spent (<= 0 means no limit).
+		// The budget is checked between passes. Returns true once the separation is done.
+		bool Run(std::vector<FLayoutRoom>& Rooms, double BudgetMilliseconds);
+
+		bool IsDone() const { return bDone; }
+		const FSeparationResult& GetResult() const { return Result; }
+
+	private:
+		void Finish(std::vector<FLayoutRoom>& Rooms, bool bInConverged);
+
+		FRoomSpatialHash Broadphase;
+		std::vector<FVec2> Displacements;
+		int32_t MaxIterations;
+		ESeparationSolver Solver;
+		bool bDone = false;
+		FSeparationResult Result;
+	};
+
+	// Separates the rooms in one blocking call
+	FSeparationResult SeparateRooms(std::vector<FLayoutRoom>& Rooms, int32_t MaxIterations, ESeparationSolver Solver = ESeparationSolver::GaussSeidel);
+}
@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutSerialization.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		class FLayoutByteWriter
+		{
+		public:
+			explicit FLayoutByteWriter(std::vector<uint8_t>& InBytes) : Bytes(InBytes) {}
+
+			template <typename T>
+			void Write(const T& Value)
+			{
+				static_assert(std::is_trivially_copyable<T>::value, "Only plain values are written");
+				const size_t Offset = Bytes.size();
+				Bytes.resize(Offset + sizeof(T));
+				std::memcpy(Bytes.data() + Offset, &Value, sizeof(T));
+			}
+
+			template <typename T>
+			void WriteArray(const std::vector<T>& Values)
+			{
+				static_assert(std::is_trivially_copyable<T>::value, "Only plain values are written");
+				Write(static_cast<uint64_t>(Values.size()));
+				const size_t Offset = Bytes.size();
+				Bytes.resize(Offset + Values.size() * sizeof(T));
+				if (!Values.empty())
+				{
+					std::memcpy(Bytes.data() + Offset, Values.data(), Values.size() * sizeof(T));
+				}
+			}
+
+		private:
+			std::vector<uint8_t>& Bytes;
+		};
+
+		class FLayoutByteReader
+		{
+		public:
+			FLayoutByteReader(const uint8_t* InData, size_t InSize) : Data(InData), Size(InSize) {}
+
+			template <typename T>
+			bool Read(T& OutValue)
+			{
+				if (Size - Offset < sizeof(T))
+				{
+					return false;
+				}
+				std::memcpy(&OutValue, Data + Offset, sizeof(T));
+				Offset += sizeof(T);
+				return true;
+			}
+
+			template <typename T>
+			bool ReadArray(std::vector<T>& OutValues)
+			{
+				uint64_t Count = 0;
+				if (!Read(Count) || Count > (Size - Offset) / sizeof(T))
+				{
+					return false;
+				}
+				OutValues.resize(static_cast<size_t>(Count));
+				if (Count > 0)
+				{
+					std::memcpy(OutValues.data(), Data + Offset, static_cast<size_t>(Count) * sizeof(T));
+				}
+				Offset += static_cast<size_t>(Count) * sizeof(T);
+				return true;
+			}
+
+			bool IsAtEnd() const { return Offset == Size; }
+
+		private:
+			const uint8_t* Data;
+			size_t Size;
+			size_t Offset = 0;
+		};
+
+		bool AreRoomIndicesValid(const std::vector<int32_t>& Indices, size_t NumRooms)
+		{
+			for (int32_t Index : Indices)
+			{
+				if (Index < 0 || static_cast<size_t>(Index) >= NumRooms)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool AreEdgesValid(const std::vector<FLayoutEdge>& Edges, size_t NumRooms)
+		{
+			for (const FLayoutEdge& Edge : Edges)
+			{
+				if (Edge.A < 0 || Edge.B < 0 || static_cast<size_t>(Edge.A) >= NumRooms || static_cast<size_t>(Edge.B) >= NumRooms)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	void WriteLayout(const FCachedLayout& Cached, std::vector<uint8_t>& OutBytes)
+	{
+		const FDungeonLayout& Layout = Cached.Layout;
+		FLayoutByteWriter Writer(OutBytes);
+		Writer.WriteArray(Layout.Rooms);
+		Writer.WriteArray(Layout.SelectedRooms);
+		Writer.WriteArray(Layout.CorridorRooms);
+		Writer.WriteArray(Layout.Triangles);
+		Writer.WriteArray(Layout.MinimumSpanningTree);
+		Writer.WriteArray(Layout.Corridors);
+		Writer.Write(Cached.Separation.Iterations);
+		Writer.Write(Cached.Separation.Seconds);
+		Writer.Write(Cached.Separation.ResidualOverlap);
+		Writer.Write(static_cast<uint8_t>(Cached.Separation.bConverged));
+	}
+
+	bool ReadLayout(const uint8_t* Data, size_t Size, FCachedLayout& OutCached)
+	{
+		FDungeonLayout& Layout = OutCached.Layout;
+		FLayoutByteReader Reader(Data, Size);
+		uint8_t bConverged = 0;
+		const bool bRead = Reader.ReadArray(Layout.Rooms)
+			&& Reader.ReadArray(Layout.SelectedRooms)
+			&& Reader.ReadArray(Layout.CorridorRooms)
+			&& Reader.ReadArray(Layout.Triangles)
+			&& Reader.ReadArray(Layout.MinimumSpanningTree)
+			&& Reader.ReadArray(Layout.Corridors)
+			&& Reader.Read(OutCached.Separation.Iterations)
+			&& Reader.Read(OutCached.Separation.Seconds)
+			&& Reader.Read(OutCached.Separation.ResidualOverlap)
+			&& Reader.Read(bConverged)
+			&& Reader.IsAtEnd();
+		OutCached.Separation.bConverged = bConverged != 0;
+
+		// The spawning code indexes Rooms with these without checking
+		return bRead
+			&& AreRoomIndicesValid(Layout.SelectedRooms, Layout.Rooms.size())
+			&& AreRoomIndicesValid(Layout.CorridorRooms, Layout.Rooms.size())
+			&& AreEdgesValid(Layout.MinimumSpanningTree, Layout.Rooms.size());
+	}
+}
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Flat binary form of a finished layout, for the layout cache
+
+#include "LayoutSeparation.h"
+#include "LayoutTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DungeonLayout
+{
+	// Everything a cached generation gives back: the layout and how its separation went
+	struct FCachedLayout
+	{
+		FDungeonLayout Layout;
+		FSeparationResult Separation;
+	};
+
+	// Appends Cached to OutBytes, native byte order
+	void WriteLayout(const FCachedLayout& Cached, std::vector<uint8_t>& OutBytes);
+
+	// Reads what WriteLayout wrote. False on truncated or inconsistent data, OutCached is then unspecified.
+	bool ReadLayout(const uint8_t* Data, size_t Size, FCachedLayout& OutCached);
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutSpatialHash.h"
+
+#include <algorithm>
+
+namespace DungeonLayout
+{
+	FRoomSpatialHash::FRoomSpatialHash(double InCellSize)
+	{
+		SetCellSize(InCellSize);
+	}
+
+	void FRoomSpatialHash::SetCellSize(double InCellSize)
+	{
+		CellSize = std::max(InCellSize, 1.e-3);
+		InvCellSize = 1.0 / CellSize;
+	}
+
+	int32_t FRoomSpatialHash::FindSlot(uint64_t Key) const
+	{
+		if (SlotKeys.empty())
+		{
+			return -1;
+		}
+
+		for (uint64_t Slot = HashKey(Key) & SlotMask;; Slot = (Slot + 1) & SlotMask)
+		{
+			if (SlotCells[Slot] < 0)
+			{
+				return -1;
+			}
+			if (SlotKeys[Slot] == Key)
+			{
+				return static_cast<int32_t>(Slot);
+			}
+		}
+	}
+
+	void FRoomSpatialHash::Build(const std::vector<FLayoutRoom>& Rooms)
+	{
+		const int32_t NumRooms = static_cast<int32_t>(Rooms.size());
+
+		// At most one cell per room, keep the load factor under 0.5
+		uint64_t TableSize = 16;
+		while (TableSize < static_cast<uint64_t>(NumRooms) * 2)
+		{
+			TableSize <<= 1;
+		}
+		SlotMask = TableSize - 1;
+		SlotKeys.assign(TableSize, 0);
+		SlotCells.assign(TableSize, -1);
+
+		CellCoords.resize(NumRooms * 2);
+		RoomCells.resize(NumRooms);
+		CellStarts.clear();
+
+		// Count rooms per cell, CellStarts temporarily holds the counts
+		int32_t NumCellsFound = 0;
+		for (int32_t i = 0; i < NumRooms; ++i)
+		{
+			const int32_t CellX = static_cast<int32_t>(std::floor(Rooms[i].Center.X * InvCellSize));
+			const int32_t CellY = static_cast<int32_t>(std::floor(Rooms[i].Center.Y * InvCellSize));
+			CellCoords[i * 2] = CellX;
+			CellCoords[i * 2 + 1] = CellY;
+
+			const uint64_t Key = MakeKey(CellX, CellY);
+			uint64_t Slot = HashKey(Key) & SlotMask;
+			while (SlotCells[Slot] >= 0 && SlotKeys[Slot] != Key)
+			{
+				Slot = (Slot + 1) & SlotMask;
+			}
+			if (SlotCells[Slot] < 0)
+			{
+				SlotKeys[Slot] = Key;
+				SlotCells[Slot] = NumCellsFound++;
+				CellStarts.push_back(0);
+			}
+
+			RoomCells[i] = SlotCells[Slot];
+			++CellStarts[RoomCells[i]];
+		}
+
+		// Exclusive prefix sum, then scatter rooms in index order
+		CellStarts.push_back(0);
+		int32_t Running = 0;
+		for (int32_t& Start : CellStarts)
+		{
+			const int32_t Count = Start;
+			Start = Running;
+			Running += Count;
+		}
+
+		CellRooms.resize(NumRooms);
+		std::vector<int32_t> Cursor(CellStarts.begin(), CellStarts.end() - 1);
+		for (int32_t i = 0; i < NumRooms; ++i)
+		{
+			CellRooms[Cursor[RoomCells[i]]++] = i;
+		}
+	}
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LayoutTypes.h"
+
+#include <cmath>
+
+namespace DungeonLayout
+{
+	// Uniform grid over room centers, stored as a hashed cell table so the world bounds never matter.
+	// With a cell size at least as large as the biggest room, two overlapping rooms always have their
+	// centers in the same or in adjacent cells, so only the 3x3 block around a room has to be tested.
+	class FRoomSpatialHash
+	{
+	public:
+		explicit FRoomSpatialHash(double InCellSize = 1000.0);
+
+		void SetCellSize(double InCellSize);
+		double GetCellSize() const { return CellSize; }
+
+		// Rebuilds the grid from the current room positions, O(N)
+		void Build(const std::vector<FLayoutRoom>& Rooms);
+
+		// Calls Fn(OtherIndex) for every room whose center was in the 3x3 cell block around RoomIndex at Build time.
+		// Within a cell, rooms come in ascending index order.
+		template <typename FunctionType>
+		void ForEachCandidate(int32_t RoomIndex, FunctionType&& Fn) const
+		{
+			const int64_t CellX = CellCoords[RoomIndex * 2];
+			const int64_t CellY = CellCoords[RoomIndex * 2 + 1];
+			for (int64_t OffsetY = -1; OffsetY <= 1; ++OffsetY)
+			{
+				for (int64_t OffsetX = -1; OffsetX <= 1; ++OffsetX)
+				{
+					const int32_t Slot = FindSlot(MakeKey(CellX + OffsetX, CellY + OffsetY));
+					if (Slot < 0)
+					{
+						continue;
+					}
+
+					const int32_t Cell = SlotCells[Slot];
+					for (int32_t i = CellStarts[Cell], End = CellStarts[Cell + 1]; i < End; ++i)
+					{
+						Fn(CellRooms[i]);
+					}
+				}
+			}
+		}
+
+		int32_t NumCells() const { return static_cast<int32_t>(CellStarts.size()) - 1; }
+
+	private:
+		static uint64_t MakeKey(int64_t CellX, int64_t CellY)
+		{
+			return (static_cast<uint64_t>(static_cast<uint32_t>(CellX)) << 32) | static_cast<uint32_t>(CellY);
+		}
+
+		static uint64_t HashKey(uint64_t Key)
+		{
+			Key ^= Key >> 33;
+			Key *= 0xFF51AFD7ED558CCDull;
+			Key ^= Key >> 33;
+			return Key;
+		}
+
+		int32_t FindSlot(uint64_t Key) const;
+
+		double CellSize;
+		double InvCellSize;
+
+		// Open addressing table: key -> cell index
+		std::vector<uint64_t> SlotKeys;
+		std::vector<int32_t> SlotCells;
+		uint64_t SlotMask = 0;
+
+		// Rooms grouped by cell, CellRooms[CellStarts[c] .. CellStarts[c + 1]) belong to cell c
+		std::vector<int32_t> CellStarts;
+		std::vector<int32_t> CellRooms;
+
+		// Per room cell coordinates (X, Y interleaved) and cell index
+		std::vector<int32_t> CellCoords;
+		std::vector<int32_t> RoomCells;
+	};
+}
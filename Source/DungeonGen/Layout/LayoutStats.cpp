@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace DungeonLayout
+{
+	namespace
+	{
+		std::atomic<FLayoutStageHook> GLayoutStageHook(nullptr);
+
+		using FClock = std::chrono::steady_clock;
+	}
+
+	const char* GetLayoutStageName(ELayoutStage Stage)
+	{
+		switch (Stage)
+		{
+		case ELayoutStage::Scatter:
+			return "Scatter";
+		case ELayoutStage::Separation:
+			return "Separation";
+		case ELayoutStage::Selection:
+			return "Selection";
+		case ELayoutStage::Delaunay:
+			return "Delaunay";
+		case ELayoutStage::RoomGraph:
+			return "RoomGraph";
+		case ELayoutStage::SpanningTree:
+			return "SpanningTree";
+		case ELayoutStage::Corridors:
+			return "Corridors";
+		default:
+			return "Unknown";
+		}
+	}
+
+	double FLayoutStats::GetTotalSeconds() const
+	{
+		double Total = 0.0;
+		for (double Seconds : StageSeconds)
+		{
+			Total += Seconds;
+		}
+		return Total;
+	}
+
+	void FLayoutStats::Add(const FLayoutStats& Other)
+	{
+		for (int32_t i = 0; i < NumLayoutStages; ++i)
+		{
+			StageSeconds[i] += Other.StageSeconds[i];
+		}
+		SeparationIterations += Other.SeparationIterations;
+		OverlapPairsTested += Other.OverlapPairsTested;
+		DelaunayInsertions += Other.DelaunayInsertions;
+		DelaunayBadTriangles += Other.DelaunayBadTriangles;
+		MaxDelaunayBadTriangles = std::max(MaxDelaunayBadTriangles, Other.MaxDelaunayBadTriangles);
+		GraphEdges += Other.GraphEdges;
+		SpanningTreeEdges += Other.SpanningTreeEdges;
+		CorridorSegments += Other.CorridorSegments;
+	}
+
+	void SetLayoutStageHook(FLayoutStageHook Hook)
+	{
+		GLayoutStageHook = Hook;
+	}
+
+	FLayoutStageScope::FLayoutStageScope(ELayoutStage InStage, FLayoutStats* InStats)
+		: Stage(InStage)
+		, Stats(InStats)
+		, Hook(GLayoutStageHook)
+		, StartTicks(FClock::now().time_since_epoch().count())
+	{
+		if (Hook)
+		{
+			Hook(Stage, true);
+		}
+	}
+
+	FLayoutStageScope::~FLayoutStageScope()
+	{
+		if (Stats)
+		{
+			const FClock::duration Elapsed = FClock::now().time_since_epoch() - FClock::duration(StartTicks);
+			Stats->StageSeconds[static_cast<int32_t>(Stage)] += std::chrono::duration<double>(Elapsed).count();
+		}
+		// The hook seen at the start, so a stage that began is always ended
+		if (Hook)
+		{
+			Hook(Stage, false);
+		}
+	}
+}
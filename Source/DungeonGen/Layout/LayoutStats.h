@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Per stage timings and counters of a layout generation. The host can also follow the stages as they run through
+// a hook, the DungeonGen module turns them into trace events and stat cycle counters.
+
+#include <cstdint>
+
+namespace DungeonLayout
+{
+	enum class ELayoutStage : uint8_t
+	{
+		Scatter,
+		Separation,
+		Selection,
+		Delaunay,
+		RoomGraph,
+		SpanningTree,
+		Corridors,
+		Num
+	};
+
+	constexpr int32_t NumLayoutStages = static_cast<int32_t>(ELayoutStage::Num);
+
+	const char* GetLayoutStageName(ELayoutStage Stage);
+
+	// Filled by the stages that are handed one. Stages run several times, like the time sliced separation, add up.
+	struct FLayoutStats
+	{
+		double StageSeconds[NumLayoutStages] = {};
+
+		int32_t SeparationIterations = 0;
+		// Room pairs the separation passes tested for overlap, after the broadphase
+		int64_t OverlapPairsTested = 0;
+
+		int32_t DelaunayInsertions = 0;
+		// Triangles removed by the insertions, the cavity sizes
+		int64_t DelaunayBadTriangles = 0;
+		int32_t MaxDelaunayBadTriangles = 0;
+
+		int32_t GraphEdges = 0;
+		int32_t SpanningTreeEdges = 0;
+		int32_t CorridorSegments = 0;
+
+		double GetStageSeconds(ELayoutStage Stage) const { return StageSeconds[static_cast<int32_t>(Stage)]; }
+		double GetTotalSeconds() const;
+
+		// Adds the timings and counters of stages run separately, like the graph stages of the staged generation
+		void Add(const FLayoutStats& Other);
+	};
+
+	// Called on the thread running the stage, when it begins and when it ends. Stages of one thread don't nest.
+	using FLayoutStageHook = void (*)(ELayoutStage Stage, bool bBegin);
+
+	// nullptr removes the hook
+	void SetLayoutStageHook(FLayoutStageHook Hook);
+
+	// Times a stage into Stats, which may be null, and reports it to the hook
+	class FLayoutStageScope
+	{
+	public:
+		FLayoutStageScope(ELayoutStage InStage, FLayoutStats* InStats);
+		~FLayoutStageScope();
+
+		FLayoutStageScope(const FLayoutStageScope&) = delete;
+		FLayoutStageScope& operator=(const FLayoutStageScope&) = delete;
+
+	private:
+		ELayoutStage Stage;
+		FLayoutStats* Stats;
+		FLayoutStageHook Hook;
+		int64_t StartTicks;
+	};
+}
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Plain data types shared by every layout stage.
+// Nothing in Layout/ may include engine headers: the same files build inside the DungeonGen module
+// and as the standalone DungeonLayout static library (see CMakeLists.txt at the project root).
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace DungeonLayout
+{
+	struct FVec2
+	{
+		double X = 0.0;
+		double Y = 0.0;
+
+		FVec2() {}
+		FVec2(double InX, double InY) : X(InX), Y(InY) {}
+
+		FVec2 operator+(const FVec2& Other) const { return FVec2(X + Other.X, Y + Other.Y); }
+		FVec2 operator-(const FVec2& Other) const { return FVec2(X - Other.X, Y - Other.Y); }
+		FVec2 operator*(double Scale) const { return FVec2(X * Scale, Y * Scale); }
+		FVec2& operator+=(const FVec2& Other) { X += Other.X; Y += Other.Y; return *this; }
+		FVec2& operator-=(const FVec2& Other) { X -= Other.X; Y -= Other.Y; return *this; }
+		bool operator==(const FVec2& Other) const { return X == Other.X && Y == Other.Y; }
+		bool operator!=(const FVec2& Other) const { return !(*this == Other); }
+
+		double SizeSquared() const { return X * X + Y * Y; }
+		double Size() const { return std::sqrt(SizeSquared()); }
+
+		static double DistSquared(const FVec2& A, const FVec2& B) { return (B - A).SizeSquared(); }
+		static double Dist(const FVec2& A, const FVec2& B) { return (B - A).Size(); }
+	};
+
+	// Axis aligned room rectangle. Id is the index of the room in FDungeonLayout::Rooms.
+	struct FLayoutRoom
+	{
+		FVec2 Center;
+		FVec2 HalfExtents;
+		float Area = 0.f;
+		int32_t Id = -1;
+
+		FVec2 Min() const { return Center - HalfExtents; }
+		FVec2 Max() const { return Center + HalfExtents; }
+	};
+
+	// Edge between two rooms. A and B index FDungeonLayout::Rooms once the layout is assembled,
+	// the graph stages work on local point indices.
+	struct FLayoutEdge
+	{
+		int32_t A = -1;
+		int32_t B = -1;
+		float Weight = 0.f;
+
+		FLayoutEdge() {}
+		FLayoutEdge(int32_t InA, int32_t InB, float InWeight) : A(InA), B(InB), Weight(InWeight) {}
+	};
+
+	// Counter clockwise triangle, corners are indices into the triangulated points
+	struct FLayoutTriangle
+	{
+		int32_t A = -1;
+		int32_t B = -1;
+		int32_t C = -1;
+
+		FLayoutTriangle() {}
+		FLayoutTriangle(int32_t InA, int32_t InB, int32_t InC) : A(InA), B(InB), C(InC) {}
+
+		bool operator==(const FLayoutTriangle& Other) const
+		{
+			return A == Other.A && B == Other.B && C == Other.C;
+		}
+	};
+
+	// One straight piece of corridor. EdgeIndex points into FDungeonLayout::MinimumSpanningTree.
+	struct FCorridorSegment
+	{
+		FVec2 Start;
+		FVec2 End;
+		int32_t EdgeIndex = -1;
+	};
+
+	enum class ESeparationSolver : uint8_t
+	{
+		// Pairs are pushed one after the other and each push sees the previous ones. Serial.
+		GaussSeidel,
+		// Every room sums its pushes against the positions at the start of the pass, then all rooms move at once.
+		// Runs in parallel and gives the same result for any thread count.
+		Jacobi
+	};
+
+	enum class EMstAlgorithm : uint8_t
+	{
+		// Grows the tree from node 0 with an indexed 4-ary heap, O(E log V)
+		Prim,
+		// Radix sorted edges merged with union-find, O(E) plus the sort
+		Kruskal
+	};
+
+	enum class ECorridorRouting : uint8_t
+	{
+		// Straight segment when the rooms overlap on one axis, L-shaped otherwise
+		Straight,
+		// A* on an occupancy grid, prefers existing corridors and going through rooms (see LayoutCorridorRouter.h)
+		Grid
+	};
+
+	struct FLayoutParams
+	{
+		int32_t RoomsToSpawn = 150;
+		int32_t NumberOfBigRoomsToSelect = 20;
+		float RoomSizeMin = 1.f;
+		float RoomSizeMax = 10.f;
+		// World size of a room at scale 1 (the room mesh is a unit cube of this size)
+		float RoomUnitSize = 100.f;
+		float GenerationRadius = 5000.f;
+		FVec2 GenerationCenter;
+		uint64_t Seed = 0;
+		// Safety net for the separation loop, it normally converges long before
+		int32_t MaxSeparationIterations = 10000;
+		ESeparationSolver SeparationSolver = ESeparationSolver::GaussSeidel;
+		EMstAlgorithm MstAlgorithm = EMstAlgorithm::Kruskal;
+		ECorridorRouting CorridorRouting = ECorridorRouting::Straight;
+		// Grid routing only, world size of a corridor cell
+		float CorridorCellSize = 100.f;
+	};
+
+	struct FDungeonLayout
+	{
+		std::vector<FLayoutRoom> Rooms;
+		// Indices into Rooms, biggest first
+		std::vector<int32_t> SelectedRooms;
+		// Unselected rooms crossed by a corridor, indices into Rooms
+		std::vector<int32_t> CorridorRooms;
+		// Corners index SelectedRooms
+		std::vector<FLayoutTriangle> Triangles;
+		std::vector<FLayoutEdge> MinimumSpanningTree;
+		std::vector<FCorridorSegment> Corridors;
+	};
+}
@@ -9,8 +9,8 @@
 // Sets default values
 ARoom::ARoom()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// Rooms are static, thousands of them ticking for nothing adds up
+	PrimaryActorTick.bCanEverTick = false;
 	mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
 	SetRootComponent(mesh);
 }
@@ -21,13 +21,6 @@ void ARoom::BeginPlay()
 	Super::BeginPlay();
 }
 
-// Called every frame
-void ARoom::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
 bool ARoom::OverlapsWithOtherRoom(TArray<AActor*>& OverlappingActors)
 {
 
@@ -27,8 +27,6 @@ protected:
 	float Height;
 
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
 	bool OverlapsWithOtherRoom(TArray<AActor*>& OverlappingActors);
 	float Area;
 	void SetArea(float InArea);
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomActorPool.h"
+
+#include "Room.h"
+
+URoomActorPool::URoomActorPool()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	MaxFreeRooms = 256;
+}
+
+ARoom* URoomActorPool::Acquire(TSubclassOf<ARoom> RoomClass, const FTransform& Transform)
+{
+	ARoom* Room = nullptr;
+
+	// Newest first, its components are the most likely to still be warm
+	for (int32 i = FreeRooms.Num() - 1; i >= 0; --i)
+	{
+		ARoom* Candidate = FreeRooms[i];
+		if (!IsValid(Candidate))
+		{
+			FreeRooms.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			continue;
+		}
+		if (Candidate->GetClass() == RoomClass.Get())
+		{
+			FreeRooms.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			Room = Candidate;
+			break;
+		}
+	}
+
+	if (Room)
+	{
+		++Stats.Hits;
+		Room->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		Room->SetActorHiddenInGame(false);
+		Room->SetActorEnableCollision(true);
+	}
+	else
+	{
+		UWorld* World = GetWorld();
+		if (!World)
+		{
+			return nullptr;
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = GetOwner();
+		Room = World->SpawnActor<ARoom>(RoomClass, Transform, SpawnParams);
+		if (!Room)
+		{
+			return nullptr;
+		}
+		++Stats.Misses;
+	}
+
+	++Stats.InUse;
+	Stats.Free = FreeRooms.Num();
+	Stats.HighWaterMark = FMath::Max(Stats.HighWaterMark, Stats.InUse);
+	return Room;
+}
+
+void URoomActorPool::Release(ARoom* Room)
+{
+	if (!IsValid(Room))
+	{
+		return;
+	}
+
+	Room->SetActorHiddenInGame(true);
+	Room->SetActorEnableCollision(false);
+	FreeRooms.Add(Room);
+
+	Stats.InUse = FMath::Max(Stats.InUse - 1, 0);
+	Stats.Free = FreeRooms.Num();
+}
+
+void URoomActorPool::Trim()
+{
+	while (FreeRooms.Num() > MaxFreeRooms)
+	{
+		ARoom* Room = FreeRooms.Pop(EAllowShrinking::No);
+		if (IsValid(Room))
+		{
+			Room->Destroy();
+		}
+	}
+	Stats.Free = FreeRooms.Num();
+}
+
+void URoomActorPool::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FreeRooms.Empty();
+	Stats.Free = 0;
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "RoomActorPool.generated.h"
+
+class ARoom;
+
+USTRUCT(BlueprintType)
+struct FRoomPoolStats
+{
+	GENERATED_BODY()
+
+	// Acquires served by a pooled room
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Hits = 0;
+
+	// Acquires that had to spawn a new room
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Misses = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 InUse = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Free = 0;
+
+	// Most rooms in use at once
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 HighWaterMark = 0;
+};
+
+// Recycles ARoom actors across regenerations. Released rooms are hidden and lose their collision instead of
+// being destroyed; acquiring one puts it back with a new transform.
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class DUNGEONGEN_API URoomActorPool : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	URoomActorPool();
+
+	// Pooled room of RoomClass if there is one, otherwise a new one. Owned by the pool's owner.
+	ARoom* Acquire(TSubclassOf<ARoom> RoomClass, const FTransform& Transform);
+
+	void Release(ARoom* Room);
+
+	// Destroys the free rooms beyond MaxFreeRooms
+	void Trim();
+
+	// Free rooms kept beyond this are destroyed by Trim
+	UPROPERTY(EditAnywhere, Category="Pool", meta=(ClampMin="0"))
+	int32 MaxFreeRooms;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Pool")
+	FRoomPoolStats Stats;
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY()
+	TArray<ARoom*> FreeRooms;
+};
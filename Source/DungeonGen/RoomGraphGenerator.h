@@ -5,10 +5,25 @@
 #include "CoreMinimal.h"
 #include "DungeonGenerator.h"
 #include "Components/ActorComponent.h"
+#include "Layout/DungeonLayout.h"
+#include "Layout/LayoutGraph.h"
 #include "RoomGraphGenerator.generated.h"
 
+class ULineBatchComponent;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnProcessFinished, const TArray<FRoomGraphEdge>&, MST);
 
+UENUM(BlueprintType)
+enum class EGraphPipelineMode : uint8
+{
+	// Triangulation, graph and MST back to back in the GenerateGraph call
+	Instant,
+	// Same stages on a worker thread, results are handed back to the game thread
+	Background,
+	// One stage every DelayBetweenSteps seconds so each one can be looked at, for debugging
+	StepThrough
+};
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class DUNGEONGEN_API URoomGraphGenerator : public UActorComponent
 {
@@ -21,35 +36,58 @@ public:
 protected:
 
 public:
-	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
-
-	UPROPERTY()
-	TArray<ARoom*> Rooms;
 	UPROPERTY()
 	TArray<ARoom*> SelectedRooms;
 	
 	UPROPERTY(BlueprintAssignable)
 	FOnProcessFinished OnGraphCompleted;
 
+	UPROPERTY(EditAnywhere, Category="Graph")
+	EGraphPipelineMode PipelineMode;
+
+	UPROPERTY(EditAnywhere, Category="Graph", meta=(EditCondition="PipelineMode == EGraphPipelineMode::StepThrough", ClampMin="0"))
 	float DelayBetweenSteps;
 
-	UFUNCTION()
-	void GenerateGraph(const TArray<ARoom*>& InSelectedRooms);
+	// The owner's debug line batch, null when debug drawing is compiled out
+	UPROPERTY()
+	ULineBatchComponent* DebugLines;
+
+	// From GenerateGraph to OnGraphCompleted, for the last graph
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Graph")
+	float LastGraphMilliseconds;
+
+	// InPoints are the centers of InSelectedRooms, in the same order
+	void GenerateGraph(const TArray<ARoom*>& InSelectedRooms, const std::vector<DungeonLayout::FVec2>& InPoints);
+	// Drops the graph being built, on a worker or between StepThrough stages. OnGraphCompleted won't fire for it.
+	void Cancel();
 	TArray<FRoomGraphEdge> MST;
 	TArray<FTriangle2D> Triangles;
-	FTriangle2D SuperTriangle;
-	UPROPERTY()
-	TMap<ARoom*, FRoomGraphNode> RoomGraph;
-	
+
+	// Layout core data, indices refer to Points / SelectedRooms
+	std::vector<DungeonLayout::FVec2> Points;
+	std::vector<DungeonLayout::FLayoutTriangle> LayoutTriangles;
+	DungeonLayout::FLayoutGraph RoomGraph;
+	std::vector<DungeonLayout::FLayoutEdge> LayoutTree;
+	DungeonLayout::EMstAlgorithm MstAlgorithm = DungeonLayout::EMstAlgorithm::Kruskal;
+	// Timings and counters of the graph stages of the last graph
+	DungeonLayout::FLayoutStats GraphStats;
 	
-	FTriangle2D ComputeSuperTriangle();
-	void DrawTriangle(const FTriangle2D& Triangle);
-	void DrawAllTriangles();
-	void ComputeCircumscribedCircle2D(const FTriangle2D& Triangle, FVector2D& OutCenter, float& OutRadius);
-	void DelaunayStep(FVector2d Point);
+	// Debug drawing, compiled out with WITH_DUNGEON_DEBUG_DRAW
+	void DrawAllTriangles() const;
+	void DrawSpanningTree() const;
 	void PerformDelaunayTriangulation();
 	void BuildRoomGraphFromTriangulation();
 	void ComputeMinimumSpanningTree();
 
+	// Runs every stage on the thread pool, then publishes on the game thread
+	void GenerateGraphInBackground();
+	// Game thread side of the stages: debug draw, ARoom edges and the completion event
+	void PublishTriangles();
+	void PublishSpanningTree();
+
 	FTimerHandle DelayTimerHandle;
+
+	// Bumped by every GenerateGraph and Cancel so a late background result for an older request is dropped
+	uint32 GraphRequestId = 0;
+	double GraphStartSeconds = 0.0;
 };
@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomSpawnScheduler.h"
+
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerStart.h"
+
+URoomSpawnScheduler::URoomSpawnScheduler()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SpawnBudgetMs = 2.f;
+	ReprioritizeSeconds = 0.25f;
+	NumSpawned = 0;
+	NumTotal = 0;
+}
+
+void URoomSpawnScheduler::Enqueue(TArray<FRoomSpawnRequest>&& Requests)
+{
+	const bool bWasIdle = Pending.Num() == 0;
+	if (bWasIdle)
+	{
+		NumSpawned = 0;
+		NumTotal = 0;
+	}
+
+	NumTotal += Requests.Num();
+	Pending.Append(MoveTemp(Requests));
+	Prioritize();
+
+	if (bWasIdle && Pending.Num() > 0)
+	{
+		GetOwner()->GetWorldTimerManager().SetTimerForNextTick(this, &URoomSpawnScheduler::SpawnSlice);
+	}
+}
+
+void URoomSpawnScheduler::Cancel()
+{
+	Pending.Empty();
+	NumSpawned = 0;
+	NumTotal = 0;
+}
+
+void URoomSpawnScheduler::SpawnSlice()
+{
+	if (Pending.Num() == 0)
+	{
+		// Cancelled since the last slice
+		return;
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+	if (StartSeconds - LastPrioritizeSeconds >= ReprioritizeSeconds)
+	{
+		Prioritize();
+	}
+
+	const double EndSeconds = StartSeconds + SpawnBudgetMs / 1000.0;
+	do
+	{
+		const FRoomSpawnRequest Request = Pending.Pop(EAllowShrinking::No);
+		SpawnRoom.ExecuteIfBound(Request);
+		++NumSpawned;
+	}
+	while (Pending.Num() > 0 && FPlatformTime::Seconds() < EndSeconds);
+
+	OnSpawnProgress.Broadcast(NumSpawned, NumTotal);
+
+	if (Pending.Num() > 0)
+	{
+		// Carry on next frame
+		GetOwner()->GetWorldTimerManager().SetTimerForNextTick(this, &URoomSpawnScheduler::SpawnSlice);
+		return;
+	}
+
+	Pending.Empty();
+	OnSpawnFinished.Broadcast();
+}
+
+void URoomSpawnScheduler::Prioritize()
+{
+	LastPrioritizeSeconds = FPlatformTime::Seconds();
+
+	TArray<FVector> FocusLocations;
+	GatherFocusLocations(FocusLocations);
+	if (FocusLocations.Num() == 0)
+	{
+		return;
+	}
+
+	for (FRoomSpawnRequest& Request : Pending)
+	{
+		Request.Priority = TNumericLimits<double>::Max();
+		for (const FVector& Location : FocusLocations)
+		{
+			Request.Priority = FMath::Min(Request.Priority, FVector::DistSquared2D(Location, Request.Location));
+		}
+	}
+
+	// Stable so equally distant rooms keep the layout order
+	Pending.StableSort([](const FRoomSpawnRequest& A, const FRoomSpawnRequest& B)
+	{
+		return A.Priority > B.Priority;
+	});
+}
+
+void URoomSpawnScheduler::GatherFocusLocations(TArray<FVector>& OutLocations) const
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* Controller = Iterator->Get();
+		if (Controller && Controller->GetPawn())
+		{
+			OutLocations.Add(Controller->GetPawn()->GetActorLocation());
+		}
+	}
+
+	if (OutLocations.Num() == 0)
+	{
+		for (TActorIterator<APlayerStart> Iterator(World); Iterator; ++Iterator)
+		{
+			OutLocations.Add(Iterator->GetActorLocation());
+		}
+	}
+
+	if (OutLocations.Num() == 0 && GetOwner())
+	{
+		OutLocations.Add(GetOwner()->GetActorLocation());
+	}
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "RoomSpawnScheduler.generated.h"
+
+class ARoom;
+
+UENUM(BlueprintType)
+enum class ERoomSpawnKind : uint8
+{
+	Selected,
+	Corridor,
+	// Left out of the dungeon, only drawn by the instanced render mode
+	Unselected
+};
+
+// One room waiting to be spawned. LayoutRoom indexes FDungeonLayout::Rooms.
+struct FRoomSpawnRequest
+{
+	FVector Location = FVector::ZeroVector;
+	int32 LayoutRoom = INDEX_NONE;
+	ERoomSpawnKind Kind = ERoomSpawnKind::Selected;
+	// Squared distance to the nearest player, filled by the scheduler
+	double Priority = 0.0;
+};
+
+DECLARE_DELEGATE_RetVal_OneParam(ARoom*, FSpawnRoomDelegate, const FRoomSpawnRequest&);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRoomSpawnProgress, int32, NumSpawned, int32, NumTotal);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnRoomSpawnFinished);
+
+// Spawns queued rooms over several frames, nearest to a player first, spending at most SpawnBudgetMs per frame.
+// The owner binds SpawnRoom to do the actual spawning.
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class DUNGEONGEN_API URoomSpawnScheduler : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	URoomSpawnScheduler();
+
+	// Adds to the queue and starts spawning next frame
+	void Enqueue(TArray<FRoomSpawnRequest>&& Requests);
+
+	// Drops everything not spawned yet
+	void Cancel();
+
+	bool IsSpawning() const { return Pending.Num() > 0; }
+
+	FSpawnRoomDelegate SpawnRoom;
+
+	// Fired after every frame slice
+	UPROPERTY(BlueprintAssignable, Category="Spawning")
+	FOnRoomSpawnProgress OnSpawnProgress;
+
+	// Fired once the queue is empty
+	UPROPERTY(BlueprintAssignable, Category="Spawning")
+	FOnRoomSpawnFinished OnSpawnFinished;
+
+	// Time spent spawning per frame. At least one room is spawned every frame.
+	UPROPERTY(EditAnywhere, Category="Spawning", meta=(ClampMin="0.1"))
+	float SpawnBudgetMs;
+
+	// How often the queue is sorted again as players move
+	UPROPERTY(EditAnywhere, Category="Spawning", meta=(ClampMin="0"))
+	float ReprioritizeSeconds;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Spawning")
+	int32 NumSpawned;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Spawning")
+	int32 NumTotal;
+
+protected:
+	void SpawnSlice();
+	void Prioritize();
+	// Player pawns, or the player starts before any pawn exists, or the owner as a last resort
+	void GatherFocusLocations(TArray<FVector>& OutLocations) const;
+
+	// Farthest first so the nearest room is popped from the back
+	TArray<FRoomSpawnRequest> Pending;
+	double LastPrioritizeSeconds = 0.0;
+};
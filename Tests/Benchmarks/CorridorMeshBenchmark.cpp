@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Corridor mesh generation over generated layouts: time per spanning tree edge on one worker and on every worker,
+// which should stay flat as the dungeon grows.
+// Usage: CorridorMeshBenchmark [MaxRooms]
+
+#include "DungeonLayout.h"
+#include "LayoutCorridorMesh.h"
+#include "LayoutParallel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace DungeonLayout;
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	double MillisecondsSince(FClock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+	}
+
+	double TimeMesh(const FDungeonLayout& Layout, const FCorridorMeshParams& Params, size_t& OutNumSections, size_t& OutNumTriangles)
+	{
+		// Best of three, the first run pays for the page faults
+		double BestMs = 0;
+		for (int32_t Run = 0; Run < 3; ++Run)
+		{
+			const FClock::time_point Start = FClock::now();
+			std::vector<FCorridorMeshSection> Sections;
+			BuildCorridorMesh(Layout, Params, Sections);
+			const double Ms = MillisecondsSince(Start);
+			BestMs = Run == 0 ? Ms : (Ms < BestMs ? Ms : BestMs);
+
+			OutNumSections = Sections.size();
+			OutNumTriangles = 0;
+			for (const FCorridorMeshSection& Section : Sections)
+			{
+				OutNumTriangles += Section.Indices.size() / 3;
+			}
+		}
+		return BestMs;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const int32_t MaxRooms = Argc > 1 ? std::atoi(Argv[1]) : 8000;
+	const int32_t NumThreads = static_cast<int32_t>(std::thread::hardware_concurrency());
+
+	std::printf("%8s %8s %10s %10s %12s %12s %12s %12s\n", "Rooms", "Edges", "Sections", "Triangles", "1 thread(ms)", "us/edge", "All(ms)", "us/edge");
+	for (int32_t NumRooms = 500; NumRooms <= MaxRooms; NumRooms *= 2)
+	{
+		FLayoutParams Params;
+		Params.RoomsToSpawn = NumRooms;
+		Params.NumberOfBigRoomsToSelect = NumRooms / 2;
+		// Constant room density, the grid grows with the room count
+		Params.GenerationRadius = 250.f * std::sqrt(static_cast<float>(NumRooms));
+		Params.Seed = 3;
+		Params.SeparationSolver = ESeparationSolver::Jacobi;
+		const FDungeonLayout Layout = GenerateDungeonLayout(Params);
+		const double NumEdges = static_cast<double>(Layout.MinimumSpanningTree.size());
+
+		FCorridorMeshParams MeshParams;
+		MeshParams.CellSize = Params.CorridorCellSize;
+		size_t NumSections = 0;
+		size_t NumTriangles = 0;
+		SetNumWorkerThreads(1);
+		const double SerialMs = TimeMesh(Layout, MeshParams, NumSections, NumTriangles);
+		SetNumWorkerThreads(NumThreads);
+		const double ParallelMs = TimeMesh(Layout, MeshParams, NumSections, NumTriangles);
+
+		std::printf("%8d %8d %10d %10d %12.2f %12.2f %12.2f %12.2f\n", NumRooms, static_cast<int32_t>(NumEdges),
+			static_cast<int32_t>(NumSections), static_cast<int32_t>(NumTriangles), SerialMs, SerialMs * 1000.0 / NumEdges,
+			ParallelMs, ParallelMs * 1000.0 / NumEdges);
+	}
+	return 0;
+}
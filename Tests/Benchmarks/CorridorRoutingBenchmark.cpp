@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Grid corridor routing over generated layouts: A* edges per second on one worker and on every worker.
+// Usage: CorridorRoutingBenchmark [MaxRooms]
+
+#include "DungeonLayout.h"
+#include "LayoutCorridorRouter.h"
+#include "LayoutParallel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace DungeonLayout;
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	double MillisecondsSince(FClock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+	}
+
+	double TimeRouting(const FDungeonLayout& Layout, double CellSize, size_t& OutNumRuns)
+	{
+		// Best of three, the first run pays for the page faults
+		double BestMs = 0;
+		for (int32_t Run = 0; Run < 3; ++Run)
+		{
+			const FClock::time_point Start = FClock::now();
+			FOccupancyGrid Grid;
+			Grid.Build(Layout.Rooms, CellSize);
+			std::vector<FCorridorCellRun> Runs;
+			RouteCorridorRuns(Layout, Grid, Runs);
+			const double Ms = MillisecondsSince(Start);
+			BestMs = Run == 0 ? Ms : (Ms < BestMs ? Ms : BestMs);
+			OutNumRuns = Runs.size();
+		}
+		return BestMs;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const int32_t MaxRooms = Argc > 1 ? std::atoi(Argv[1]) : 8000;
+	const int32_t NumThreads = static_cast<int32_t>(std::thread::hardware_concurrency());
+
+	std::printf("%8s %8s %8s %12s %14s %12s %14s\n", "Rooms", "Edges", "Runs", "1 thread(ms)", "Edges/s", "All(ms)", "Edges/s");
+	for (int32_t NumRooms = 500; NumRooms <= MaxRooms; NumRooms *= 2)
+	{
+		FLayoutParams Params;
+		Params.RoomsToSpawn = NumRooms;
+		Params.NumberOfBigRoomsToSelect = NumRooms / 2;
+		// Constant room density, the grid grows with the room count
+		Params.GenerationRadius = 250.f * std::sqrt(static_cast<float>(NumRooms));
+		Params.Seed = 3;
+		Params.SeparationSolver = ESeparationSolver::Jacobi;
+		const FDungeonLayout Layout = GenerateDungeonLayout(Params);
+		const double NumEdges = static_cast<double>(Layout.MinimumSpanningTree.size());
+
+		size_t NumRuns = 0;
+		SetNumWorkerThreads(1);
+		const double SerialMs = TimeRouting(Layout, Params.CorridorCellSize, NumRuns);
+		SetNumWorkerThreads(NumThreads);
+		const double ParallelMs = TimeRouting(Layout, Params.CorridorCellSize, NumRuns);
+
+		std::printf("%8d %8d %8d %12.1f %14.0f %12.1f %14.0f\n", NumRooms, static_cast<int32_t>(NumEdges), static_cast<int32_t>(NumRuns),
+			SerialMs, NumEdges / (SerialMs / 1000.0), ParallelMs, NumEdges / (ParallelMs / 1000.0));
+	}
+	return 0;
+}
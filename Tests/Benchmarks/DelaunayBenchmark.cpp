@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Scaling of the Delaunay triangulation, brute force Bowyer-Watson vs the adjacency based triangulator,
+// and of the room graph built from it.
+// Usage: DelaunayBenchmark [MaxPoints]
+
+#include "LayoutDelaunay.h"
+#include "LayoutGraph.h"
+#include "LayoutRandom.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace DungeonLayout;
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	double MillisecondsSince(FClock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const int32_t MaxPoints = Argc > 1 ? std::atoi(Argv[1]) : 1000000;
+	// Above this the brute force triangulation takes longer than the whole benchmark should
+	const int32_t MaxBruteForcePoints = 5000;
+
+	std::printf("%10s %12s %16s %16s %10s %10s\n", "Points", "Triangles", "BruteForce(ms)", "Adjacency(ms)", "Edges", "Graph(ms)");
+	for (int32_t NumPoints = 1000; NumPoints <= MaxPoints; NumPoints *= 10)
+	{
+		FLayoutRandom Random(99);
+		std::vector<FVec2> Points(NumPoints);
+		for (FVec2& Point : Points)
+		{
+			Point = FVec2(Random.FRandRange(-1.e6, 1.e6), Random.FRandRange(-1.e6, 1.e6));
+		}
+
+		std::vector<FLayoutTriangle> Triangles;
+		char BruteText[32] = "-";
+		if (NumPoints <= MaxBruteForcePoints)
+		{
+			const FClock::time_point Start = FClock::now();
+			TriangulateBruteForce(Points, Triangles);
+			std::snprintf(BruteText, sizeof(BruteText), "%.1f", MillisecondsSince(Start));
+		}
+
+		const FClock::time_point Start = FClock::now();
+		Triangulate(Points, Triangles);
+		const double AdjacencyMs = MillisecondsSince(Start);
+
+		FLayoutGraph Graph;
+		const FClock::time_point GraphStart = FClock::now();
+		BuildRoomGraph(Points, Triangles, Graph);
+		const double GraphMs = MillisecondsSince(GraphStart);
+
+		std::printf("%10d %12zu %16s %16.1f %10d %10.1f\n", NumPoints, Triangles.size(), BruteText, AdjacencyMs, Graph.NumEdges(), GraphMs);
+	}
+	return 0;
+}
@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Every layout stage on its own, from 10^2 rooms up by powers of ten: wall time, heap allocations, heap peak and
+// process peak memory per stage, written as JSON to track regressions between releases.
+// Room density is kept constant across room counts. Separation stops at MaxSeparationIterations (the game's 10000 by
+// default), so the largest counts measure capped passes rather than convergence; lower it to reach 10^6 rooms.
+// Usage: PipelineBenchmark [MaxRooms] [Output.json|-] [MaxSeparationIterations]    (- writes to stdout)
+
+#include "DungeonLayout.h"
+#include "LayoutCache.h"
+#include "LayoutCorridorMesh.h"
+#include "LayoutCorridorRouter.h"
+#include "LayoutCorridors.h"
+#include "LayoutDelaunay.h"
+#include "LayoutGraph.h"
+#include "LayoutParallel.h"
+#include "LayoutRooms.h"
+#include "LayoutSeparation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace DungeonLayout;
+
+// Global new and delete count every heap allocation of the process. Each block carries its size in front of it.
+namespace
+{
+	constexpr size_t AllocationHeaderSize = alignof(std::max_align_t);
+
+	std::atomic<uint64_t> NumAllocations(0);
+	std::atomic<uint64_t> AllocatedBytes(0);
+	std::atomic<int64_t> LiveBytes(0);
+	std::atomic<int64_t> PeakLiveBytes(0);
+
+	void* TrackedAlloc(size_t Size)
+	{
+		void* Block = std::malloc(Size + AllocationHeaderSize);
+		if (!Block)
+		{
+			return nullptr;
+		}
+		*static_cast<size_t*>(Block) = Size;
+		++NumAllocations;
+		AllocatedBytes += Size;
+		const int64_t Live = LiveBytes += static_cast<int64_t>(Size);
+		int64_t Peak = PeakLiveBytes.load();
+		while (Live > Peak && !PeakLiveBytes.compare_exchange_weak(Peak, Live))
+		{
+		}
+		return static_cast<char*>(Block) + AllocationHeaderSize;
+	}
+
+	void TrackedFree(void* Pointer)
+	{
+		if (!Pointer)
+		{
+			return;
+		}
+		void* Block = static_cast<char*>(Pointer) - AllocationHeaderSize;
+		LiveBytes -= static_cast<int64_t>(*static_cast<size_t*>(Block));
+		std::free(Block);
+	}
+
+	void* TrackedNew(size_t Size)
+	{
+		void* Pointer = TrackedAlloc(Size);
+		if (!Pointer)
+		{
+			throw std::bad_alloc();
+		}
+		return Pointer;
+	}
+}
+
+void* operator new(size_t Size) { return TrackedNew(Size); }
+void* operator new[](size_t Size) { return TrackedNew(Size); }
+void* operator new(size_t Size, const std::nothrow_t&) noexcept { return TrackedAlloc(Size); }
+void* operator new[](size_t Size, const std::nothrow_t&) noexcept { return TrackedAlloc(Size); }
+void operator delete(void* Pointer) noexcept { TrackedFree(Pointer); }
+void operator delete[](void* Pointer) noexcept { TrackedFree(Pointer); }
+void operator delete(void* Pointer, size_t) noexcept { TrackedFree(Pointer); }
+void operator delete[](void* Pointer, size_t) noexcept { TrackedFree(Pointer); }
+void operator delete(void* Pointer, const std::nothrow_t&) noexcept { TrackedFree(Pointer); }
+void operator delete[](void* Pointer, const std::nothrow_t&) noexcept { TrackedFree(Pointer); }
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	int64_t GetPeakResidentKilobytes()
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		rusage Usage;
+		getrusage(RUSAGE_SELF, &Usage);
+#if defined(__APPLE__)
+		return static_cast<int64_t>(Usage.ru_maxrss / 1024);
+#else
+		return static_cast<int64_t>(Usage.ru_maxrss);
+#endif
+#else
+		return -1;
+#endif
+	}
+
+	struct FStageSample
+	{
+		std::string Name;
+		double Milliseconds = 0.0;
+		uint64_t Allocations = 0;
+		uint64_t AllocatedBytes = 0;
+		// Highest heap use above the start of the stage
+		int64_t PeakHeapBytes = 0;
+		// Process high-water mark after the stage, it never goes down
+		int64_t PeakResidentKilobytes = 0;
+	};
+
+	template <typename FunctionType>
+	FStageSample MeasureStage(const char* Name, FunctionType&& Stage)
+	{
+		FStageSample Sample;
+		Sample.Name = Name;
+		const uint64_t StartAllocations = NumAllocations.load();
+		const uint64_t StartBytes = AllocatedBytes.load();
+		const int64_t StartLive = LiveBytes.load();
+		PeakLiveBytes.store(StartLive);
+
+		const FClock::time_point Start = FClock::now();
+		Stage();
+		Sample.Milliseconds = std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+
+		Sample.Allocations = NumAllocations.load() - StartAllocations;
+		Sample.AllocatedBytes = AllocatedBytes.load() - StartBytes;
+		Sample.PeakHeapBytes = PeakLiveBytes.load() - StartLive;
+		Sample.PeakResidentKilobytes = GetPeakResidentKilobytes();
+		return Sample;
+	}
+
+	struct FPipelineRun
+	{
+		int32_t NumRooms = 0;
+		int32_t NumSelected = 0;
+		int32_t NumEdges = 0;
+		int32_t SeparationIterations = 0;
+		bool bSeparationConverged = false;
+		std::vector<FStageSample> Stages;
+	};
+
+	FPipelineRun RunPipeline(int32_t NumRooms, int32_t MaxSeparationIterations)
+	{
+		FLayoutParams Params;
+		Params.RoomsToSpawn = NumRooms;
+		Params.MaxSeparationIterations = MaxSeparationIterations;
+		Params.NumberOfBigRoomsToSelect = std::max(NumRooms / 4, 2);
+		Params.GenerationRadius = 250.f * std::sqrt(static_cast<float>(NumRooms));
+		Params.Seed = 7;
+		Params.SeparationSolver = ESeparationSolver::Jacobi;
+
+		FPipelineRun Run;
+		Run.NumRooms = NumRooms;
+		FDungeonLayout Layout;
+		FSeparationResult Separation;
+		std::vector<FVec2> Points;
+		FRoomConnectivity Connectivity;
+
+		Run.Stages.push_back(MeasureStage("scatter", [&]() { ScatterRooms(Params, Layout.Rooms); }));
+		Run.Stages.push_back(MeasureStage("separation", [&]()
+		{
+			Separation = SeparateRooms(Layout.Rooms, Params.MaxSeparationIterations, Params.SeparationSolver);
+		}));
+		Run.Stages.push_back(MeasureStage("selection", [&]()
+		{
+			SelectBiggestRooms(Layout.Rooms, Params.NumberOfBigRoomsToSelect, Layout.SelectedRooms);
+			GatherSelectedCenters(Layout, Points);
+		}));
+		Run.Stages.push_back(MeasureStage("delaunay", [&]() { Triangulate(Points, Connectivity.Triangles); }));
+		Run.Stages.push_back(MeasureStage("room_graph", [&]() { BuildRoomGraph(Points, Connectivity.Triangles, Connectivity.Graph); }));
+		Run.Stages.push_back(MeasureStage("spanning_tree", [&]()
+		{
+			ComputeMinimumSpanningTree(Connectivity.Graph, Connectivity.SpanningTree, Params.MstAlgorithm);
+			SetMinimumSpanningTree(Layout, Connectivity.SpanningTree);
+		}));
+
+		// Both routings start from the same tree
+		FDungeonLayout Straight = Layout;
+		Run.Stages.push_back(MeasureStage("corridors_straight", [&]() { BuildCorridors(Straight); }));
+		FDungeonLayout Grid = Layout;
+		Run.Stages.push_back(MeasureStage("corridors_grid", [&]() { RouteCorridors(Grid, Params.CorridorCellSize); }));
+		Run.Stages.push_back(MeasureStage("corridor_mesh", [&]()
+		{
+			FCorridorMeshParams MeshParams;
+			MeshParams.CellSize = Params.CorridorCellSize;
+			std::vector<FCorridorMeshSection> Sections;
+			BuildCorridorMesh(Grid, MeshParams, Sections);
+		}));
+
+		Run.NumSelected = static_cast<int32_t>(Layout.SelectedRooms.size());
+		Run.NumEdges = static_cast<int32_t>(Layout.MinimumSpanningTree.size());
+		Run.SeparationIterations = Separation.Iterations;
+		Run.bSeparationConverged = Separation.bConverged;
+		return Run;
+	}
+
+	void WriteJson(std::FILE* File, const std::vector<FPipelineRun>& Runs, int32_t MaxSeparationIterations)
+	{
+		std::fprintf(File, "{\n  \"benchmark\": \"pipeline\",\n  \"algorithm_version\": %u,\n  \"worker_threads\": %d,\n  \"max_separation_iterations\": %d,\n  \"runs\": [",
+			static_cast<unsigned>(LayoutAlgorithmVersion), GetNumWorkerThreads(), MaxSeparationIterations);
+		for (size_t RunIndex = 0; RunIndex < Runs.size(); ++RunIndex)
+		{
+			const FPipelineRun& Run = Runs[RunIndex];
+			std::fprintf(File, "%s\n    {\n      \"rooms\": %d,\n      \"selected\": %d,\n      \"edges\": %d,\n"
+				"      \"separation_iterations\": %d,\n      \"separation_converged\": %s,\n      \"stages\": [",
+				RunIndex > 0 ? "," : "", Run.NumRooms, Run.NumSelected, Run.NumEdges, Run.SeparationIterations,
+				Run.bSeparationConverged ? "true" : "false");
+			for (size_t StageIndex = 0; StageIndex < Run.Stages.size(); ++StageIndex)
+			{
+				const FStageSample& Stage = Run.Stages[StageIndex];
+				std::fprintf(File, "%s\n        { \"name\": \"%s\", \"ms\": %.3f, \"allocations\": %llu, \"allocated_bytes\": %llu, "
+					"\"peak_heap_bytes\": %lld, \"peak_rss_kb\": %lld }",
+					StageIndex > 0 ? "," : "", Stage.Name.c_str(), Stage.Milliseconds,
+					static_cast<unsigned long long>(Stage.Allocations), static_cast<unsigned long long>(Stage.AllocatedBytes),
+					static_cast<long long>(Stage.PeakHeapBytes), static_cast<long long>(Stage.PeakResidentKilobytes));
+			}
+			std::fprintf(File, "\n      ]\n    }");
+		}
+		std::fprintf(File, "\n  ]\n}\n");
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const int32_t MaxRooms = Argc > 1 ? std::atoi(Argv[1]) : 10000;
+	const char* OutputPath = Argc > 2 && std::string(Argv[2]) != "-" ? Argv[2] : nullptr;
+	const int32_t MaxSeparationIterations = Argc > 3 ? std::atoi(Argv[3]) : FLayoutParams().MaxSeparationIterations;
+
+	std::vector<FPipelineRun> Runs;
+	for (int32_t NumRooms = 100; NumRooms <= MaxRooms; NumRooms *= 10)
+	{
+		Runs.push_back(RunPipeline(NumRooms, MaxSeparationIterations));
+		std::fprintf(stderr, "%d rooms done\n", NumRooms);
+	}
+
+	std::FILE* File = OutputPath ? std::fopen(OutputPath, "w") : stdout;
+	if (!File)
+	{
+		std::fprintf(stderr, "Cannot write %s\n", OutputPath);
+		return 1;
+	}
+	WriteJson(File, Runs, MaxSeparationIterations);
+	if (File != stdout)
+	{
+		std::fclose(File);
+	}
+	return 0;
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Scaling of one separation pass, brute force vs spatial hash broadphase, and of a full
+// separation with the broadphase, serial (Gauss-Seidel) and parallel (Jacobi).
+// Room density is kept constant across room counts.
+// Usage: DungeonLayoutBenchmarks [MaxRooms]
+
+#include "LayoutRooms.h"
+#include "LayoutSeparation.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace DungeonLayout;
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	double MillisecondsSince(FClock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+	}
+
+	std::vector<FLayoutRoom> MakeRooms(int32_t NumRooms)
+	{
+		FLayoutParams Params;
+		Params.RoomsToSpawn = NumRooms;
+		Params.GenerationRadius = static_cast<float>(400.0 * std::sqrt(static_cast<double>(NumRooms)));
+		Params.Seed = 1234;
+
+		FLayoutRandom Random(Params.Seed);
+		std::vector<FLayoutRoom> Rooms;
+		ScatterRooms(Params, Random, Rooms);
+		return Rooms;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const int32_t MaxRooms = Argc > 1 ? std::atoi(Argv[1]) : 100000;
+	// Above these the brute force pass and the full separation take longer than the whole benchmark should
+	const int32_t MaxBruteForceRooms = 20000;
+	const int32_t MaxConvergeRooms = 20000;
+	const int32_t NumTimedSteps = 10;
+
+	std::printf("%10s %16s %16s %12s %18s %12s %18s\n", "Rooms", "BruteStep(ms)", "HashStep(ms)",
+		"Iterations", "HashConverge(ms)", "JacobiIter", "JacobiConverge(ms)");
+	for (int32_t NumRooms = 100; NumRooms <= MaxRooms; NumRooms *= 10)
+	{
+		double BruteStepMs = -1.0;
+		if (NumRooms <= MaxBruteForceRooms)
+		{
+			std::vector<FLayoutRoom> Rooms = MakeRooms(NumRooms);
+			const FClock::time_point Start = FClock::now();
+			SeparateRoomsStepBruteForce(Rooms);
+			BruteStepMs = MillisecondsSince(Start);
+		}
+
+		// Average over the first steps, they have the most overlaps
+		std::vector<FLayoutRoom> Rooms = MakeRooms(NumRooms);
+		FRoomSpatialHash Broadphase(ComputeBroadphaseCellSize(Rooms));
+		FClock::time_point Start = FClock::now();
+		for (int32_t Step = 0; Step < NumTimedSteps; ++Step)
+		{
+			SeparateRoomsStep(Rooms, Broadphase);
+		}
+		const double HashStepMs = MillisecondsSince(Start) / NumTimedSteps;
+
+		char BruteText[32] = "-";
+		if (BruteStepMs >= 0.0)
+		{
+			std::snprintf(BruteText, sizeof(BruteText), "%.3f", BruteStepMs);
+		}
+
+		char ConvergeText[2][2][32] = { { "-", "-" }, { "-", "-" } };
+		if (NumRooms <= MaxConvergeRooms)
+		{
+			const ESeparationSolver Solvers[2] = { ESeparationSolver::GaussSeidel, ESeparationSolver::Jacobi };
+			for (int32_t SolverIndex = 0; SolverIndex < 2; ++SolverIndex)
+			{
+				Rooms = MakeRooms(NumRooms);
+				Start = FClock::now();
+				const FSeparationResult Result = SeparateRooms(Rooms, 100000, Solvers[SolverIndex]);
+				std::snprintf(ConvergeText[SolverIndex][0], sizeof(ConvergeText[SolverIndex][0]), "%d", Result.Iterations);
+				std::snprintf(ConvergeText[SolverIndex][1], sizeof(ConvergeText[SolverIndex][1]), "%.1f", MillisecondsSince(Start));
+			}
+		}
+
+		std::printf("%10d %16s %16.3f %12s %18s %12s %18s\n", NumRooms, BruteText, HashStepMs,
+			ConvergeText[0][0], ConvergeText[0][1], ConvergeText[1][0], ConvergeText[1][1]);
+	}
+	return 0;
+}
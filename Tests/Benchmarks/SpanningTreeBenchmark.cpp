@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Minimum spanning tree of Delaunay room graphs, Prim on the 4-ary heap vs Kruskal with radix sort and union-find.
+// Usage: SpanningTreeBenchmark [MaxPoints]
+
+#include "LayoutDelaunay.h"
+#include "LayoutGraph.h"
+#include "LayoutRandom.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace DungeonLayout;
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	double MillisecondsSince(FClock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+	}
+
+	double TimeSpanningTree(const FLayoutGraph& Graph, EMstAlgorithm Algorithm, double& OutTotalWeight)
+	{
+		// Best of three, the first run pays for the page faults
+		double BestMs = 0;
+		std::vector<FLayoutEdge> Tree;
+		for (int32_t Run = 0; Run < 3; ++Run)
+		{
+			const FClock::time_point Start = FClock::now();
+			ComputeMinimumSpanningTree(Graph, Tree, Algorithm);
+			const double Ms = MillisecondsSince(Start);
+			BestMs = Run == 0 ? Ms : (Ms < BestMs ? Ms : BestMs);
+		}
+
+		OutTotalWeight = 0;
+		for (const FLayoutEdge& Edge : Tree)
+		{
+			OutTotalWeight += Edge.Weight;
+		}
+		return BestMs;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const int32_t MaxPoints = Argc > 1 ? std::atoi(Argv[1]) : 1000000;
+
+	std::printf("%10s %10s %10s %12s %16s\n", "Points", "Edges", "Prim(ms)", "Kruskal(ms)", "WeightDelta");
+	for (int32_t NumPoints = 1000; NumPoints <= MaxPoints; NumPoints *= 10)
+	{
+		FLayoutRandom Random(7);
+		std::vector<FVec2> Points(NumPoints);
+		for (FVec2& Point : Points)
+		{
+			Point = FVec2(Random.FRandRange(-1.e6, 1.e6), Random.FRandRange(-1.e6, 1.e6));
+		}
+
+		std::vector<FLayoutTriangle> Triangles;
+		Triangulate(Points, Triangles);
+		FLayoutGraph Graph;
+		BuildRoomGraph(Points, Triangles, Graph);
+
+		double PrimWeight;
+		double KruskalWeight;
+		const double PrimMs = TimeSpanningTree(Graph, EMstAlgorithm::Prim, PrimWeight);
+		const double KruskalMs = TimeSpanningTree(Graph, EMstAlgorithm::Kruskal, KruskalWeight);
+
+		std::printf("%10d %10d %10.1f %12.1f %16g\n", NumPoints, Graph.NumEdges(), PrimMs, KruskalMs, PrimWeight - KruskalWeight);
+	}
+	return 0;
+}
@@ -0,0 +1,1191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutTestHarness.h"
+
+#include "DungeonLayout.h"
+#include "LayoutCache.h"
+#include "LayoutChunks.h"
+#include "LayoutCompression.h"
+#include "LayoutCorridorMesh.h"
+#include "LayoutCorridorRouter.h"
+#include "LayoutCorridors.h"
+#include "LayoutDelaunay.h"
+#include "LayoutFile.h"
+#include "LayoutGraph.h"
+#include "LayoutParallel.h"
+#include "LayoutReplication.h"
+#include "LayoutRooms.h"
+#include "LayoutPredicates.h"
+#include "LayoutSeparation.h"
+#include "LayoutStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+using namespace DungeonLayout;
+
+namespace
+{
+	FLayoutParams MakeTestParams(int32_t NumRooms, int32_t NumSelected, uint64_t Seed)
+	{
+		FLayoutParams Params;
+		Params.RoomsToSpawn = NumRooms;
+		Params.NumberOfBigRoomsToSelect = NumSelected;
+		Params.RoomSizeMin = 1.f;
+		Params.RoomSizeMax = 8.f;
+		Params.GenerationRadius = 2000.f;
+		Params.Seed = Seed;
+		return Params;
+	}
+
+	bool HasAnyOverlap(const std::vector<FLayoutRoom>& Rooms)
+	{
+		for (size_t i = 0; i < Rooms.size(); ++i)
+		{
+			for (size_t j = i + 1; j < Rooms.size(); ++j)
+			{
+				const FVec2 Overlap = ComputeRoomOverlap(Rooms[i], Rooms[j]);
+				if (Overlap.X > 0 && Overlap.Y > 0)
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// Edges must reach every node exactly once
+	bool IsSpanningTree(int32_t NumNodes, const std::vector<FLayoutEdge>& Edges)
+	{
+		if (NumNodes == 0)
+		{
+			return Edges.empty();
+		}
+
+		std::vector<int32_t> Parent(NumNodes);
+		for (int32_t i = 0; i < NumNodes; ++i)
+		{
+			Parent[i] = i;
+		}
+		auto Find = [&Parent](int32_t Node)
+		{
+			while (Parent[Node] != Node)
+			{
+				Node = Parent[Node] = Parent[Parent[Node]];
+			}
+			return Node;
+		};
+
+		for (const FLayoutEdge& Edge : Edges)
+		{
+			const int32_t RootA = Find(Edge.A);
+			const int32_t RootB = Find(Edge.B);
+			if (RootA == RootB)
+			{
+				return false;
+			}
+			Parent[RootA] = RootB;
+		}
+		return static_cast<int32_t>(Edges.size()) == NumNodes - 1;
+	}
+
+	bool AreLayoutsIdentical(const FDungeonLayout& A, const FDungeonLayout& B)
+	{
+		if (A.Rooms.size() != B.Rooms.size() || A.MinimumSpanningTree.size() != B.MinimumSpanningTree.size()
+			|| A.Corridors.size() != B.Corridors.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < A.Rooms.size(); ++i)
+		{
+			if (A.Rooms[i].Center != B.Rooms[i].Center || A.Rooms[i].HalfExtents != B.Rooms[i].HalfExtents)
+			{
+				return false;
+			}
+		}
+		for (size_t i = 0; i < A.Corridors.size(); ++i)
+		{
+			if (A.Corridors[i].Start != B.Corridors[i].Start || A.Corridors[i].End != B.Corridors[i].End)
+			{
+				return false;
+			}
+		}
+		return A.SelectedRooms == B.SelectedRooms && A.CorridorRooms == B.CorridorRooms && A.Triangles == B.Triangles;
+	}
+
+	FCachedLayout GenerateCachedLayout(const FLayoutParams& Params)
+	{
+		FCachedLayout Cached;
+		Cached.Layout = GenerateDungeonLayout(Params, &Cached.Separation);
+		return Cached;
+	}
+}
+
+LAYOUT_TEST(ScatterStaysInsideTheGenerationRadius)
+{
+	const FLayoutParams Params = MakeTestParams(500, 10, 7);
+	FLayoutRandom Random(Params.Seed);
+	std::vector<FLayoutRoom> Rooms;
+	ScatterRooms(Params, Random, Rooms);
+
+	EXPECT_EQ(500u, Rooms.size());
+	for (int32_t i = 0; i < static_cast<int32_t>(Rooms.size()); ++i)
+	{
+		EXPECT_EQ(i, Rooms[i].Id);
+		EXPECT_TRUE(FVec2::Dist(Rooms[i].Center, Params.GenerationCenter) <= Params.GenerationRadius);
+		EXPECT_TRUE(Rooms[i].HalfExtents.X >= Params.RoomSizeMin * Params.RoomUnitSize * 0.5);
+		EXPECT_TRUE(Rooms[i].HalfExtents.X <= Params.RoomSizeMax * Params.RoomUnitSize * 0.5);
+	}
+}
+
+LAYOUT_TEST(ScatterDrawsOneSubstreamPerRoom)
+{
+	FLayoutParams Params = MakeTestParams(300, 10, 11);
+	std::vector<FLayoutRoom> Rooms;
+	ScatterRooms(Params, Rooms);
+
+	Params.RoomsToSpawn = 120;
+	std::vector<FLayoutRoom> FewerRooms;
+	ScatterRooms(Params, FewerRooms);
+
+	bool bIdentical = true;
+	for (size_t i = 0; i < FewerRooms.size(); ++i)
+	{
+		bIdentical &= FewerRooms[i].Center == Rooms[i].Center && FewerRooms[i].HalfExtents == Rooms[i].HalfExtents;
+	}
+	EXPECT_TRUE(bIdentical);
+
+	// Splitting never advances the parent stream
+	const FLayoutRandom Random(Params.Seed);
+	FLayoutRandom First = Random.Split(ELayoutStream::Scatter);
+	FLayoutRandom Second = Random.Split(ELayoutStream::Scatter);
+	EXPECT_EQ(First.NextUInt64(), Second.NextUInt64());
+	EXPECT_TRUE(Random.Split(uint64_t(0)).NextUInt64() != Random.Split(uint64_t(1)).NextUInt64());
+}
+
+LAYOUT_TEST(LayoutIsReproducibleFromTheSeed)
+{
+	FLayoutParams Params = MakeTestParams(600, 20, 77);
+	Params.SeparationSolver = ESeparationSolver::Jacobi;
+
+	SetNumWorkerThreads(1);
+	const FDungeonLayout Reference = GenerateDungeonLayout(Params);
+	SetNumWorkerThreads(6);
+	const FDungeonLayout Layout = GenerateDungeonLayout(Params);
+	SetNumWorkerThreads(0);
+
+	bool bIdentical = Layout.Rooms.size() == Reference.Rooms.size();
+	for (size_t i = 0; bIdentical && i < Layout.Rooms.size(); ++i)
+	{
+		bIdentical &= Layout.Rooms[i].Center == Reference.Rooms[i].Center;
+	}
+	EXPECT_TRUE(bIdentical);
+	EXPECT_TRUE(Layout.SelectedRooms == Reference.SelectedRooms);
+	EXPECT_TRUE(Layout.CorridorRooms == Reference.CorridorRooms);
+	EXPECT_EQ(Reference.MinimumSpanningTree.size(), Layout.MinimumSpanningTree.size());
+
+	Params.Seed = 78;
+	const FDungeonLayout Other = GenerateDungeonLayout(Params);
+	EXPECT_TRUE(!(Other.Rooms[0].Center == Reference.Rooms[0].Center));
+}
+
+LAYOUT_TEST(SeparationRemovesEveryOverlap)
+{
+	const FLayoutParams Params = MakeTestParams(300, 10, 11);
+	FLayoutRandom Random(Params.Seed);
+	std::vector<FLayoutRoom> Rooms;
+	ScatterRooms(Params, Random, Rooms);
+	EXPECT_TRUE(HasAnyOverlap(Rooms));
+
+	const FSeparationResult Result = SeparateRooms(Rooms, Params.MaxSeparationIterations);
+	EXPECT_TRUE(Result.bConverged);
+	EXPECT_EQ(0.0, Result.ResidualOverlap);
+	EXPECT_TRUE(!HasAnyOverlap(Rooms));
+}
+
+LAYOUT_TEST(TimeSlicedSeparationMatchesBlockingSeparation)
+{
+	const FLayoutParams Params = MakeTestParams(300, 10, 13);
+	FLayoutRandom Random(Params.Seed);
+	std::vector<FLayoutRoom> BlockingRooms;
+	ScatterRooms(Params, Random, BlockingRooms);
+	std::vector<FLayoutRoom> SlicedRooms = BlockingRooms;
+
+	const FSeparationResult BlockingResult = SeparateRooms(BlockingRooms, Params.MaxSeparationIterations);
+
+	// A tiny budget still runs one pass per call
+	FRoomSeparator Separator(ComputeBroadphaseCellSize(SlicedRooms), Params.MaxSeparationIterations);
+	int32_t NumSlices = 0;
+	while (!Separator.Run(SlicedRooms, 1.e-6))
+	{
+		++NumSlices;
+	}
+
+	EXPECT_TRUE(NumSlices > 0);
+	EXPECT_EQ(BlockingResult.Iterations, Separator.GetResult().Iterations);
+	for (size_t i = 0; i < BlockingRooms.size(); ++i)
+	{
+		EXPECT_TRUE(BlockingRooms[i].Center == SlicedRooms[i].Center);
+	}
+}
+
+LAYOUT_TEST(JacobiSeparationIsIndependentOfThreadCount)
+{
+	FLayoutParams Params = MakeTestParams(2000, 10, 19);
+	Params.GenerationRadius = 15000.f;
+	FLayoutRandom Random(Params.Seed);
+	std::vector<FLayoutRoom> ScatteredRooms;
+	ScatterRooms(Params, Random, ScatteredRooms);
+
+	std::vector<FLayoutRoom> Reference;
+	FSeparationResult ReferenceResult;
+	const int32_t ThreadCounts[3] = { 1, 4, 7 };
+	for (int32_t NumThreads : ThreadCounts)
+	{
+		SetNumWorkerThreads(NumThreads);
+		std::vector<FLayoutRoom> Rooms = ScatteredRooms;
+		const FSeparationResult Result = SeparateRooms(Rooms, Params.MaxSeparationIterations, ESeparationSolver::Jacobi);
+		EXPECT_TRUE(Result.bConverged);
+
+		if (Reference.empty())
+		{
+			Reference = Rooms;
+			ReferenceResult = Result;
+			EXPECT_TRUE(!HasAnyOverlap(Rooms));
+			continue;
+		}
+
+		EXPECT_EQ(ReferenceResult.Iterations, Result.Iterations);
+		bool bIdentical = true;
+		for (size_t i = 0; i < Rooms.size(); ++i)
+		{
+			bIdentical &= Rooms[i].Center == Reference[i].Center;
+		}
+		EXPECT_TRUE(bIdentical);
+	}
+	SetNumWorkerThreads(0);
+}
+
+LAYOUT_TEST(SeparationReportsResidualOverlap)
+{
+	const FLayoutParams Params = MakeTestParams(300, 10, 17);
+	FLayoutRandom Random(Params.Seed);
+	std::vector<FLayoutRoom> Rooms;
+	ScatterRooms(Params, Random, Rooms);
+
+	const FSeparationResult Result = SeparateRooms(Rooms, 1);
+	EXPECT_TRUE(!Result.bConverged);
+	EXPECT_EQ(1, Result.Iterations);
+	EXPECT_TRUE(Result.ResidualOverlap > 0.0);
+}
+
+LAYOUT_TEST(BroadphaseFindsEveryOverlappingPair)
+{
+	const FLayoutParams Params = MakeTestParams(2000, 10, 5);
+	FLayoutRandom Random(Params.Seed);
+	std::vector<FLayoutRoom> Rooms;
+	ScatterRooms(Params, Random, Rooms);
+
+	FRoomSpatialHash Broadphase(ComputeBroadphaseCellSize(Params));
+	Broadphase.Build(Rooms);
+
+	int32_t NumOverlaps = 0;
+	int32_t NumFound = 0;
+	for (int32_t i = 0; i < static_cast<int32_t>(Rooms.size()); ++i)
+	{
+		for (int32_t j = i + 1; j < static_cast<int32_t>(Rooms.size()); ++j)
+		{
+			const FVec2 Overlap = ComputeRoomOverlap(Rooms[i], Rooms[j]);
+			NumOverlaps += (Overlap.X > 0 && Overlap.Y > 0) ? 1 : 0;
+		}
+
+		Broadphase.ForEachCandidate(i, [&Rooms, &NumFound, i](int32_t j)
+		{
+			const FVec2 Overlap = ComputeRoomOverlap(Rooms[i], Rooms[j]);
+			NumFound += (j > i && Overlap.X > 0 && Overlap.Y > 0) ? 1 : 0;
+		});
+	}
+
+	EXPECT_TRUE(NumOverlaps > 0);
+	EXPECT_EQ(NumOverlaps, NumFound);
+}
+
+LAYOUT_TEST(SelectionKeepsTheBiggestRooms)
+{
+	std::vector<FLayoutRoom> Rooms(5);
+	const float Areas[5] = { 4.f, 9.f, 1.f, 9.f, 16.f };
+	for (int32_t i = 0; i < 5; ++i)
+	{
+		Rooms[i].Id = i;
+		Rooms[i].Area = Areas[i];
+	}
+
+	std::vector<int32_t> Selected;
+	SelectBiggestRooms(Rooms, 3, Selected);
+	EXPECT_EQ(3u, Selected.size());
+	EXPECT_EQ(4, Selected[0]);
+	EXPECT_EQ(1, Selected[1]);
+	EXPECT_EQ(3, Selected[2]);
+
+	SelectBiggestRooms(Rooms, 50, Selected);
+	EXPECT_EQ(5u, Selected.size());
+}
+
+LAYOUT_TEST(TriangulationOfASquareHasTwoTriangles)
+{
+	const std::vector<FVec2> Points = { FVec2(0, 0), FVec2(100, 0), FVec2(100, 110), FVec2(0, 100) };
+	std::vector<FLayoutTriangle> Triangles;
+	Triangulate(Points, Triangles);
+	EXPECT_EQ(2u, Triangles.size());
+
+	FLayoutGraph Graph;
+	BuildRoomGraph(Points, Triangles, Graph);
+	EXPECT_EQ(5, Graph.NumEdges());
+	EXPECT_EQ(4, Graph.NumNodes());
+	EXPECT_EQ(10u, Graph.Neighbors.size());
+	for (const FLayoutEdge& Edge : Graph.Edges)
+	{
+		EXPECT_TRUE(Edge.A < Edge.B);
+		EXPECT_TRUE(std::fabs(Edge.Weight - FVec2::Dist(Points[Edge.A], Points[Edge.B])) < 1.e-3);
+	}
+}
+
+LAYOUT_TEST(TriangulationIsDelaunay)
+{
+	FLayoutRandom Random(3);
+	std::vector<FVec2> Points;
+	for (int32_t i = 0; i < 200; ++i)
+	{
+		Points.push_back(FVec2(Random.FRandRange(-1000, 1000), Random.FRandRange(-1000, 1000)));
+	}
+
+	std::vector<FLayoutTriangle> Triangles;
+	Triangulate(Points, Triangles);
+	EXPECT_TRUE(!Triangles.empty());
+
+	for (const FLayoutTriangle& Tri : Triangles)
+	{
+		FVec2 Center;
+		double Radius;
+		ComputeCircumscribedCircle(Points[Tri.A], Points[Tri.B], Points[Tri.C], Center, Radius);
+		for (const FVec2& Point : Points)
+		{
+			EXPECT_TRUE(FVec2::Dist(Center, Point) >= Radius * (1.0 - 1.e-9));
+		}
+	}
+}
+
+LAYOUT_TEST(TriangulationMatchesTheBruteForceReference)
+{
+	FLayoutRandom Random(23);
+	std::vector<FVec2> Points;
+	for (int32_t i = 0; i < 500; ++i)
+	{
+		Points.push_back(FVec2(Random.FRandRange(-5000, 5000), Random.FRandRange(-3000, 3000)));
+	}
+	std::vector<FLayoutTriangle> Reference;
+	TriangulateBruteForce(Points, Reference);
+
+	// Duplicates are skipped
+	Points.push_back(Points[10]);
+	Points.push_back(Points[20]);
+	std::vector<FLayoutTriangle> Triangles;
+	Triangulate(Points, Triangles);
+
+	// Compare as sets of sorted corner triples
+	auto Canonical = [](const std::vector<FLayoutTriangle>& InTriangles)
+	{
+		std::vector<std::vector<int32_t>> Keys;
+		for (const FLayoutTriangle& Tri : InTriangles)
+		{
+			std::vector<int32_t> Corners = { Tri.A, Tri.B, Tri.C };
+			std::sort(Corners.begin(), Corners.end());
+			Keys.push_back(Corners);
+		}
+		std::sort(Keys.begin(), Keys.end());
+		return Keys;
+	};
+
+	EXPECT_TRUE(!Triangles.empty());
+	EXPECT_TRUE(Canonical(Triangles) == Canonical(Reference));
+}
+
+LAYOUT_TEST(PredicatesAreExactNearDegeneracies)
+{
+	// Shewchuk's example: points a few ulps off the line through B and C. Plain doubles get most signs wrong.
+	const double Ulp = std::ldexp(1.0, -53);
+	const FVec2 B(12, 12);
+	const FVec2 C(24, 24);
+	for (int32_t i = 0; i < 32; ++i)
+	{
+		for (int32_t j = 0; j < 32; ++j)
+		{
+			const FVec2 A(0.5 + i * Ulp, 0.5 + j * Ulp);
+			const double Orientation = Orient2D(A, B, C);
+			EXPECT_TRUE((Orientation > 0) == (j > i) && (Orientation < 0) == (j < i));
+		}
+	}
+
+	// Corners of a square are cocircular, an ulp decides inside or outside
+	const FVec2 P0(0, 0), P1(1, 0), P2(1, 1);
+	EXPECT_TRUE(InCircle(P0, P1, P2, FVec2(0, 1)) == 0);
+	EXPECT_TRUE(InCircle(P0, P1, P2, FVec2(std::nextafter(0.0, 1.0), 1)) > 0);
+	EXPECT_TRUE(InCircle(P0, P1, P2, FVec2(0, std::nextafter(1.0, 2.0))) < 0);
+	EXPECT_TRUE(InCircleExact(P0, P1, P2, FVec2(0.5, 0.5)) > 0);
+	EXPECT_TRUE(Orient2DExact(P0, P1, P2) > 0);
+}
+
+LAYOUT_TEST(TriangulationOfASnappedGridIsValid)
+{
+	// Every 2x2 block of a grid is cocircular and every row colinear
+	const int32_t GridSize = 20;
+	const double Spacing = 100;
+	std::vector<FVec2> Points;
+	for (int32_t Y = 0; Y < GridSize; ++Y)
+	{
+		for (int32_t X = 0; X < GridSize; ++X)
+		{
+			Points.push_back(FVec2(X * Spacing, Y * Spacing));
+		}
+	}
+
+	std::vector<FLayoutTriangle> Triangles;
+	Triangulate(Points, Triangles);
+	EXPECT_EQ(static_cast<int32_t>(Triangles.size()), 2 * (GridSize - 1) * (GridSize - 1));
+
+	double Area = 0;
+	for (const FLayoutTriangle& Tri : Triangles)
+	{
+		const double Orientation = Orient2D(Points[Tri.A], Points[Tri.B], Points[Tri.C]);
+		EXPECT_TRUE(Orientation > 0);
+		Area += Orientation * 0.5;
+		for (const FVec2& Point : Points)
+		{
+			EXPECT_TRUE(InCircle(Points[Tri.A], Points[Tri.B], Points[Tri.C], Point) <= 0);
+		}
+	}
+	const double Side = (GridSize - 1) * Spacing;
+	EXPECT_TRUE(std::fabs(Area - Side * Side) < 1.e-6);
+}
+
+LAYOUT_TEST(MinimumSpanningTreeIsMinimal)
+{
+	// Square with one diagonal: the tree takes the three short sides
+	FLayoutGraph Graph;
+	BuildGraphFromEdges(4, {
+		FLayoutEdge(0, 1, 1.f),
+		FLayoutEdge(1, 2, 2.f),
+		FLayoutEdge(2, 3, 1.f),
+		FLayoutEdge(0, 3, 3.f),
+		FLayoutEdge(0, 2, 2.5f) }, Graph);
+
+	for (EMstAlgorithm Algorithm : { EMstAlgorithm::Prim, EMstAlgorithm::Kruskal })
+	{
+		std::vector<FLayoutEdge> Tree;
+		ComputeMinimumSpanningTree(Graph, Tree, Algorithm);
+		EXPECT_TRUE(IsSpanningTree(4, Tree));
+
+		float TotalWeight = 0.f;
+		for (const FLayoutEdge& Edge : Tree)
+		{
+			TotalWeight += Edge.Weight;
+		}
+		EXPECT_EQ(4.f, TotalWeight);
+	}
+}
+
+LAYOUT_TEST(PrimAndKruskalAgree)
+{
+	FLayoutRandom Random(5);
+	std::vector<FVec2> Points;
+	for (int32_t i = 0; i < 3000; ++i)
+	{
+		Points.push_back(FVec2(Random.FRandRange(-1.e5, 1.e5), Random.FRandRange(-1.e5, 1.e5)));
+	}
+	std::vector<FLayoutTriangle> Triangles;
+	Triangulate(Points, Triangles);
+	FLayoutGraph Graph;
+	BuildRoomGraph(Points, Triangles, Graph);
+
+	std::vector<FLayoutEdge> PrimTree;
+	std::vector<FLayoutEdge> KruskalTree;
+	ComputeMinimumSpanningTree(Graph, PrimTree, EMstAlgorithm::Prim);
+	ComputeMinimumSpanningTree(Graph, KruskalTree, EMstAlgorithm::Kruskal);
+	EXPECT_TRUE(IsSpanningTree(3000, PrimTree));
+	EXPECT_TRUE(IsSpanningTree(3000, KruskalTree));
+
+	double PrimWeight = 0;
+	double KruskalWeight = 0;
+	for (size_t i = 0; i < PrimTree.size(); ++i)
+	{
+		PrimWeight += PrimTree[i].Weight;
+		KruskalWeight += KruskalTree[i].Weight;
+	}
+	EXPECT_TRUE(std::fabs(PrimWeight - KruskalWeight) <= 1.e-6 * PrimWeight);
+
+	// Two components give a forest of NumNodes - 2 edges
+	FLayoutGraph Forest;
+	BuildGraphFromEdges(5, { FLayoutEdge(0, 1, 1.f), FLayoutEdge(1, 2, 1.f), FLayoutEdge(3, 4, 2.f) }, Forest);
+	for (EMstAlgorithm Algorithm : { EMstAlgorithm::Prim, EMstAlgorithm::Kruskal })
+	{
+		std::vector<FLayoutEdge> Tree;
+		ComputeMinimumSpanningTree(Forest, Tree, Algorithm);
+		EXPECT_EQ(3u, Tree.size());
+	}
+}
+
+LAYOUT_TEST(SegmentRoomIntersection)
+{
+	FLayoutRoom Room;
+	Room.Center = FVec2(0, 0);
+	Room.HalfExtents = FVec2(10, 5);
+
+	EXPECT_TRUE(SegmentIntersectsRoom(FVec2(-20, 0), FVec2(20, 0), Room));
+	EXPECT_TRUE(SegmentIntersectsRoom(FVec2(0, -20), FVec2(0, 20), Room));
+	EXPECT_TRUE(!SegmentIntersectsRoom(FVec2(-20, 6), FVec2(20, 6), Room));
+	EXPECT_TRUE(!SegmentIntersectsRoom(FVec2(11, -20), FVec2(11, 20), Room));
+	EXPECT_TRUE(!SegmentIntersectsRoom(FVec2(-20, 0), FVec2(-11, 0), Room));
+}
+
+LAYOUT_TEST(CorridorRoomFinderMatchesALinearScan)
+{
+	FDungeonLayout Layout = GenerateDungeonLayout(MakeTestParams(600, 20, 11));
+	Layout.CorridorRooms.clear();
+	FCorridorRoomFinder Finder(Layout);
+
+	std::vector<bool> Expected(Layout.Rooms.size(), false);
+	for (const FCorridorSegment& Segment : Layout.Corridors)
+	{
+		const size_t Before = Layout.CorridorRooms.size();
+		Finder.Add(Segment.Start, Segment.End);
+		EXPECT_TRUE(std::is_sorted(Layout.CorridorRooms.begin() + Before, Layout.CorridorRooms.end()));
+		for (const FLayoutRoom& Room : Layout.Rooms)
+		{
+			if (SegmentIntersectsRoom(Segment.Start, Segment.End, Room))
+			{
+				Expected[Room.Id] = true;
+			}
+		}
+	}
+	for (int32_t RoomIndex : Layout.SelectedRooms)
+	{
+		Expected[RoomIndex] = false;
+	}
+
+	std::vector<bool> Found(Layout.Rooms.size(), false);
+	for (int32_t RoomIndex : Layout.CorridorRooms)
+	{
+		// Each room once
+		EXPECT_TRUE(!Found[RoomIndex]);
+		Found[RoomIndex] = true;
+	}
+	EXPECT_TRUE(Found == Expected);
+}
+
+LAYOUT_TEST(PipelineProducesAConnectedDungeon)
+{
+	const FLayoutParams Params = MakeTestParams(400, 25, 42);
+	const FDungeonLayout Layout = GenerateDungeonLayout(Params);
+
+	EXPECT_EQ(400u, Layout.Rooms.size());
+	EXPECT_EQ(25u, Layout.SelectedRooms.size());
+	EXPECT_TRUE(!HasAnyOverlap(Layout.Rooms));
+	EXPECT_EQ(24u, Layout.MinimumSpanningTree.size());
+	EXPECT_TRUE(!Layout.Corridors.empty());
+
+	// Tree edges use room indices, remap them to selection order to check connectivity
+	std::vector<int32_t> RoomToSelected(Layout.Rooms.size(), -1);
+	for (int32_t i = 0; i < static_cast<int32_t>(Layout.SelectedRooms.size()); ++i)
+	{
+		RoomToSelected[Layout.SelectedRooms[i]] = i;
+	}
+	std::vector<FLayoutEdge> SelectedTree;
+	for (const FLayoutEdge& Edge : Layout.MinimumSpanningTree)
+	{
+		SelectedTree.push_back(FLayoutEdge(RoomToSelected[Edge.A], RoomToSelected[Edge.B], Edge.Weight));
+	}
+	EXPECT_TRUE(IsSpanningTree(25, SelectedTree));
+
+	for (int32_t RoomIndex : Layout.CorridorRooms)
+	{
+		EXPECT_TRUE(RoomToSelected[RoomIndex] < 0);
+	}
+}
+
+LAYOUT_TEST(SerializedLayoutRoundTrips)
+{
+	const FCachedLayout Cached = GenerateCachedLayout(MakeTestParams(300, 15, 5));
+	std::vector<uint8_t> Bytes;
+	WriteLayout(Cached, Bytes);
+
+	FCachedLayout Read;
+	EXPECT_TRUE(ReadLayout(Bytes.data(), Bytes.size(), Read));
+	EXPECT_TRUE(AreLayoutsIdentical(Cached.Layout, Read.Layout));
+	EXPECT_EQ(Cached.Separation.Iterations, Read.Separation.Iterations);
+
+	FCachedLayout Truncated;
+	EXPECT_TRUE(!ReadLayout(Bytes.data(), Bytes.size() - 1, Truncated));
+}
+
+LAYOUT_TEST(LayoutCacheEvictsTheLeastRecentlyUsed)
+{
+	FLayoutCache Cache(2);
+	const FLayoutParams First = MakeTestParams(100, 8, 1);
+	const FLayoutParams Second = MakeTestParams(100, 8, 2);
+	const FLayoutParams Third = MakeTestParams(100, 8, 3);
+
+	FCachedLayout Found;
+	EXPECT_TRUE(!Cache.Find(First, Found));
+	Cache.Add(First, GenerateCachedLayout(First));
+	Cache.Add(Second, GenerateCachedLayout(Second));
+	EXPECT_TRUE(Cache.Find(First, Found));
+	Cache.Add(Third, GenerateCachedLayout(Third));
+
+	EXPECT_TRUE(!Cache.Find(Second, Found));
+	EXPECT_TRUE(Cache.Find(First, Found));
+	EXPECT_TRUE(AreLayoutsIdentical(GenerateDungeonLayout(First), Found.Layout));
+
+	// Every parameter is part of the key
+	FLayoutParams Bigger = First;
+	Bigger.GenerationRadius += 1.f;
+	EXPECT_TRUE(!Cache.Find(Bigger, Found));
+
+	const FLayoutCacheStats Stats = Cache.GetStats();
+	EXPECT_EQ(2u, Stats.MemoryHits);
+	EXPECT_EQ(3u, Stats.Misses);
+	EXPECT_EQ(1u, Stats.Evictions);
+	EXPECT_EQ(2u, Stats.MemoryEntries);
+}
+
+LAYOUT_TEST(LayoutCacheReloadsFromDisk)
+{
+	const std::filesystem::path Directory = std::filesystem::temp_directory_path() / "DungeonLayoutCacheTest";
+	std::error_code Error;
+	std::filesystem::remove_all(Directory, Error);
+
+	const FLayoutParams First = MakeTestParams(200, 10, 31);
+	const FLayoutParams Second = MakeTestParams(200, 10, 32);
+	const FLayoutParams Third = MakeTestParams(200, 10, 33);
+	const FCachedLayout Expected = GenerateCachedLayout(First);
+	{
+		FLayoutCache Cache(1, Directory.string(), 2);
+		Cache.Add(First, Expected);
+		Cache.Add(Second, GenerateCachedLayout(Second));
+
+		// Out of memory already, still on disk
+		FCachedLayout Found;
+		EXPECT_TRUE(Cache.Find(First, Found));
+		EXPECT_TRUE(AreLayoutsIdentical(Expected.Layout, Found.Layout));
+		EXPECT_EQ(1u, Cache.GetStats().DiskHits);
+
+		// Second is now the oldest file
+		Cache.Add(Third, GenerateCachedLayout(Third));
+		EXPECT_EQ(2u, Cache.GetStats().DiskEntries);
+	}
+
+	FLayoutCache Reloaded(4, Directory.string(), 2);
+	FCachedLayout Found;
+	EXPECT_TRUE(Reloaded.Find(First, Found));
+	EXPECT_TRUE(AreLayoutsIdentical(Expected.Layout, Found.Layout));
+	EXPECT_TRUE(!Reloaded.Find(Second, Found));
+	EXPECT_TRUE(Reloaded.Find(Third, Found));
+	EXPECT_EQ(2u, Reloaded.GetStats().DiskHits);
+
+	std::filesystem::remove_all(Directory, Error);
+}
+
+LAYOUT_TEST(CompressedBytesRoundTrip)
+{
+	std::vector<uint8_t> Bytes;
+	FLayoutRandom Random(3);
+	for (int32_t i = 0; i < 20000; ++i)
+	{
+		// Runs and repeats to match, noise to leave as literals
+		Bytes.push_back(i % 3000 < 1000 ? static_cast<uint8_t>(i % 7) : static_cast<uint8_t>(Random.FRand() * 256.0));
+	}
+
+	std::vector<uint8_t> Compressed;
+	CompressBytes(Bytes.data(), Bytes.size(), Compressed);
+	EXPECT_TRUE(Compressed.size() < Bytes.size());
+
+	std::vector<uint8_t> Decompressed(Bytes.size());
+	EXPECT_TRUE(DecompressBytes(Compressed.data(), Compressed.size(), Decompressed.data(), Decompressed.size()));
+	EXPECT_TRUE(Decompressed == Bytes);
+	EXPECT_TRUE(!DecompressBytes(Compressed.data(), Compressed.size() - 1, Decompressed.data(), Decompressed.size()));
+	EXPECT_TRUE(!DecompressBytes(Compressed.data(), Compressed.size(), Decompressed.data(), Decompressed.size() - 1));
+}
+
+LAYOUT_TEST(LayoutFileRoundTrips)
+{
+	const FDungeonLayout Layout = GenerateDungeonLayout(MakeTestParams(300, 15, 9));
+	for (bool bCompress : { false, true })
+	{
+		std::vector<uint8_t> Bytes;
+		WriteLayoutFile(Layout, bCompress, Bytes);
+
+		FLayoutFileView View;
+		EXPECT_TRUE(View.Init(Bytes.data(), Bytes.size()));
+		EXPECT_EQ(bCompress, View.IsCompressed());
+		EXPECT_EQ(300u, View.GetNumRooms());
+
+		FDungeonLayout Read;
+		View.CopyTo(Read);
+		EXPECT_TRUE(Read.SelectedRooms == Layout.SelectedRooms);
+		EXPECT_TRUE(Read.CorridorRooms == Layout.CorridorRooms);
+		EXPECT_EQ(Layout.MinimumSpanningTree.size(), Read.MinimumSpanningTree.size());
+		EXPECT_EQ(Layout.Corridors.size(), Read.Corridors.size());
+		for (size_t i = 0; i < Layout.Rooms.size(); ++i)
+		{
+			// Positions are stored as floats relative to the layout center
+			EXPECT_TRUE(FVec2::Dist(Layout.Rooms[i].Center, Read.Rooms[i].Center) < 1e-2);
+			EXPECT_TRUE(Layout.Rooms[i].HalfExtents == Read.Rooms[i].HalfExtents);
+			EXPECT_EQ(Layout.Rooms[i].Area, Read.Rooms[i].Area);
+		}
+		for (size_t i = 0; i < Layout.MinimumSpanningTree.size(); ++i)
+		{
+			EXPECT_EQ(Layout.MinimumSpanningTree[i].A, Read.MinimumSpanningTree[i].A);
+			EXPECT_EQ(Layout.MinimumSpanningTree[i].B, Read.MinimumSpanningTree[i].B);
+		}
+		for (size_t i = 0; i < Layout.Corridors.size(); ++i)
+		{
+			EXPECT_TRUE(FVec2::Dist(Layout.Corridors[i].End, Read.Corridors[i].End) < 1e-2);
+			EXPECT_EQ(Layout.Corridors[i].EdgeIndex, Read.Corridors[i].EdgeIndex);
+		}
+
+		FLayoutFileView Truncated;
+		EXPECT_TRUE(!Truncated.Init(Bytes.data(), Bytes.size() - 4));
+	}
+}
+
+LAYOUT_TEST(LayoutFileRejectsOutOfRangeRooms)
+{
+	FDungeonLayout Layout = GenerateDungeonLayout(MakeTestParams(100, 8, 4));
+	Layout.SelectedRooms.back() = static_cast<int32_t>(Layout.Rooms.size());
+
+	std::vector<uint8_t> Bytes;
+	WriteLayoutFile(Layout, false, Bytes);
+	FLayoutFileView View;
+	EXPECT_TRUE(!View.Init(Bytes.data(), Bytes.size()));
+	EXPECT_TRUE(!View.IsValid());
+}
+
+LAYOUT_TEST(LayoutFileRejectsCountsPastTheFile)
+{
+	const FDungeonLayout Layout = GenerateDungeonLayout(MakeTestParams(100, 8, 4));
+	std::vector<uint8_t> Bytes;
+	WriteLayoutFile(Layout, false, Bytes);
+
+	// Consistent counts and tables size, but more rooms than the file stores
+	FLayoutFileHeader Header;
+	std::memcpy(&Header, Bytes.data(), sizeof(Header));
+	Header.NumRooms += 1000;
+	Header.TablesSize += 1000 * 5 * sizeof(float);
+	std::memcpy(Bytes.data(), &Header, sizeof(Header));
+	// Zeros past the file make a read beyond it look like valid tables
+	const size_t FileSize = Bytes.size();
+	Bytes.resize(FileSize + 1000 * 5 * sizeof(float) + 4096, 0);
+
+	FLayoutFileView View;
+	EXPECT_TRUE(!View.Init(Bytes.data(), FileSize));
+	EXPECT_TRUE(!View.IsValid());
+}
+
+LAYOUT_TEST(LayoutFileIsReadFromTheMapping)
+{
+	const std::filesystem::path Path = std::filesystem::temp_directory_path() / "DungeonLayoutFileTest.dlay";
+	const FDungeonLayout Layout = GenerateDungeonLayout(MakeTestParams(200, 10, 21));
+	EXPECT_TRUE(SaveLayoutFile(Layout, Path.string(), false));
+
+	FMappedLayoutFile File;
+	EXPECT_TRUE(File.Open(Path.string()));
+	const FLayoutFileView& View = File.GetView();
+	EXPECT_TRUE(View.IsValid() && !View.IsCompressed());
+	EXPECT_EQ(Layout.SelectedRooms.size(), static_cast<size_t>(View.GetNumSelectedRooms()));
+	for (uint32_t i = 0; i < View.GetNumSelectedRooms(); ++i)
+	{
+		EXPECT_EQ(Layout.SelectedRooms[i], static_cast<int32_t>(View.GetSelectedRooms()[i]));
+	}
+	File.Close();
+	EXPECT_TRUE(!View.IsValid());
+
+	FMappedLayoutFile Missing;
+	EXPECT_TRUE(!Missing.Open((Path.parent_path() / "DungeonLayoutFileTestMissing.dlay").string()));
+
+	std::error_code Error;
+	std::filesystem::remove(Path, Error);
+}
+
+LAYOUT_TEST(LayoutDeltaRebuildsTheServerLayout)
+{
+	const FLayoutParams Params = MakeTestParams(300, 15, 13);
+	const FDungeonLayout Generated = GenerateDungeonLayout(Params);
+	EXPECT_EQ(ComputeLayoutChecksum(Generated), ComputeLayoutChecksum(GenerateDungeonLayout(Params)));
+
+	// Server side edit of a selected room, far enough to change the corridors
+	FDungeonLayout Server = Generated;
+	Server.Rooms[Server.SelectedRooms[0]].Center += FVec2(5000, 5000);
+	FinishDungeonLayout(Params, Server);
+	EXPECT_TRUE(ComputeLayoutChecksum(Server) != ComputeLayoutChecksum(Generated));
+
+	FLayoutDelta Delta;
+	EXPECT_TRUE(ComputeLayoutDelta(Generated, Server, Delta));
+	EXPECT_EQ(1u, Delta.Rooms.size());
+
+	FDungeonLayout Client = GenerateDungeonLayout(Params);
+	EXPECT_TRUE(ApplyLayoutDelta(Delta, Params, Client));
+	EXPECT_EQ(ComputeLayoutChecksum(Server), ComputeLayoutChecksum(Client));
+
+	Delta.Rooms[0].Room = 300;
+	EXPECT_TRUE(!ApplyLayoutDelta(Delta, Params, Client));
+}
+
+LAYOUT_TEST(OccupancyGridRasterizesRooms)
+{
+	std::vector<FLayoutRoom> Rooms(2);
+	Rooms[0].Center = FVec2(0, 0);
+	Rooms[0].HalfExtents = FVec2(150, 50);
+	Rooms[1].Center = FVec2(1000, 500);
+	Rooms[1].HalfExtents = FVec2(50, 50);
+
+	FOccupancyGrid Grid;
+	Grid.Build(Rooms, 100.0, 2);
+	EXPECT_TRUE(Grid.IsRoom(Grid.FindCell(FVec2(0, 0))));
+	EXPECT_TRUE(Grid.IsRoom(Grid.FindCell(FVec2(-120, 0))));
+	EXPECT_TRUE(Grid.IsRoom(Grid.FindCell(FVec2(1000, 500))));
+	EXPECT_TRUE(!Grid.IsRoom(Grid.FindCell(FVec2(500, 250))));
+	EXPECT_TRUE(!Grid.IsRoom(Grid.FindCell(FVec2(0, 150))));
+	EXPECT_TRUE(!Grid.IsCorridor(Grid.FindCell(FVec2(0, 0))));
+}
+
+LAYOUT_TEST(CorridorPathPrefersExistingCorridors)
+{
+	std::vector<FLayoutRoom> Rooms(2);
+	Rooms[0].HalfExtents = FVec2(50, 50);
+	Rooms[1].Center = FVec2(4000, 0);
+	Rooms[1].HalfExtents = FVec2(50, 50);
+	FOccupancyGrid Grid;
+	Grid.Build(Rooms, 100.0);
+
+	const int32_t Start = Grid.FindCell(Rooms[0].Center);
+	const int32_t Goal = Grid.FindCell(Rooms[1].Center);
+	FCorridorPathfinder Pathfinder;
+	std::vector<int32_t> Path;
+	EXPECT_TRUE(Pathfinder.FindPath(Grid, Start, Goal, Path));
+	EXPECT_EQ(Start, Path.front());
+	EXPECT_EQ(Goal, Path.back());
+	// Nothing to reuse, the straight line
+	EXPECT_EQ(41u, Path.size());
+
+	// A corridor two rows up is worth the detour
+	const int32_t Row = Grid.GetCellY(Start) + 2;
+	for (int32_t X = Grid.GetCellX(Start); X <= Grid.GetCellX(Goal); ++X)
+	{
+		Grid.MarkCorridor(Grid.GetCell(X, Row));
+	}
+	EXPECT_TRUE(Pathfinder.FindPath(Grid, Start, Goal, Path));
+	EXPECT_TRUE(std::find(Path.begin(), Path.end(), Grid.GetCell(Grid.GetCellX(Start) + 20, Row)) != Path.end());
+	for (size_t i = 1; i < Path.size(); ++i)
+	{
+		const int32_t Step = std::abs(Path[i] - Path[i - 1]);
+		EXPECT_TRUE(Step == 1 || Step == Grid.GetWidth());
+	}
+}
+
+LAYOUT_TEST(GridCorridorsConnectEveryEdge)
+{
+	FDungeonLayout Layout = GenerateDungeonLayout(MakeTestParams(400, 25, 17));
+	FOccupancyGrid Grid;
+	Grid.Build(Layout.Rooms, 100.0);
+
+	std::vector<FCorridorCellRun> Runs;
+	SetNumWorkerThreads(1);
+	RouteCorridorRuns(Layout, Grid, Runs);
+	FOccupancyGrid ParallelGrid;
+	ParallelGrid.Build(Layout.Rooms, 100.0);
+	std::vector<FCorridorCellRun> ParallelRuns;
+	SetNumWorkerThreads(5);
+	RouteCorridorRuns(Layout, ParallelGrid, ParallelRuns);
+	SetNumWorkerThreads(0);
+
+	EXPECT_EQ(Runs.size(), ParallelRuns.size());
+	for (size_t i = 0; i < Runs.size() && i < ParallelRuns.size(); ++i)
+	{
+		EXPECT_TRUE(Runs[i].StartCell == ParallelRuns[i].StartCell && Runs[i].EndCell == ParallelRuns[i].EndCell);
+	}
+
+	// Runs of an edge chain from the first room to the second, each along a row or a column
+	size_t RunIndex = 0;
+	for (int32_t EdgeIndex = 0; EdgeIndex < static_cast<int32_t>(Layout.MinimumSpanningTree.size()); ++EdgeIndex)
+	{
+		const FLayoutEdge& Edge = Layout.MinimumSpanningTree[EdgeIndex];
+		EXPECT_TRUE(RunIndex < Runs.size() && Runs[RunIndex].EdgeIndex == EdgeIndex);
+		int32_t Cell = Grid.FindCell(Layout.Rooms[Edge.A].Center);
+		for (; RunIndex < Runs.size() && Runs[RunIndex].EdgeIndex == EdgeIndex; ++RunIndex)
+		{
+			const FCorridorCellRun& Run = Runs[RunIndex];
+			EXPECT_EQ(Cell, Run.StartCell);
+			EXPECT_TRUE(Grid.GetCellX(Run.StartCell) == Grid.GetCellX(Run.EndCell) || Grid.GetCellY(Run.StartCell) == Grid.GetCellY(Run.EndCell));
+			EXPECT_TRUE(Grid.IsCorridor(Run.EndCell));
+			Cell = Run.EndCell;
+		}
+		EXPECT_EQ(Grid.FindCell(Layout.Rooms[Edge.B].Center), Cell);
+	}
+
+	FLayoutParams Params = MakeTestParams(400, 25, 17);
+	Params.CorridorRouting = ECorridorRouting::Grid;
+	const FDungeonLayout Routed = GenerateDungeonLayout(Params);
+	EXPECT_TRUE(!Routed.Corridors.empty());
+	for (int32_t RoomIndex : Routed.CorridorRooms)
+	{
+		EXPECT_TRUE(std::find(Routed.SelectedRooms.begin(), Routed.SelectedRooms.end(), RoomIndex) == Routed.SelectedRooms.end());
+	}
+}
+
+LAYOUT_TEST(CorridorMeshWallsAStraightCorridor)
+{
+	// Two 400 x 400 rooms 1000 apart joined along Y = 0, 100 unit cells
+	FDungeonLayout Layout;
+	for (int32_t i = 0; i < 2; ++i)
+	{
+		FLayoutRoom Room;
+		Room.Center = FVec2(i * 1000.0, 0.0);
+		Room.HalfExtents = FVec2(200.0, 200.0);
+		Room.Id = i;
+		Layout.Rooms.push_back(Room);
+		Layout.SelectedRooms.push_back(i);
+	}
+	Layout.MinimumSpanningTree.push_back(FLayoutEdge(0, 1, 1000.f));
+	FCorridorSegment Segment;
+	Segment.Start = Layout.Rooms[0].Center;
+	Segment.End = Layout.Rooms[1].Center;
+	Segment.EdgeIndex = 0;
+	Layout.Corridors.push_back(Segment);
+
+	FCorridorMeshParams Params;
+	Params.CellSize = 100.0;
+	std::vector<FCorridorMeshSection> Sections;
+	BuildCorridorMesh(Layout, Params, Sections);
+
+	int32_t NumFloors = 0;
+	int32_t NumWalls = 0;
+	int32_t NumLintels = 0;
+	for (const FCorridorMeshSection& Section : Sections)
+	{
+		EXPECT_EQ(Section.Vertices.size() / 4 * 6, Section.Indices.size());
+		for (size_t Quad = 0; Quad < Section.Vertices.size() / 4; ++Quad)
+		{
+			const FCorridorMeshVertex* Corners = &Section.Vertices[Quad * 4];
+			NumFloors += Corners[0].NormalZ == 1.f ? 1 : 0;
+			NumWalls += Corners[0].NormalZ == 0.f && Corners[0].Z == 0.f ? 1 : 0;
+			NumLintels += Corners[0].Z == Params.DoorHeight ? 1 : 0;
+
+			// Counter-clockwise around the normal
+			const double E1[3] = { Corners[1].Position.X - Corners[0].Position.X, Corners[1].Position.Y - Corners[0].Position.Y, Corners[1].Z - Corners[0].Z };
+			const double E2[3] = { Corners[2].Position.X - Corners[0].Position.X, Corners[2].Position.Y - Corners[0].Position.Y, Corners[2].Z - Corners[0].Z };
+			const double Cross[3] = { E1[1] * E2[2] - E1[2] * E2[1], E1[2] * E2[0] - E1[0] * E2[2], E1[0] * E2[1] - E1[1] * E2[0] };
+			EXPECT_TRUE(Cross[0] * Corners[0].NormalX + Cross[1] * Corners[0].NormalY + Cross[2] * Corners[0].NormalZ > 0.0);
+		}
+	}
+	// Six cells between the rooms, walled on both sides, a lintel where the corridor enters each room
+	EXPECT_EQ(6, NumFloors);
+	EXPECT_EQ(12, NumWalls);
+	EXPECT_EQ(2, NumLintels);
+}
+
+LAYOUT_TEST(CorridorMeshDoesNotDependOnTheThreadCount)
+{
+	FLayoutParams Params = MakeTestParams(800, 40, 17);
+	Params.CorridorRouting = ECorridorRouting::Grid;
+	const FDungeonLayout Layout = GenerateDungeonLayout(Params);
+	FCorridorMeshParams MeshParams;
+	MeshParams.CellSize = Params.CorridorCellSize;
+	MeshParams.RegionCells = 8;
+
+	std::vector<FCorridorMeshSection> Serial;
+	std::vector<FCorridorMeshSection> Parallel;
+	SetNumWorkerThreads(1);
+	BuildCorridorMesh(Layout, MeshParams, Serial);
+	SetNumWorkerThreads(5);
+	BuildCorridorMesh(Layout, MeshParams, Parallel);
+	SetNumWorkerThreads(0);
+
+	EXPECT_TRUE(Serial.size() > 1);
+	EXPECT_EQ(Serial.size(), Parallel.size());
+	for (size_t i = 0; i < Serial.size() && i < Parallel.size(); ++i)
+	{
+		EXPECT_EQ(Serial[i].RegionX, Parallel[i].RegionX);
+		EXPECT_EQ(Serial[i].RegionY, Parallel[i].RegionY);
+		EXPECT_TRUE(Serial[i].Indices == Parallel[i].Indices);
+		EXPECT_EQ(Serial[i].Vertices.size(), Parallel[i].Vertices.size());
+		for (size_t Vertex = 0; Vertex < Serial[i].Vertices.size() && Vertex < Parallel[i].Vertices.size(); ++Vertex)
+		{
+			EXPECT_TRUE(Serial[i].Vertices[Vertex].Position == Parallel[i].Vertices[Vertex].Position);
+			EXPECT_EQ(Serial[i].Vertices[Vertex].Z, Parallel[i].Vertices[Vertex].Z);
+		}
+	}
+}
+
+namespace
+{
+	int32_t StageBegins[NumLayoutStages] = {};
+	int32_t StageEnds[NumLayoutStages] = {};
+
+	void CountLayoutStage(ELayoutStage Stage, bool bBegin)
+	{
+		++(bBegin ? StageBegins : StageEnds)[static_cast<int32_t>(Stage)];
+	}
+}
+
+LAYOUT_TEST(GenerationStatsCountEveryStage)
+{
+	FLayoutParams Params = MakeTestParams(400, 20, 31);
+	Params.SeparationSolver = ESeparationSolver::Jacobi;
+	SetLayoutStageHook(&CountLayoutStage);
+	FLayoutStats Stats;
+	FSeparationResult Separation;
+	const FDungeonLayout Layout = GenerateDungeonLayout(Params, &Separation, &Stats);
+	SetLayoutStageHook(nullptr);
+
+	for (int32_t Stage = 0; Stage < NumLayoutStages; ++Stage)
+	{
+		EXPECT_EQ(1, StageBegins[Stage]);
+		EXPECT_EQ(1, StageEnds[Stage]);
+		EXPECT_TRUE(Stats.StageSeconds[Stage] >= 0.0);
+	}
+	EXPECT_EQ(Separation.Iterations, Stats.SeparationIterations);
+	EXPECT_TRUE(Stats.OverlapPairsTested > 0);
+	EXPECT_EQ(Separation.PairsTested, Stats.OverlapPairsTested);
+	EXPECT_EQ(static_cast<int32_t>(Layout.SelectedRooms.size()), Stats.DelaunayInsertions);
+	EXPECT_TRUE(Stats.DelaunayBadTriangles >= Stats.DelaunayInsertions);
+	EXPECT_TRUE(Stats.MaxDelaunayBadTriangles >= 1);
+	EXPECT_TRUE(Stats.GraphEdges >= Stats.SpanningTreeEdges);
+	EXPECT_EQ(static_cast<int32_t>(Layout.MinimumSpanningTree.size()), Stats.SpanningTreeEdges);
+	EXPECT_EQ(static_cast<int32_t>(Layout.Corridors.size()), Stats.CorridorSegments);
+
+	// Both solvers test each pair once per pass with a serial count, the Jacobi pass from both of its rooms
+	std::vector<FLayoutRoom> Rooms;
+	ScatterRooms(Params, Rooms);
+	std::vector<FLayoutRoom> JacobiRooms = Rooms;
+	FRoomSpatialHash Broadphase(ComputeBroadphaseCellSize(Rooms));
+	std::vector<FVec2> Displacements;
+	int64_t SerialPairs = 0;
+	int64_t JacobiPairs = 0;
+	SeparateRoomsStep(Rooms, Broadphase, &SerialPairs);
+	SeparateRoomsStepJacobi(JacobiRooms, Broadphase, Displacements, &JacobiPairs);
+	EXPECT_EQ(SerialPairs * 2, JacobiPairs);
+}
+
+namespace
+{
+	FChunkParams MakeTestChunkParams()
+	{
+		FChunkParams Params;
+		Params.Layout = MakeTestParams(60, 8, 5);
+		Params.ChunkSize = 6000.0;
+		Params.LoadRadius = 9000.0;
+		Params.UnloadRadius = 13000.0;
+		Params.MaxChunks = 20;
+		return Params;
+	}
+}
+
+LAYOUT_TEST(ChunksOnlyDependOnTheSeedAndTheirCoordinates)
+{
+	const FChunkParams Params = MakeTestChunkParams();
+	FDungeonChunk Chunk;
+	FDungeonChunk Again;
+	FDungeonChunk Other;
+	GenerateChunk(Params, FChunkCoord(-3, 7), Chunk);
+	GenerateChunk(Params, FChunkCoord(4, 4), Other);
+	GenerateChunk(Params, FChunkCoord(-3, 7), Again);
+
+	EXPECT_TRUE(AreLayoutsIdentical(Chunk.Layout, Again.Layout));
+	EXPECT_TRUE(!(Chunk.Layout.Rooms[0].Center - GetChunkCenter(Params, Chunk.Coord) == Other.Layout.Rooms[0].Center - GetChunkCenter(Params, Other.Coord)));
+
+	const FVec2 Min = GetChunkCenter(Params, Chunk.Coord) - FVec2(Params.ChunkSize * 0.5, Params.ChunkSize * 0.5);
+	const FVec2 Max = GetChunkCenter(Params, Chunk.Coord) + FVec2(Params.ChunkSize * 0.5, Params.ChunkSize * 0.5);
+	bool bInside = true;
+	for (size_t i = 0; i < Chunk.Layout.Rooms.size(); ++i)
+	{
+		const FLayoutRoom& Room = Chunk.Layout.Rooms[i];
+		bInside &= Room.Min().X >= Min.X && Room.Min().Y >= Min.Y && Room.Max().X <= Max.X && Room.Max().Y <= Max.Y;
+		bInside &= Room.Id == static_cast<int32_t>(i);
+	}
+	EXPECT_TRUE(bInside);
+	EXPECT_TRUE(!HasAnyOverlap(Chunk.Layout.Rooms));
+	EXPECT_EQ(Chunk.Layout.SelectedRooms.size() - 1, Chunk.Layout.MinimumSpanningTree.size());
+
+	FDungeonChunk Neighbor;
+	GenerateChunk(Params, FChunkCoord(-2, 7), Neighbor);
+	FChunkStitch Stitch;
+	EXPECT_TRUE(BuildChunkStitch(Neighbor, Chunk, Stitch));
+	EXPECT_TRUE(Stitch.A == Chunk.Coord);
+	EXPECT_TRUE(Stitch.B == Neighbor.Coord);
+	EXPECT_TRUE(!Stitch.Corridors.empty());
+	EXPECT_TRUE(Stitch.Corridors.front().Start == Chunk.Layout.Rooms[Stitch.RoomA].Center
+		|| Stitch.Corridors.back().End == Neighbor.Layout.Rooms[Stitch.RoomB].Center);
+}
+
+LAYOUT_TEST(ChunkStreamerStaysBoundedAlongAWalk)
+{
+	// Fewer chunks than LoadRadius covers, the cap decides
+	FChunkParams Params = MakeTestChunkParams();
+	Params.MaxChunks = 6;
+	FChunkStreamer Streamer(Params);
+	std::vector<FChunkCoord> Requested;
+	std::vector<FChunkCoord> Evicted;
+	std::vector<FChunkStitch> Stitches;
+
+	// Generated out of order with the walk: the first request of each step comes back one step late
+	std::vector<FDungeonChunk> Late;
+	int32_t NumStitches = 0;
+	bool bBounded = true;
+	bool bLoadedAround = true;
+	for (int32_t Step = 0; Step < 40; ++Step)
+	{
+		const FVec2 Viewer(Step * 2500.0, Step * 700.0);
+		Streamer.Update({ Viewer }, Requested, Evicted);
+		for (const FChunkCoord& Coord : Evicted)
+		{
+			bBounded &= !Streamer.IsTracked(Coord);
+		}
+		for (FDungeonChunk& Chunk : Late)
+		{
+			// Still wanted, the walk is slow enough
+			EXPECT_TRUE(Streamer.AddChunk(std::move(Chunk), Stitches));
+			NumStitches += static_cast<int32_t>(Stitches.size());
+		}
+		Late.clear();
+		for (size_t i = 0; i < Requested.size(); ++i)
+		{
+			FDungeonChunk Chunk;
+			GenerateChunk(Params, Requested[i], Chunk);
+			if (i == 0)
+			{
+				Late.push_back(std::move(Chunk));
+				continue;
+			}
+			EXPECT_TRUE(Streamer.AddChunk(std::move(Chunk), Stitches));
+			NumStitches += static_cast<int32_t>(Stitches.size());
+		}
+		bBounded &= Streamer.NumTrackedChunks() <= Params.MaxChunks;
+		bLoadedAround &= Streamer.IsTracked(GetChunkCoord(Params, Viewer));
+	}
+	EXPECT_TRUE(bBounded);
+	EXPECT_TRUE(bLoadedAround);
+	EXPECT_TRUE(NumStitches > 40);
+	EXPECT_TRUE(Streamer.NumGeneratedChunks() > 4);
+
+	// A chunk generated after its eviction is dropped
+	Streamer.Update({ FVec2(-1.e6, -1.e6) }, Requested, Evicted);
+	EXPECT_TRUE(Evicted.size() > 4);
+	FDungeonChunk Stale;
+	GenerateChunk(Params, Evicted.front(), Stale);
+	EXPECT_TRUE(!Streamer.AddChunk(std::move(Stale), Stitches));
+	EXPECT_EQ(static_cast<int32_t>(Requested.size()), Streamer.NumTrackedChunks());
+	EXPECT_EQ(0, Streamer.NumGeneratedChunks());
+}
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Minimal test registry for the standalone layout tests, no third party dependency
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace LayoutTests
+{
+	struct FTestCase
+	{
+		const char* Name;
+		std::function<void()> Body;
+	};
+
+	inline std::vector<FTestCase>& GetTestCases()
+	{
+		static std::vector<FTestCase> TestCases;
+		return TestCases;
+	}
+
+	inline int& GetFailureCount()
+	{
+		static int Failures = 0;
+		return Failures;
+	}
+
+	struct FTestRegistrar
+	{
+		FTestRegistrar(const char* Name, std::function<void()> Body)
+		{
+			GetTestCases().push_back({ Name, Body });
+		}
+	};
+}
+
+#define LAYOUT_TEST_CONCAT_INNER(A, B) A##B
+#define LAYOUT_TEST_CONCAT(A, B) LAYOUT_TEST_CONCAT_INNER(A, B)
+
+#define LAYOUT_TEST(Name) \
+	static void Name(); \
+	static LayoutTests::FTestRegistrar LAYOUT_TEST_CONCAT(Name, _Registrar)(#Name, &Name); \
+	static void Name()
+
+#define EXPECT_TRUE(Condition) \
+	do \
+	{ \
+		if (!(Condition)) \
+		{ \
+			std::printf("  %s:%d: expected %s\n", __FILE__, __LINE__, #Condition); \
+			++LayoutTests::GetFailureCount(); \
+		} \
+	} while (0)
+
+#define EXPECT_EQ(Expected, Actual) EXPECT_TRUE((Expected) == (Actual))
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LayoutTestHarness.h"
+
+#include <cstring>
+
+int main(int Argc, char** Argv)
+{
+	// Optional argument: only run tests whose name contains it
+	const char* Filter = Argc > 1 ? Argv[1] : nullptr;
+
+	int NumFailedTests = 0;
+	for (const LayoutTests::FTestCase& TestCase : LayoutTests::GetTestCases())
+	{
+		if (Filter && !std::strstr(TestCase.Name, Filter))
+		{
+			continue;
+		}
+
+		const int FailuresBefore = LayoutTests::GetFailureCount();
+		TestCase.Body();
+		const bool bPassed = LayoutTests::GetFailureCount() == FailuresBefore;
+		NumFailedTests += bPassed ? 0 : 1;
+		std::printf("[%s] %s\n", bPassed ? "PASS" : "FAIL", TestCase.Name);
+	}
+
+	std::printf("%d test(s) failed\n", NumFailedTests);
+	return NumFailedTests == 0 ? 0 : 1;
+}